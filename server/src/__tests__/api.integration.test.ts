@@ -86,6 +86,76 @@ describe('API Integration Tests', () => {
     it('should return 400 if no images provided', async () => {
       await request(app).post('/api/nesting/process').expect(400);
     });
+
+    it('should stream one NDJSON line per file and report failures individually', async () => {
+      const testImage = await sharp({
+        create: {
+          width: 60,
+          height: 60,
+          channels: 4,
+          background: { r: 0, g: 0, b: 255, alpha: 1 },
+        },
+      })
+        .png()
+        .toBuffer();
+
+      const response = await request(app)
+        .post('/api/nesting/process')
+        .set('Accept', 'application/x-ndjson')
+        .attach('images', testImage, 'good.png')
+        .attach('images', Buffer.from('not an image'), 'bad.png')
+        .expect(200)
+        .expect('Content-Type', /application\/x-ndjson/);
+
+      const lines = response.text.trim().split('\n').map(line => JSON.parse(line));
+      expect(lines).toHaveLength(3);
+      expect(lines.find(line => line.type === 'image')).toMatchObject({ index: 0, image: { id: 'good.png' } });
+      expect(lines.find(line => line.type === 'error')).toMatchObject({ index: 1, id: 'bad.png' });
+      expect(lines[2]).toEqual({ type: 'complete', summary: { processed: 1, failed: 1 } });
+    });
+
+    it('should use outlines traced by the client instead of tracing the upload', async () => {
+      const testImage = await sharp({
+        create: {
+          width: 200,
+          height: 100,
+          channels: 4,
+          background: { r: 255, g: 0, b: 0, alpha: 1 },
+        },
+      })
+        .png()
+        .toBuffer();
+      const triangle = { path: [{ x: 0, y: 0 }, { x: 200, y: 0 }, { x: 0, y: 100 }], holes: [] };
+
+      const response = await request(app)
+        .post('/api/nesting/process')
+        .field('maxDimension', '50')
+        .field('unit', 'mm')
+        .field('outlines', JSON.stringify([triangle, null]))
+        .attach('images', testImage, 'traced.png')
+        .attach('images', testImage, 'untraced.png')
+        .expect(200);
+
+      const [traced, untraced] = response.body.images;
+      expect(traced.path).toHaveLength(3);
+      expect(traced.width).toBeCloseTo(50);
+      expect(traced.height).toBeCloseTo(25);
+      expect(untraced.path.length).toBeGreaterThanOrEqual(4);
+    });
+
+    it('should return 400 for malformed client outlines', async () => {
+      const testImage = await sharp({
+        create: { width: 10, height: 10, channels: 4, background: { r: 0, g: 0, b: 0, alpha: 1 } },
+      })
+        .png()
+        .toBuffer();
+
+      await request(app)
+        .post('/api/nesting/process')
+        .field('outlines', JSON.stringify([{ path: [{ x: 0, y: 0 }] }]))
+        .attach('images', testImage, 'test.png')
+        .expect(400);
+    });
   });
 
   describe('POST /api/nesting/nest', () => {
@@ -170,6 +240,68 @@ describe('API Integration Tests', () => {
 
       await request(app).post('/api/nesting/nest').send(requestBody).expect(400);
     });
+
+    it('should return 400 if beamWidth is not a number', async () => {
+      const requestBody = {
+        stickers: [
+          {
+            id: 'sticker-1',
+            points: [{ x: 0, y: 0 }, { x: 2, y: 0 }, { x: 2, y: 2 }, { x: 0, y: 2 }],
+            width: 2,
+            height: 2,
+          },
+        ],
+        sheetWidth: 12,
+        sheetHeight: 12,
+        spacing: 0.0625,
+        usePolygonPacking: true,
+        beamWidth: 'wide',
+      };
+
+      await request(app).post('/api/nesting/nest').send(requestBody).expect(400);
+    });
+  });
+
+  describe('POST /api/pdf/pack-and-render', () => {
+    it('should pack and return a PDF in one request', async () => {
+      const testImage = await sharp({
+        create: {
+          width: 100,
+          height: 100,
+          channels: 4,
+          background: { r: 255, g: 0, b: 0, alpha: 1 },
+        },
+      })
+        .png()
+        .toBuffer();
+
+      const stickers = JSON.stringify([
+        {
+          id: 'test.png',
+          points: [
+            { x: 0, y: 0 },
+            { x: 25, y: 0 },
+            { x: 25, y: 25 },
+            { x: 0, y: 25 },
+          ],
+          width: 25,
+          height: 25,
+        },
+      ]);
+
+      const response = await request(app)
+        .post('/api/pdf/pack-and-render')
+        .field('stickers', stickers)
+        .field('sheetWidth', '100')
+        .field('sheetHeight', '100')
+        .field('sheetCount', '1')
+        .field('usePolygonPacking', 'false')
+        .attach('images', testImage, 'test.png')
+        .expect(200);
+
+      expect(response.headers['content-type']).toBe('application/pdf');
+      expect(response.body.slice(0, 4).toString()).toBe('%PDF');
+    });
   });
 
   describe('POST /api/pdf/generate', () => {
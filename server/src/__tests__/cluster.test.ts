@@ -0,0 +1,100 @@
+import { pickWorkerIndex, ProgressFanout } from '../services/cluster.service';
+import { MemoryJobStore } from '../services/job-store.service';
+import { Server as SocketIOServer } from 'socket.io';
+
+/**
+ * Fake Socket.IO server that records emitted events
+ */
+function makeFakeIo(localSocketIds: string[], localRooms: string[] = []) {
+  const emitted: Array<{ target: string; event: string; payload: any }> = [];
+  const io = {
+    sockets: {
+      sockets: new Map(localSocketIds.map(id => [id, {}])),
+      adapter: { rooms: new Map(localRooms.map(room => [room, new Set()])) },
+    },
+    to: (target: string) => ({
+      emit: (event: string, payload: any) => emitted.push({ target, event, payload }),
+    }),
+  };
+  return { io: io as unknown as SocketIOServer, emitted };
+}
+
+describe('Cluster mode', () => {
+  describe('pickWorkerIndex', () => {
+    it('should route the same address to the same worker', () => {
+      const first = pickWorkerIndex('192.168.1.20', 4);
+      for (let i = 0; i < 10; i++) {
+        expect(pickWorkerIndex('192.168.1.20', 4)).toBe(first);
+      }
+    });
+
+    it('should stay within range and spread addresses across workers', () => {
+      const used = new Set<number>();
+      for (let i = 0; i < 100; i++) {
+        const index = pickWorkerIndex(`10.0.0.${i}`, 4);
+        expect(index).toBeGreaterThanOrEqual(0);
+        expect(index).toBeLessThan(4);
+        used.add(index);
+      }
+      expect(used.size).toBe(4);
+    });
+  });
+
+  describe('MemoryJobStore', () => {
+    it('should merge updates into one record', async () => {
+      const store = new MemoryJobStore();
+      store.update('job-1', { status: 'queued', socketId: 'abc' });
+      store.update('job-1', { status: 'running', percentComplete: 40 });
+
+      const record = await store.get('job-1');
+      expect(record).toMatchObject({
+        jobId: 'job-1',
+        status: 'running',
+        socketId: 'abc',
+        percentComplete: 40,
+      });
+    });
+
+    it('should drop finished jobs after the TTL', async () => {
+      const store = new MemoryJobStore(0);
+      store.update('done', { status: 'complete' });
+      store.update('active', { status: 'running' });
+
+      await new Promise(resolve => setTimeout(resolve, 5));
+
+      expect(await store.get('done')).toBeUndefined();
+      expect(await store.get('active')).toBeDefined();
+    });
+  });
+
+  describe('ProgressFanout', () => {
+    it('should emit directly when not clustered', () => {
+      const { io, emitted } = makeFakeIo([]);
+      const fanout = new ProgressFanout(io, false);
+
+      fanout.emitTo('remote', 'nesting:progress', { jobId: 'job-1' });
+
+      expect(emitted).toEqual([{ target: 'remote', event: 'nesting:progress', payload: { jobId: 'job-1' } }]);
+    });
+
+    it('should emit locally when this process holds the socket', () => {
+      const { io, emitted } = makeFakeIo(['local']);
+      const fanout = new ProgressFanout(io, true);
+
+      fanout.emitTo('local', 'nesting:complete', { jobId: 'job-1' });
+
+      expect(emitted).toHaveLength(1);
+      expect(emitted[0].target).toBe('local');
+    });
+
+    it('should emit to local members of a job room', () => {
+      const { io, emitted } = makeFakeIo([], ['job:job-1']);
+      const fanout = new ProgressFanout(io, true);
+
+      fanout.emitTo('job:job-1', 'nesting:progress', { jobId: 'job-1' });
+
+      expect(emitted).toHaveLength(1);
+      expect(emitted[0].target).toBe('job:job-1');
+    });
+  });
+});
@@ -0,0 +1,204 @@
+import { GangRunService, GangRunOrder, GangRunSnapshot, splitByOrder } from '../services/gang-run.service';
+import { MultiSheetResult } from '../services/nesting.service';
+import { PackingWorkerData } from '../workers/packing.worker';
+
+const flush = () => new Promise(resolve => setImmediate(resolve));
+
+function makeOrder(orderId: string, itemCount: number, sheetWidth: number = 215.9): GangRunOrder {
+  return {
+    orderId,
+    stickers: Array.from({ length: itemCount }, (_, i) => ({
+      id: `design_${i}`,
+      points: [],
+      width: 25.4,
+      height: 25.4,
+    })),
+    sheetWidth,
+    sheetHeight: 279.4,
+    spacing: 1.5875,
+    cellsPerInch: 100,
+    stepSize: 0.05,
+    rotations: [0, 90, 180, 270],
+  };
+}
+
+/**
+ * Fake dispatcher: places every item on sheet 0 and records the packed batches
+ */
+class FakeDispatcher {
+  batches: PackingWorkerData[] = [];
+
+  dispatch = async (jobId: string, data: PackingWorkerData): Promise<MultiSheetResult> => {
+    this.batches.push(data);
+    return {
+      sheets: [{
+        sheetIndex: 0,
+        placements: data.stickers.map((s, i) => ({ id: s.id, x: i * 30, y: 0, rotation: 0 })),
+        utilization: 50,
+      }],
+      totalUtilization: 50,
+      quantities: {},
+    };
+  };
+}
+
+describe('GangRunService', () => {
+  let fake: FakeDispatcher;
+
+  beforeEach(() => {
+    jest.useFakeTimers({ doNotFake: ['setImmediate'] });
+    fake = new FakeDispatcher();
+  });
+
+  afterEach(() => {
+    jest.useRealTimers();
+  });
+
+  it('should pack orders collected over the window in one job', async () => {
+    const gangRuns = new GangRunService(fake.dispatch, { windowMs: 1000 });
+
+    const a = gangRuns.submit(makeOrder('a', 2));
+    const b = gangRuns.submit(makeOrder('b', 3));
+    expect(b.batchId).toBe(a.batchId);
+    expect(fake.batches).toHaveLength(0);
+
+    jest.advanceTimersByTime(1000);
+    await flush();
+
+    expect(fake.batches).toHaveLength(1);
+    expect(fake.batches[0].stickers.map(s => s.id)).toEqual([
+      'a:design_0', 'a:design_1', 'b:design_0', 'b:design_1', 'b:design_2',
+    ]);
+    expect(gangRuns.getOrder('a')?.status).toBe('complete');
+  });
+
+  it('should return each order its own placements under its own item IDs', async () => {
+    const gangRuns = new GangRunService(fake.dispatch, { windowMs: 1000 });
+    gangRuns.submit(makeOrder('a', 1));
+    gangRuns.submit(makeOrder('b', 2));
+    gangRuns.flush();
+    await flush();
+
+    const b = gangRuns.getOrder('b')!;
+    expect(b.sheets).toEqual([{
+      sheetIndex: 0,
+      placements: [
+        { id: 'design_0', x: 30, y: 0, rotation: 0 },
+        { id: 'design_1', x: 60, y: 0, rotation: 0 },
+      ],
+    }]);
+
+    const batch = gangRuns.getBatch(b.batchId)!;
+    expect(batch.sort).toEqual([{
+      sheetIndex: 0,
+      orders: [
+        { orderId: 'a', itemIds: ['design_0'] },
+        { orderId: 'b', itemIds: ['design_0', 'design_1'] },
+      ],
+    }]);
+  });
+
+  it('should keep orders with different sheet settings apart', () => {
+    const gangRuns = new GangRunService(fake.dispatch, { windowMs: 1000 });
+
+    const letter = gangRuns.submit(makeOrder('a', 1, 215.9));
+    const a4 = gangRuns.submit(makeOrder('b', 1, 210));
+
+    expect(a4.batchId).not.toBe(letter.batchId);
+  });
+
+  it('should close a batch early once it reaches its item cap', async () => {
+    const gangRuns = new GangRunService(fake.dispatch, { windowMs: 1000, maxBatchItems: 4 });
+
+    const first = gangRuns.submit(makeOrder('a', 2));
+    gangRuns.submit(makeOrder('b', 2));
+    const next = gangRuns.submit(makeOrder('c', 1));
+    await flush();
+
+    expect(fake.batches).toHaveLength(1);
+    expect(next.batchId).not.toBe(first.batchId);
+  });
+
+  it('should refuse orders too large to gang and repeated order IDs', () => {
+    const gangRuns = new GangRunService(fake.dispatch, { maxOrderItems: 3 });
+
+    expect(() => gangRuns.submit(makeOrder('big', 4))).toThrow('1-3 items');
+    gangRuns.submit(makeOrder('a', 1));
+    expect(() => gangRuns.submit(makeOrder('a', 1))).toThrow('already submitted');
+  });
+
+  it('should refuse an order that repeats an item ID', () => {
+    const gangRuns = new GangRunService(fake.dispatch);
+    const order = makeOrder('a', 2);
+    order.stickers[1].id = order.stickers[0].id;
+
+    expect(() => gangRuns.submit(order)).toThrow('more than once');
+    expect(gangRuns.getOrder('a')).toBeUndefined();
+  });
+
+  it('should hand out the batch job ID while the batch is still collecting', async () => {
+    const jobIds: string[] = [];
+    const gangRuns = new GangRunService((jobId, data) => {
+      jobIds.push(jobId);
+      return fake.dispatch(jobId, data);
+    }, { windowMs: 1000 });
+
+    const order = gangRuns.submit(makeOrder('a', 1));
+    expect(order.jobId).toBeDefined();
+    gangRuns.flush();
+    await flush();
+
+    expect(jobIds).toEqual([order.jobId]);
+  });
+
+  it('should rebuild a resumed batch from its snapshot and split the result by order', async () => {
+    const snapshots: GangRunSnapshot[] = [];
+    const packings: Array<Promise<MultiSheetResult>> = [];
+    const before = new GangRunService((jobId, data, snapshot) => {
+      snapshots.push(snapshot);
+      const packing = fake.dispatch(jobId, data);
+      packings.push(packing);
+      return new Promise(() => {}); // The process stops before the batch is packed
+    });
+    const order = before.submit(makeOrder('a', 2));
+    before.submit(makeOrder('b', 1));
+    before.flush();
+
+    // After the restart: only the checkpointed job and its snapshot are left
+    const after = new GangRunService(fake.dispatch);
+    after.resume(order.jobId!, snapshots[0], packings[0]);
+    expect(after.getOrder('a')).toMatchObject({ status: 'packing', itemCount: 2, jobId: order.jobId });
+    await flush();
+
+    expect(after.getOrder('a')?.sheets?.[0].placements.map(p => p.id)).toEqual(['design_0', 'design_1']);
+    expect(after.getOrder('b')?.sheets?.[0].placements.map(p => p.id)).toEqual(['design_0']);
+    expect(after.getBatch(order.batchId)?.sort?.[0].orders.map(o => o.orderId)).toEqual(['a', 'b']);
+  });
+
+  it('should report a failed batch on every order in it', async () => {
+    const gangRuns = new GangRunService(async () => { throw new Error('no space'); });
+    gangRuns.submit(makeOrder('a', 1));
+    gangRuns.submit(makeOrder('b', 1));
+    gangRuns.flush();
+    await flush();
+
+    expect(gangRuns.getOrder('a')).toMatchObject({ status: 'error', error: 'no space' });
+    expect(gangRuns.getOrder('b')).toMatchObject({ status: 'error', error: 'no space' });
+  });
+});
+
+describe('splitByOrder', () => {
+  it('should leave out sheets an order has no items on', () => {
+    const owners = new Map([
+      ['a:x_0', { orderId: 'a', itemId: 'x_0' }],
+      ['b:y_0', { orderId: 'b', itemId: 'y_0' }],
+    ]);
+    const { orderSheets } = splitByOrder([
+      { sheetIndex: 0, placements: [{ id: 'a:x_0', x: 0, y: 0, rotation: 0 }], utilization: 10 },
+      { sheetIndex: 1, placements: [{ id: 'b:y_0', x: 0, y: 0, rotation: 90 }], utilization: 10 },
+    ], owners);
+
+    expect(orderSheets.get('a')!.map(s => s.sheetIndex)).toEqual([0]);
+    expect(orderSheets.get('b')!.map(s => s.sheetIndex)).toEqual([1]);
+  });
+});
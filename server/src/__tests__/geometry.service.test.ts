@@ -259,6 +259,35 @@ describe('GeometryService', () => {
     });
   });
 
+  describe('insetPolygon', () => {
+    it('should shrink a square by the inset distance', () => {
+      const points: Point[] = [
+        { x: 0, y: 0 },
+        { x: 100, y: 0 },
+        { x: 100, y: 100 },
+        { x: 0, y: 100 },
+      ];
+
+      const inset = service.insetPolygon(points, 10);
+
+      expect(inset).toHaveLength(1);
+      const bbox = service.getBoundingBox(inset[0]);
+      expect(bbox.width).toBeCloseTo(80, 1);
+      expect(bbox.height).toBeCloseTo(80, 1);
+    });
+
+    it('should return nothing when the polygon vanishes', () => {
+      const points: Point[] = [
+        { x: 0, y: 0 },
+        { x: 4, y: 0 },
+        { x: 4, y: 4 },
+        { x: 0, y: 4 },
+      ];
+
+      expect(service.insetPolygon(points, 5)).toEqual([]);
+    });
+  });
+
   describe('Non-rectangular shapes - getBoundingBox', () => {
     it('should calculate bounding box for a triangle', () => {
       const points: Point[] = [
@@ -492,4 +521,87 @@ describe('GeometryService', () => {
       expect(simplified.length).toBe(3);
     });
   });
+
+  describe('Shape descriptors', () => {
+    it('should compute exact area of a square', () => {
+      const square: Point[] = [
+        { x: 0, y: 0 },
+        { x: 2, y: 0 },
+        { x: 2, y: 2 },
+        { x: 0, y: 2 },
+      ];
+
+      expect(service.calculateArea(square)).toBeCloseTo(4, 5);
+      expect(service.calculatePerimeter(square)).toBeCloseTo(8, 5);
+    });
+
+    it('should compute exact area of an L-shape (less than bounding box)', () => {
+      const lShape: Point[] = [
+        { x: 0, y: 0 },
+        { x: 4, y: 0 },
+        { x: 4, y: 1 },
+        { x: 1, y: 1 },
+        { x: 1, y: 4 },
+        { x: 0, y: 4 },
+      ];
+
+      // Bounding box is 16 sq units; exact area is 7
+      expect(service.calculateArea(lShape)).toBeCloseTo(7, 5);
+    });
+
+    it('should compute convex hull of a concave polygon', () => {
+      const lShape: Point[] = [
+        { x: 0, y: 0 },
+        { x: 4, y: 0 },
+        { x: 4, y: 1 },
+        { x: 1, y: 1 },
+        { x: 1, y: 4 },
+        { x: 0, y: 4 },
+      ];
+
+      const hull = service.getConvexHull(lShape);
+
+      // Inner corner (1, 1) is not on the hull
+      expect(hull).not.toContainEqual({ x: 1, y: 1 });
+      expect(hull.length).toBe(5);
+      // Hull: square 4x4 minus triangle (4,1)-(1,4)-(4,4) = 16 - 4.5
+      expect(service.calculateArea(hull)).toBeCloseTo(11.5, 5);
+    });
+
+    it('should report solidity 1.0 for convex shapes and < 1.0 for concave shapes', () => {
+      const square: Point[] = [
+        { x: 0, y: 0 },
+        { x: 2, y: 0 },
+        { x: 2, y: 2 },
+        { x: 0, y: 2 },
+      ];
+      const lShape: Point[] = [
+        { x: 0, y: 0 },
+        { x: 4, y: 0 },
+        { x: 4, y: 1 },
+        { x: 1, y: 1 },
+        { x: 1, y: 4 },
+        { x: 0, y: 4 },
+      ];
+
+      expect(service.getShapeDescriptors(square).solidity).toBeCloseTo(1, 5);
+
+      const descriptors = service.getShapeDescriptors(lShape);
+      expect(descriptors.area).toBeCloseTo(7, 5);
+      expect(descriptors.hullArea).toBeCloseTo(11.5, 5);
+      expect(descriptors.solidity).toBeCloseTo(7 / 11.5, 5);
+      expect(descriptors.perimeter).toBeCloseTo(16, 5);
+    });
+
+    it('should scale descriptors between units', () => {
+      const scaled = service.scaleShapeDescriptors(
+        { area: 645.16, hullArea: 645.16, perimeter: 101.6, solidity: 1 },
+        1 / 25.4
+      );
+
+      expect(scaled.area).toBeCloseTo(1, 5);
+      expect(scaled.perimeter).toBeCloseTo(4, 5);
+      expect(scaled.solidity).toBe(1);
+    });
+  });
 });
@@ -0,0 +1,99 @@
+import fs from 'fs';
+import os from 'os';
+import path from 'path';
+import { JobCheckpointService } from '../services/job-checkpoint.service';
+import { PackingWorkerData, PackingCheckpoint } from '../workers/packing.worker';
+
+describe('JobCheckpointService', () => {
+  let directory: string;
+  let service: JobCheckpointService;
+
+  const jobData: PackingWorkerData = {
+    type: 'multi-sheet',
+    stickers: [{ id: 'a_0', points: [], width: 25.4, height: 25.4 }],
+    sheetWidth: 215.9,
+    sheetHeight: 279.4,
+    spacing: 1.5875,
+    cellsPerInch: 100,
+    stepSize: 0.05,
+    rotations: [0, 90, 180, 270],
+    pageCount: 2,
+    packAllItems: true,
+  };
+
+  const checkpoint: PackingCheckpoint = {
+    sheets: [{ sheetIndex: 0, placements: [{ id: 'a_0', x: 0, y: 0, rotation: 0 }], utilization: 10 }],
+    remainingIds: ['a_1'],
+    pageCount: 2,
+    attempts: 1,
+    savedAt: Date.now(),
+  };
+
+  beforeEach(() => {
+    directory = fs.mkdtempSync(path.join(os.tmpdir(), 'mosaic-checkpoint-test-'));
+    service = new JobCheckpointService(directory);
+  });
+
+  afterEach(() => {
+    fs.rmSync(directory, { recursive: true, force: true });
+  });
+
+  it('should not claim jobs owned by the running process', () => {
+    service.createJob('job-1', jobData, 'socket-1');
+    service.saveCheckpoint('job-1', checkpoint);
+
+    expect(service.claimOrphanedJobs()).toEqual([]);
+  });
+
+  it('should claim jobs whose owner is gone, with their last checkpoint', () => {
+    service.createJob('job-1', jobData, 'socket-1');
+    service.saveCheckpoint('job-1', checkpoint);
+
+    // Simulate a previous incarnation of this process (same PID, different start time)
+    fs.writeFileSync(path.join(directory, 'job-1', 'owner'), `${process.pid}:0`);
+
+    const claimed = service.claimOrphanedJobs();
+    expect(claimed).toHaveLength(1);
+    expect(claimed[0].jobId).toBe('job-1');
+    expect(claimed[0].socketId).toBe('socket-1');
+    expect(claimed[0].data.stickers).toEqual(jobData.stickers);
+    expect(claimed[0].checkpoint).toEqual(checkpoint);
+
+    // Now owned by this process
+    expect(service.claimOrphanedJobs()).toEqual([]);
+  });
+
+  it('should keep the gang-run batch snapshot with the job', () => {
+    const gangRun = { batchId: 'batch-1', orderIds: ['a'], owners: [{ id: 'a:a_0', orderId: 'a', itemId: 'a_0' }] };
+    service.createJob('job-1', jobData, null, gangRun);
+    fs.writeFileSync(path.join(directory, 'job-1', 'owner'), `${process.pid}:0`);
+
+    expect(service.claimOrphanedJobs()[0].gangRun).toEqual(gangRun);
+  });
+
+  it('should leave a job to the process that claimed it first', () => {
+    service.createJob('job-1', jobData);
+    fs.writeFileSync(path.join(directory, 'job-1', 'owner'), `${process.pid}:0`);
+
+    // Another process took over from the same dead owner but hasn't rewritten owner yet
+    fs.writeFileSync(path.join(directory, 'job-1', `claim.${process.pid}_0`), '');
+
+    expect(service.claimOrphanedJobs()).toEqual([]);
+  });
+
+  it('should resume from the start when no sheet was checkpointed', () => {
+    service.createJob('job-1', jobData);
+    fs.writeFileSync(path.join(directory, 'job-1', 'owner'), `${process.pid}:0`);
+
+    const claimed = service.claimOrphanedJobs();
+    expect(claimed[0].checkpoint).toBeUndefined();
+  });
+
+  it('should remove finished jobs and ignore their late checkpoints', () => {
+    service.createJob('job-1', jobData);
+    service.completeJob('job-1');
+    service.saveCheckpoint('job-1', checkpoint);
+
+    expect(fs.existsSync(path.join(directory, 'job-1'))).toBe(false);
+  });
+});
@@ -0,0 +1,37 @@
+import { JobEventsService, JobStreamEvent, summarizeResult } from '../services/job-events.service';
+
+describe('JobEventsService', () => {
+  const sheet = { sheetIndex: 0, placements: [{ id: 'a_0', x: 0, y: 0, rotation: 0 }], utilization: 12.5 };
+
+  it('should deliver events only to subscribers of that job', () => {
+    const events = new JobEventsService();
+    const received: JobStreamEvent[] = [];
+    events.subscribe('job-1', event => received.push(event));
+
+    events.publish('job-1', { type: 'sheet', sheet });
+    events.publish('job-2', { type: 'error', error: 'other job' });
+
+    expect(received).toEqual([{ type: 'sheet', sheet }]);
+  });
+
+  it('should stop delivering after unsubscribe', () => {
+    const events = new JobEventsService();
+    const received: JobStreamEvent[] = [];
+    const unsubscribe = events.subscribe('job-1', event => received.push(event));
+
+    unsubscribe();
+    events.publish('job-1', { type: 'sheet', sheet });
+
+    expect(received).toHaveLength(0);
+  });
+
+  it('should summarize a multi-sheet result without its sheets', () => {
+    const summary = summarizeResult({
+      sheets: [sheet, { ...sheet, sheetIndex: 1 }],
+      totalUtilization: 12.5,
+      quantities: { a: 2 },
+    });
+
+    expect(summary).toEqual({ totalUtilization: 12.5, quantities: { a: 2 }, sheetCount: 2 });
+  });
+});
@@ -0,0 +1,132 @@
+import { JobSchedulerService } from '../services/job-scheduler.service';
+import { WorkerManagerService } from '../services/worker-manager.service';
+import { PackingWorkerData } from '../workers/packing.worker';
+
+/**
+ * Fake worker manager: jobs stay running until the test finishes them
+ */
+class FakeWorkerManager {
+  started: string[] = [];
+  startedData = new Map<string, PackingWorkerData>();
+  private pending = new Map<string, () => void>();
+
+  executePackingJob(jobId: string, data: PackingWorkerData): Promise<any> {
+    this.started.push(jobId);
+    this.startedData.set(jobId, data);
+    return new Promise(resolve => {
+      this.pending.set(jobId, () => resolve({}));
+    });
+  }
+
+  finish(jobId: string): void {
+    this.pending.get(jobId)?.();
+    this.pending.delete(jobId);
+  }
+}
+
+const flush = () => new Promise(resolve => setImmediate(resolve));
+
+function makeJob(itemCount: number, type: 'single-sheet' | 'multi-sheet', rotations: number = 4): PackingWorkerData {
+  return {
+    type,
+    stickers: Array.from({ length: itemCount }, (_, i) => ({
+      id: `s_${i}`,
+      points: [],
+      width: 25.4,
+      height: 25.4,
+    })),
+    sheetWidth: 215.9,
+    sheetHeight: 279.4,
+    spacing: 1.5875,
+    cellsPerInch: 100,
+    stepSize: 0.05,
+    rotations: Array.from({ length: rotations }, (_, i) => i * (360 / rotations)),
+    pageCount: 10,
+    packAllItems: true,
+  };
+}
+
+describe('JobSchedulerService', () => {
+  let fake: FakeWorkerManager;
+
+  beforeEach(() => {
+    fake = new FakeWorkerManager();
+  });
+
+  it('should estimate cost proportional to items × rotations', () => {
+    const scheduler = new JobSchedulerService(fake as unknown as WorkerManagerService, { maxConcurrent: 1 });
+
+    const small = scheduler.estimateCost(makeJob(10, 'multi-sheet', 4));
+    const large = scheduler.estimateCost(makeJob(20, 'multi-sheet', 8));
+
+    expect(large.costUnits).toBe(small.costUnits * 4);
+  });
+
+  it('should classify single-sheet jobs as interactive and big production jobs as batch', () => {
+    const scheduler = new JobSchedulerService(fake as unknown as WorkerManagerService, { maxConcurrent: 1 });
+
+    expect(scheduler.estimateCost(makeJob(10, 'single-sheet')).queue).toBe('interactive');
+    expect(scheduler.estimateCost(makeJob(500, 'multi-sheet', 360)).queue).toBe('batch');
+  });
+
+  it('should run the shortest queued job first', async () => {
+    const scheduler = new JobSchedulerService(fake as unknown as WorkerManagerService, { maxConcurrent: 1 });
+
+    scheduler.submit('running', makeJob(5, 'multi-sheet'));
+    scheduler.submit('long', makeJob(400, 'multi-sheet', 72));
+    scheduler.submit('short', makeJob(50, 'multi-sheet', 72));
+
+    expect(fake.started).toEqual(['running']);
+
+    fake.finish('running');
+    await flush();
+
+    expect(fake.started).toEqual(['running', 'short']);
+  });
+
+  it('should keep a slot free for interactive jobs when batch work is queued', async () => {
+    const scheduler = new JobSchedulerService(fake as unknown as WorkerManagerService, {
+      maxConcurrent: 2,
+      queueBudgetSeconds: 1e6,
+    });
+
+    scheduler.submit('batch-1', makeJob(500, 'multi-sheet', 72));
+    scheduler.submit('batch-2', makeJob(500, 'multi-sheet', 72));
+    expect(fake.started).toEqual(['batch-1']);
+
+    const preview = scheduler.submit('preview', makeJob(10, 'single-sheet'));
+    expect(preview.accepted).toBe(true);
+    expect(fake.started).toEqual(['batch-1', 'preview']);
+  });
+
+  it('should reject with a retry hint when queued work exceeds the budget', () => {
+    const scheduler = new JobSchedulerService(fake as unknown as WorkerManagerService, {
+      maxConcurrent: 1,
+      queueBudgetSeconds: 60,
+    });
+
+    scheduler.submit('running', makeJob(500, 'multi-sheet', 72));
+    const queued = scheduler.submit('queued', makeJob(10, 'multi-sheet', 72));
+    const rejected = scheduler.submit('rejected', makeJob(500, 'multi-sheet', 360));
+
+    expect(queued.accepted).toBe(true);
+    expect(rejected.accepted).toBe(false);
+    expect(rejected.retryAfterSeconds).toBeGreaterThan(0);
+    expect(fake.started).toEqual(['running']);
+  });
+
+  it('should grant concurrent placement only the free slots and hold them while running', async () => {
+    const scheduler = new JobSchedulerService(fake as unknown as WorkerManagerService, { maxConcurrent: 3 });
+
+    scheduler.submit('other', makeJob(5, 'single-sheet'));
+    scheduler.submit('wide', { ...makeJob(1000, 'single-sheet'), placementWorkers: 4 });
+    scheduler.submit('waiting', makeJob(5, 'single-sheet'));
+
+    expect(fake.started).toEqual(['other', 'wide']);
+    expect(fake.startedData.get('wide')!.placementWorkers).toBe(2);
+
+    fake.finish('other');
+    await flush();
+    expect(fake.started).toEqual(['other', 'wide', 'waiting']);
+  });
+});
@@ -1,4 +1,12 @@
-import { NestingService, Sticker } from '../services/nesting.service';
+import {
+  NestingService,
+  SheetPlacement,
+  Sticker,
+  designKeysOf,
+  groupSheetCopies,
+  repeatPackedSheet,
+  sheetTemplatesOf
+} from '../services/nesting.service';
 import { Point } from '../services/image.service';
 
 describe('NestingService', () => {
@@ -867,3 +875,103 @@ describe('NestingService', () => {
     });
   });
 });
+
+describe('Sheet layout repeats', () => {
+  const item = (id: string, size: number): Sticker => ({
+    id,
+    points: [
+      { x: 0, y: 0 },
+      { x: size, y: 0 },
+      { x: size, y: size },
+      { x: 0, y: size },
+    ],
+    width: size,
+    height: size,
+  });
+  const items = [
+    item('cat_0', 10), item('cat_1', 10), item('cat_2', 10), item('cat_3', 10),
+    item('dog_0', 20), item('dog_1', 20),
+  ];
+  const designKeys = designKeysOf(items);
+  const template: SheetPlacement = {
+    sheetIndex: 0,
+    placements: [
+      { id: 'cat_0', x: 0, y: 0, rotation: 0 },
+      { id: 'dog_0', x: 20, y: 0, rotation: 90 },
+    ],
+    utilization: 50,
+  };
+  const designs = new Set(items.map(i => designKeys.get(i.id)!));
+
+  it('should re-assign the layout to remaining instances of the same designs', () => {
+    const repeat = repeatPackedSheet([{ sheet: template, designs }], ['cat_1', 'cat_2', 'dog_1'], designKeys);
+
+    expect(repeat?.template).toBe(template);
+    expect(repeat?.placements).toEqual([
+      { id: 'cat_1', x: 0, y: 0, rotation: 0 },
+      { id: 'dog_1', x: 20, y: 0, rotation: 90 },
+    ]);
+  });
+
+  it('should not repeat a layout the remaining items cannot fill', () => {
+    expect(repeatPackedSheet([{ sheet: template, designs }], ['cat_1', 'cat_2'], designKeys)).toBeNull();
+  });
+
+  it('should not repeat a layout packed without a design that is now remaining', () => {
+    const narrow = { sheet: template, designs: new Set([designKeys.get('cat_0')!, designKeys.get('dog_0')!]) };
+    const keys = designKeysOf([...items, item('fox_0', 5)]);
+
+    expect(repeatPackedSheet([narrow], ['cat_1', 'dog_1', 'fox_0'], keys)).toBeNull();
+  });
+
+  it('should tell designs apart by size as well as by ID', () => {
+    const keys = designKeysOf([item('cat_0', 10), item('cat_1', 12)]);
+    expect(keys.get('cat_0')).not.toBe(keys.get('cat_1'));
+  });
+
+  it('should tell apart designs with the same size and vertex count', () => {
+    const diamond: Sticker = {
+      id: 'logo_2',
+      points: [
+        { x: 5, y: 0 },
+        { x: 10, y: 5 },
+        { x: 5, y: 10 },
+        { x: 0, y: 5 },
+      ],
+      width: 10,
+      height: 10,
+    };
+    const keys = designKeysOf([item('logo_1', 10), diamond, item('photoA_0', 76.2), item('photoB_0', 76.2)]);
+
+    expect(keys.get('logo_1')).not.toBe(keys.get('logo_2'));
+    expect(keys.get('photoA_0')).not.toBe(keys.get('photoB_0'));
+  });
+
+  it('should group sheets by the layout they print', () => {
+    const sheets: SheetPlacement[] = [
+      template,
+      { ...template, sheetIndex: 1, copyOf: 0 },
+      { ...template, sheetIndex: 2, placements: [] },
+      { ...template, sheetIndex: 3, copyOf: 0 },
+    ];
+
+    expect(groupSheetCopies(sheets)).toEqual([
+      { sheetIndex: 0, copies: 3 },
+      { sheetIndex: 2, copies: 1 },
+    ]);
+    expect(groupSheetCopies([template])).toBeUndefined();
+  });
+
+  it('should rebuild templates from checkpointed sheets', () => {
+    const sheets: SheetPlacement[] = [
+      template,
+      { sheetIndex: 1, placements: [{ id: 'cat_1', x: 0, y: 0, rotation: 0 }], utilization: 10 },
+      { sheetIndex: 2, placements: [{ id: 'cat_2', x: 0, y: 0, rotation: 0 }], utilization: 10, copyOf: 1 },
+    ];
+
+    const templates = sheetTemplatesOf(sheets, ['cat_3'], designKeys, index => index !== 1);
+
+    expect(templates.map(t => t.sheet.sheetIndex)).toEqual([0]);
+    expect(templates[0].designs).toEqual(new Set([designKeys.get('cat_0'), designKeys.get('dog_0')]));
+  });
+});
@@ -0,0 +1,160 @@
+import {
+  PageCountPredictor,
+  ClusterPageCountPredictor,
+  PackingFeatures,
+  extractPackingFeatures,
+  efficiencyFromSheets,
+} from '../services/page-count-predictor.service';
+import { PackablePolygon } from '../services/polygon-packing.service';
+
+describe('PageCountPredictor', () => {
+  const baseFeatures: PackingFeatures = {
+    meanSolidity: 0.8,
+    sizeDispersion: 0.2,
+    rotationCount: 4,
+    sheetAspect: 11 / 8.5,
+    relativeItemSize: 0.05,
+    totalItemArea: 500,
+    sheetArea: 8.5 * 11,
+  };
+
+  describe('predict', () => {
+    it('should return ordered quantiles above the hard lower bound', () => {
+      const predictor = new PageCountPredictor();
+      const prediction = predictor.predict(baseFeatures);
+
+      expect(prediction.hardLowerBound).toBe(Math.ceil(500 / (8.5 * 11)));
+      expect(prediction.lowerBound).toBeGreaterThanOrEqual(prediction.hardLowerBound);
+      expect(prediction.median).toBeGreaterThanOrEqual(prediction.lowerBound);
+      expect(prediction.upperBound).toBeGreaterThanOrEqual(prediction.median);
+    });
+
+    it('should return a distribution that sums to 1', () => {
+      const predictor = new PageCountPredictor();
+      const prediction = predictor.predict(baseFeatures);
+
+      const total = prediction.distribution.reduce((sum, d) => sum + d.probability, 0);
+      expect(total).toBeCloseTo(1, 5);
+    });
+
+    it('should start near the old 60% efficiency constant before training', () => {
+      const predictor = new PageCountPredictor();
+      const { mean } = predictor.predictEfficiency(baseFeatures);
+
+      expect(mean).toBeGreaterThan(0.5);
+      expect(mean).toBeLessThan(0.7);
+    });
+  });
+
+  describe('training', () => {
+    it('should move predictions toward observed efficiency', () => {
+      const predictor = new PageCountPredictor();
+      const before = predictor.predictEfficiency(baseFeatures).mean;
+
+      for (let i = 0; i < 50; i++) {
+        predictor.observe({ features: baseFeatures, efficiency: 0.35 });
+      }
+
+      const after = predictor.predictEfficiency(baseFeatures);
+      expect(after.mean).toBeLessThan(before);
+      expect(after.mean).toBeCloseTo(0.35, 1);
+      expect(predictor.predict(baseFeatures).median).toBeGreaterThan(Math.ceil(500 / (8.5 * 11 * 0.6)));
+    });
+
+    it('should round-trip model state', () => {
+      const predictor = new PageCountPredictor();
+      predictor.trainOffline([
+        { features: baseFeatures, efficiency: 0.55 },
+        { features: { ...baseFeatures, meanSolidity: 0.5 }, efficiency: 0.4 },
+      ]);
+
+      const restored = new PageCountPredictor(predictor.getModel());
+      expect(restored.predictEfficiency(baseFeatures).mean).toBeCloseTo(
+        predictor.predictEfficiency(baseFeatures).mean,
+        10
+      );
+    });
+
+    it('should ignore invalid efficiency samples', () => {
+      const predictor = new PageCountPredictor();
+      const before = predictor.getModel();
+
+      predictor.observe({ features: baseFeatures, efficiency: 0 });
+      predictor.observe({ features: baseFeatures, efficiency: 1.5 });
+
+      expect(predictor.getModel()).toEqual(before);
+    });
+  });
+
+  describe('ClusterPageCountPredictor', () => {
+    const originalSend = process.send;
+    let sent: any[];
+    let existingListeners: Function[];
+
+    beforeEach(() => {
+      sent = [];
+      existingListeners = process.listeners('message');
+      process.send = ((message: any) => { sent.push(message); return true; }) as typeof process.send;
+    });
+
+    afterEach(() => {
+      process.send = originalSend;
+      process.listeners('message')
+        .filter(listener => !existingListeners.includes(listener))
+        .forEach(listener => process.removeListener('message', listener as (...args: any[]) => void));
+    });
+
+    it('should forward completed jobs to the primary instead of observing them', () => {
+      const replica = new ClusterPageCountPredictor();
+      const before = replica.getModel();
+      const sample = { features: baseFeatures, efficiency: 0.55 };
+
+      replica.recordCompletedJob(sample);
+
+      expect(sent).toEqual([{ type: 'predictor:sync' }, { type: 'predictor:observe', sample }]);
+      expect(replica.getModel()).toEqual(before);
+    });
+
+    it('should take the model the primary sends', () => {
+      const primary = new PageCountPredictor();
+      primary.recordCompletedJob({ features: baseFeatures, efficiency: 0.55 });
+      const replica = new ClusterPageCountPredictor();
+
+      process.emit('message', { type: 'predictor:model', model: primary.getModel() }, undefined);
+
+      expect(replica.getModel()).toEqual(primary.getModel());
+    });
+  });
+
+  describe('efficiencyFromSheets', () => {
+    it('should exclude the partial last sheet when all items were placed', () => {
+      expect(efficiencyFromSheets([60, 70, 20], true)).toBeCloseTo(0.65, 5);
+    });
+
+    it('should use every sheet when items remain unplaced', () => {
+      expect(efficiencyFromSheets([60, 70], false)).toBeCloseTo(0.65, 5);
+    });
+
+    it('should return null for a single partial sheet', () => {
+      expect(efficiencyFromSheets([40], true)).toBeNull();
+    });
+  });
+
+  describe('extractPackingFeatures', () => {
+    it('should compute solidity, dispersion and relative size', () => {
+      const polygons: PackablePolygon[] = [
+        { id: 'a', points: [], width: 2, height: 2, area: 2, hullArea: 4, solidity: 0.5 },
+        { id: 'b', points: [], width: 2, height: 2, area: 2, hullArea: 2, solidity: 1 },
+      ];
+
+      const features = extractPackingFeatures(polygons, 10, 5, 8);
+
+      expect(features.meanSolidity).toBeCloseTo(0.75, 5);
+      expect(features.sizeDispersion).toBeCloseTo(0, 5);
+      expect(features.sheetAspect).toBe(2);
+      expect(features.relativeItemSize).toBeCloseTo(3 / 50, 5);
+      expect(features.totalItemArea).toBe(4);
+      expect(features.rotationCount).toBe(8);
+    });
+  });
+});
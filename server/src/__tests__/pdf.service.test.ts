@@ -0,0 +1,155 @@
+import { PassThrough } from 'stream';
+import PDFDocument from 'pdfkit';
+import sharp from 'sharp';
+import { PdfService } from '../services/pdf.service';
+import { Sticker, SheetPlacement } from '../services/nesting.service';
+
+describe('PdfService', () => {
+  let stickers: Map<string, Sticker & { imageBuffer: Buffer }>;
+
+  beforeAll(async () => {
+    const imageBuffer = await sharp({
+      create: { width: 20, height: 20, channels: 4, background: { r: 255, g: 0, b: 0, alpha: 1 } },
+    })
+      .png()
+      .toBuffer();
+
+    stickers = new Map([
+      ['a', { id: 'a', points: [{ x: 0, y: 0 }, { x: 10, y: 0 }, { x: 10, y: 10 }], width: 10, height: 10, imageBuffer }],
+    ]);
+  });
+
+  function collect(stream: PassThrough): Promise<string> {
+    const chunks: Buffer[] = [];
+    stream.on('data', chunk => chunks.push(chunk));
+    return new Promise(resolve => stream.on('end', () => resolve(Buffer.concat(chunks).toString('latin1'))));
+  }
+
+  function countPages(pdf: string): number {
+    return (pdf.match(/\/Type \/Page\b(?!s)/g) || []).length;
+  }
+
+  const sheet = (sheetIndex: number): SheetPlacement => ({
+    sheetIndex,
+    placements: [{ id: `a_${sheetIndex}`, x: 5, y: 5, rotation: sheetIndex * 90 }],
+    utilization: 10,
+  });
+
+  describe('createSheetRenderer', () => {
+    it('should render one page per sheet as sheets are added', async () => {
+      const pdfService = new PdfService();
+      const output = new PassThrough();
+      const pdf = collect(output);
+
+      const renderer = pdfService.createSheetRenderer(stickers, 100, 100, output);
+      renderer.addSheet(sheet(0));
+      renderer.addSheet(sheet(1));
+      renderer.addSheet(sheet(2));
+      await renderer.finish();
+
+      expect(renderer.getPageCount()).toBe(3);
+      expect(countPages(await pdf)).toBe(3);
+    });
+
+    it('should ignore a sheet that was already rendered', async () => {
+      const pdfService = new PdfService();
+      const output = new PassThrough();
+      const pdf = collect(output);
+
+      const renderer = pdfService.createSheetRenderer(stickers, 100, 100, output);
+      renderer.addSheet(sheet(0));
+      renderer.addSheet(sheet(0));
+      await renderer.finish();
+
+      expect(countPages(await pdf)).toBe(1);
+    });
+
+    it('should draw a repeated layout once and list its copies on a print-run page', async () => {
+      const pdfService = new PdfService();
+      const output = new PassThrough();
+      const pdf = collect(output);
+
+      const renderer = pdfService.createSheetRenderer(stickers, 100, 100, output);
+      renderer.addSheet(sheet(0));
+      renderer.addSheet({ ...sheet(1), copyOf: 0 });
+      renderer.addSheet({ ...sheet(2), copyOf: 0 });
+      await renderer.finish();
+
+      expect(renderer.getPageCount()).toBe(1);
+      expect(countPages(await pdf)).toBe(2);
+    });
+
+    it('should stop drawing pages once aborted', async () => {
+      const pdfService = new PdfService();
+      const output = new PassThrough();
+      const written = jest.fn();
+      output.on('data', written);
+
+      const renderer = pdfService.createSheetRenderer(stickers, 100, 100, output);
+      renderer.addSheet(sheet(0));
+      renderer.abort();
+      renderer.addSheet(sheet(1));
+      await renderer.finish();
+
+      expect(renderer.getPageCount()).toBe(0);
+      expect(written).not.toHaveBeenCalled();
+    });
+
+    it('should still produce a valid single-page PDF with no sheets', async () => {
+      const pdfService = new PdfService();
+      const output = new PassThrough();
+      const pdf = collect(output);
+
+      await pdfService.createSheetRenderer(stickers, 100, 100, output).finish();
+
+      const contents = await pdf;
+      expect(contents.startsWith('%PDF')).toBe(true);
+      expect(countPages(contents)).toBe(1);
+    });
+
+    it('should cut every hole of a sticker as well as its outline', async () => {
+      const pdfService = new PdfService();
+      const output = new PassThrough();
+      const pdf = collect(output);
+      const ring = stickers.get('a')!;
+      const ringStickers = new Map([
+        ['a', {
+          ...ring,
+          points: [{ x: 0, y: 0 }, { x: 10, y: 0 }, { x: 10, y: 10 }, { x: 0, y: 10 }],
+          holes: [[{ x: 3, y: 3 }, { x: 3, y: 7 }, { x: 7, y: 7 }, { x: 7, y: 3 }]],
+        }],
+      ]);
+      const moveTo = jest.spyOn(PDFDocument.prototype, 'moveTo');
+
+      try {
+        const renderer = pdfService.createSheetRenderer(ringStickers, 100, 100, output);
+        renderer.addSheet(sheet(0));
+        await renderer.finish();
+        await pdf;
+
+        // One subpath for the outline, one for the hole
+        expect(moveTo).toHaveBeenCalledTimes(2);
+      } finally {
+        moveTo.mockRestore();
+      }
+    });
+
+    it('should draw SVG stickers as vector paths instead of embedding an image', async () => {
+      const pdfService = new PdfService();
+      const output = new PassThrough();
+      const pdf = collect(output);
+      const svg = Buffer.from('<svg xmlns="http://www.w3.org/2000/svg"><circle cx="50" cy="50" r="40" fill="#0a0"/></svg>');
+      const vectorStickers = new Map([
+        ['a', { id: 'a', points: [{ x: 0, y: 0 }, { x: 10, y: 0 }, { x: 10, y: 10 }], width: 10, height: 10, imageBuffer: svg }],
+      ]);
+
+      const renderer = pdfService.createSheetRenderer(vectorStickers, 100, 100, output);
+      renderer.addSheet(sheet(0));
+      await renderer.finish();
+
+      const contents = await pdf;
+      expect(countPages(contents)).toBe(1);
+      expect(contents).not.toContain('/Subtype /Image');
+    });
+  });
+});
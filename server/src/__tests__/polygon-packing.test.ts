@@ -4,9 +4,55 @@ import {
   PolygonPacker,
   PackablePolygon,
   GridCell,
+  ShapeCache,
+  chamferTransform,
+  claimFrom,
+  createWeightedScorer,
+  getRectangularity,
+  HYBRID_MIN_RECTANGULARITY,
+  toPackablePolygon,
+  estimateSpaceRequirements,
+  packNextStockSheet,
 } from '../services/polygon-packing.service';
 import { Point } from '../services/image.service';
 import { NestingService, Sticker } from '../services/nesting.service';
+import { PageCountPredictor } from '../services/page-count-predictor.service';
+
+/**
+ * Axis-aligned rectangle with its corner at the origin
+ */
+function rectanglePolygon(id: string, width: number, height: number): PackablePolygon {
+  return {
+    id,
+    points: [
+      { x: 0, y: 0 },
+      { x: width, y: 0 },
+      { x: width, y: height },
+      { x: 0, y: height },
+    ],
+    width,
+    height,
+    area: width * height,
+  };
+}
+
+function squarePolygon(id: string, size: number): PackablePolygon {
+  return rectanglePolygon(id, size, size);
+}
+
+/**
+ * Fail if two placements share a grid cell
+ */
+function expectNoOverlap(placements: Array<{ cells: GridCell[] }>): void {
+  const cells = new Set<string>();
+  for (const placement of placements) {
+    for (const cell of placement.cells) {
+      const key = `${cell.x},${cell.y}`;
+      expect(cells.has(key)).toBe(false);
+      cells.add(key);
+    }
+  }
+}
 
 describe('PolygonPacking', () => {
   describe('RasterGrid', () => {
@@ -50,6 +96,78 @@ describe('PolygonPacking', () => {
       expect(grid.checkCollision(outOfBoundsCells)).toBe(true);
     });
 
+    it('should release cells freed by a removed placement', () => {
+      const grid = new RasterGrid(12, 12, 100);
+      const cells: GridCell[] = [
+        { x: 10, y: 10 },
+        { x: 11, y: 10 },
+      ];
+
+      grid.markOccupied(cells);
+      grid.markFree(cells);
+
+      expect(grid.checkCollision(cells)).toBe(false);
+      expect(grid.getUtilization()).toBe(0);
+    });
+
+    it('should measure contact and slivers around a footprint', () => {
+      const grid = new RasterGrid(1, 1, 10);
+      const footprint: GridCell[] = [{ x: 0, y: 0 }, { x: 1, y: 0 }, { x: 0, y: 1 }, { x: 1, y: 1 }];
+
+      expect(grid.measureFootprint(footprint, 2)).toEqual({ perimeter: 8, contact: 4, slivers: 0 });
+
+      // A wall two cells to the right leaves a gap too narrow to use
+      grid.markOccupied([{ x: 4, y: 0 }, { x: 4, y: 1 }]);
+      expect(grid.measureFootprint(footprint, 2)).toEqual({ perimeter: 8, contact: 4, slivers: 4 });
+      expect(grid.checkCollision(footprint)).toBe(false);
+      expect(grid.getUsedBounds()).toEqual({ minX: 4, minY: 0, maxX: 4, maxY: 1 });
+    });
+
+    it('should keep the skyline and row free runs in step with occupancy', () => {
+      const grid = new RasterGrid(1, 1, 10); // 10x10 cells
+      const band: GridCell[] = [];
+      for (let y = 0; y < 3; y++) {
+        for (let x = 0; x < 10; x++) {
+          band.push({ x, y });
+        }
+      }
+
+      grid.markOccupied(band);
+      grid.markOccupied([{ x: 5, y: 3 }]);
+
+      expect(Array.from(grid.getSkyline())).toEqual([3, 3, 3, 3, 3, 4, 3, 3, 3, 3]);
+      expect(grid.getRowFreeRun(0)).toBe(0);
+      expect(grid.getRowFreeRun(3)).toBe(5);
+      expect(grid.getRowFreeRun(4)).toBe(10);
+
+      grid.markFree([{ x: 2, y: 1 }]);
+      expect(grid.getSkyline()[2]).toBe(1);
+      expect(grid.getRowFreeRun(1)).toBe(1);
+    });
+
+    it('should measure clearance to occupied cells and the sheet edge', () => {
+      const grid = new RasterGrid(1, 1, 10);
+      grid.markOccupied([{ x: 5, y: 5 }]);
+
+      expect(grid.getClearance(5, 5)).toBe(0);
+      expect(grid.getClearance(6, 5)).toBe(3);
+      expect(grid.getClearance(7, 7)).toBe(8);
+      expect(grid.getClearance(0, 0)).toBe(3);
+      expect(grid.getClearance(-1, 0)).toBe(0);
+    });
+
+    it('should clone into an independent grid', () => {
+      const grid = new RasterGrid(10, 10, 10);
+      const cells: GridCell[] = [{ x: 1, y: 1 }];
+      const copy = grid.clone();
+
+      copy.markOccupied(cells);
+
+      expect(copy.checkCollision(cells)).toBe(true);
+      expect(grid.checkCollision(cells)).toBe(false);
+      expect(grid.getUtilization()).toBe(0);
+    });
+
     it('should calculate utilization correctly', () => {
       const grid = new RasterGrid(10, 10, 10); // 100x100 = 10,000 cells
       const dims = grid.getDimensions();
@@ -122,6 +240,39 @@ describe('PolygonPacking', () => {
       // With spacing, polygon should be larger
       expect(cellsWithSpacing.length).toBeGreaterThan(cellsNoSpacing.length);
     });
+
+    it('should leave a hole free and shrink it by the spacing', () => {
+      const rasterizer = new PolygonRasterizer(100);
+      const donut = () => ({
+        points: [
+          { x: 0, y: 0 },
+          { x: 3, y: 0 },
+          { x: 3, y: 3 },
+          { x: 0, y: 3 },
+        ],
+        holes: [[
+          { x: 1, y: 1 },
+          { x: 2, y: 1 },
+          { x: 2, y: 2 },
+          { x: 1, y: 2 },
+        ]],
+      });
+
+      const plain = donut();
+      const cells = rasterizer.rasterizePolygon(plain.points, 0, 0, 0, 0, plain.holes);
+      const occupied = new Set(cells.map(c => `${c.x},${c.y}`));
+
+      // 9 sq in outline minus the 1 sq in hole
+      expect(cells.length).toBeGreaterThan(7800);
+      expect(cells.length).toBeLessThan(8200);
+      expect(occupied.has('150,150')).toBe(false);
+      expect(occupied.has('50,50')).toBe(true);
+
+      const spaced = donut();
+      const regions = rasterizer.holeRegions(spaced.points, spaced.holes, 0, 0, 0, 0.1);
+      expect(regions).toHaveLength(1);
+      expect(regions[0].maxX - regions[0].minX).toBeCloseTo(0.8, 2);
+    });
   });
 
   describe('PolygonPacker', () => {
@@ -199,21 +350,7 @@ describe('PolygonPacking', () => {
       expect(result.placements.length).toBeGreaterThan(0);
       expect(result.utilization).toBeGreaterThan(0);
 
-      // Verify no collisions by checking all placements have unique cells
-      const allCells = new Set<string>();
-      let hasCollision = false;
-
-      result.placements.forEach(placement => {
-        placement.cells.forEach(cell => {
-          const key = `${cell.x},${cell.y}`;
-          if (allCells.has(key)) {
-            hasCollision = true;
-          }
-          allCells.add(key);
-        });
-      });
-
-      expect(hasCollision).toBe(false);
+      expectNoOverlap(result.placements);
     });
 
     it('should pack irregular polygon (triangle)', async () => {
@@ -330,6 +467,69 @@ describe('PolygonPacking', () => {
       expect(result.quantities['sticker-B']).toBeGreaterThan(0);
     });
 
+    it('should fail fast in pack-all mode when an item cannot fit on an empty sheet', async () => {
+      const stickers: Sticker[] = [
+        {
+          id: 'oversized',
+          points: [
+            { x: 0, y: 0 },
+            { x: 50, y: 0 },
+            { x: 50, y: 50 },
+            { x: 0, y: 50 },
+          ],
+          width: 50,
+          height: 50,
+        },
+      ];
+
+      await expect(
+        service.nestStickersMultiSheetPolygon(stickers, 25.4, 25.4, 1, 0, 20, 0.2, [0], true)
+      ).rejects.toThrow("don't fit on an empty sheet");
+    });
+
+    it('should expand pages in pack-all mode without dropping earlier sheets', async () => {
+      // Six 1" squares on 2.1" x 2.1" sheets need several sheets
+      const stickers: Sticker[] = Array.from({ length: 6 }, (_, i) => ({
+        id: `square_${i}`,
+        points: [
+          { x: 0, y: 0 },
+          { x: 25.4, y: 0 },
+          { x: 25.4, y: 25.4 },
+          { x: 0, y: 25.4 },
+        ],
+        width: 25.4,
+        height: 25.4,
+      }));
+
+      const result = await service.nestStickersMultiSheetPolygon(stickers, 53.34, 53.34, 1, 0, 20, 0.1, [0], true);
+
+      const placed = result.sheets.reduce((sum, sheet) => sum + sheet.placements.length, 0);
+      expect(placed).toBe(6);
+      expect(result.sheets.map(s => s.sheetIndex)).toEqual(result.sheets.map((_, i) => i));
+    });
+
+    it('should repeat a packed sheet for remaining items with the same design mix', async () => {
+      // Four 1" squares fill a 2.1" x 2.1" sheet: twelve need three identical sheets
+      const stickers: Sticker[] = Array.from({ length: 12 }, (_, i) => ({
+        id: `square_${i}`,
+        points: [
+          { x: 0, y: 0 },
+          { x: 25.4, y: 0 },
+          { x: 25.4, y: 25.4 },
+          { x: 0, y: 25.4 },
+        ],
+        width: 25.4,
+        height: 25.4,
+      }));
+
+      const result = await service.nestStickersMultiSheetPolygon(stickers, 53.34, 53.34, 3, 0, 20, 0.1, [0], true);
+
+      expect(result.sheets.map(s => s.copyOf)).toEqual([undefined, 0, 0]);
+      expect(result.copies).toEqual([{ sheetIndex: 0, copies: 3 }]);
+      expect(result.sheets[1].placements.map(p => [p.x, p.y])).toEqual(result.sheets[0].placements.map(p => [p.x, p.y]));
+      expect(Object.keys(result.quantities).sort()).toEqual(stickers.map(s => s.id).sort());
+    });
+
     it('should handle irregular polygon shapes better than rectangles', async () => {
       // Create a C-shaped polygon that wastes space if packed as rectangle
       const cShape: Point[] = [
@@ -366,6 +566,482 @@ describe('PolygonPacking', () => {
     });
   });
 
+  describe('Incremental packing', () => {
+    const previous = [
+      { id: 'a', x: 0, y: 0, rotation: 0 },
+      { id: 'b', x: 2.5, y: 0, rotation: 0 },
+      { id: 'c', x: 0, y: 2.5, rotation: 0 },
+    ];
+
+    it('should keep every placement untouched by the edit', async () => {
+      const packer = new PolygonPacker(12, 12, 0.0625, 50, 0.1);
+      const result = await packer.packIncremental(
+        [squarePolygon('a', 2), squarePolygon('b', 2), squarePolygon('c', 2), squarePolygon('d', 2)],
+        previous,
+        ['d']
+      );
+
+      expect(result.keptIds.sort()).toEqual(['a', 'b', 'c']);
+      expect(result.repackedIds).toEqual(['d']);
+      expect(result.placements.find(p => p.id === 'b')).toMatchObject({ x: 2.5, y: 0 });
+      expect(result.unplacedPolygons).toHaveLength(0);
+    });
+
+    it('should move only the neighbours a resized item grows into', async () => {
+      const packer = new PolygonPacker(12, 12, 0.0625, 50, 0.1);
+      const result = await packer.packIncremental(
+        [squarePolygon('a', 3), squarePolygon('b', 2), squarePolygon('c', 2)],
+        previous,
+        ['a']
+      );
+
+      // 'a' stays anchored; 'b' and 'c' overlapped its new footprint and were re-placed
+      expect(result.placements.find(p => p.id === 'a')).toMatchObject({ x: 0, y: 0 });
+      expect(result.keptIds).toEqual([]);
+      expect(result.repackedIds.sort()).toEqual(['b', 'c']);
+
+      expectNoOverlap(result.placements);
+    });
+
+    it('should drop removed items and report layout density', async () => {
+      const packer = new PolygonPacker(12, 12, 0.0625, 50, 0.1);
+      const result = await packer.packIncremental([squarePolygon('a', 2), squarePolygon('c', 2)], previous, []);
+
+      expect(result.placements.map(p => p.id).sort()).toEqual(['a', 'c']);
+      expect(result.density).toBeCloseTo(result.previousDensity);
+    });
+
+    it('should re-nest stickers in mm through NestingService', async () => {
+      const service = new NestingService();
+      const mmSquare = (id: string, size: number): Sticker => ({
+        id,
+        points: [
+          { x: 0, y: 0 },
+          { x: size, y: 0 },
+          { x: size, y: size },
+          { x: 0, y: size },
+        ],
+        width: size,
+        height: size,
+      });
+
+      const result = await service.renestStickersPolygon(
+        [mmSquare('a', 50), mmSquare('b', 50)],
+        [{ id: 'a', x: 0, y: 0, rotation: 0 }, { id: 'gone', x: 60, y: 0, rotation: 0 }],
+        { added: ['b'], removed: ['gone'] },
+        215.9,
+        279.4,
+        1.5875,
+        50,
+        0.1
+      );
+
+      expect(result.kept).toEqual(['a']);
+      expect(result.repacked).toEqual(['b']);
+      expect(result.placements.find(p => p.id === 'a')).toMatchObject({ x: 0, y: 0 });
+      expect(result.unplaced).toEqual([]);
+    });
+  });
+
+  describe('Remnant sheets', () => {
+    const squarePoints = (size: number): Point[] => [
+      { x: 0, y: 0 },
+      { x: size, y: 0 },
+      { x: size, y: size },
+      { x: 0, y: size },
+    ];
+
+    it('should block the cells under used mask pixels', () => {
+      const grid = new RasterGrid(4, 4, 10);
+      // 2×2 mask: only the top-left quarter is used
+      grid.markMask({ width: 2, height: 2, data: Buffer.from([1, 0, 0, 0]).toString('base64') });
+
+      expect(grid.checkCollision([{ x: 5, y: 5 }])).toBe(true);
+      expect(grid.checkCollision([{ x: 25, y: 5 }])).toBe(false);
+      expect(grid.getUtilization()).toBeCloseTo(25);
+    });
+
+    it('should pack around pre-occupied polygons', async () => {
+      const packer = new PolygonPacker(6, 6, 0.0625, 50, 0.1);
+      // Left half of the sheet is already cut
+      packer.addObstacles({ polygons: [[{ x: 0, y: 0 }, { x: 3, y: 0 }, { x: 3, y: 6 }, { x: 0, y: 6 }]] });
+
+      const result = await packer.pack([
+        { id: 'square', points: squarePoints(2), width: 2, height: 2, area: 4 },
+      ]);
+
+      expect(result.placements).toHaveLength(1);
+      expect(result.placements[0].x).toBeGreaterThanOrEqual(3);
+    });
+
+    it('should move on past a remnant with no room left', async () => {
+      const service = new NestingService();
+      const stickers: Sticker[] = [{ id: 'a', points: squarePoints(50), width: 50, height: 50 }];
+      const fullyUsed = { polygons: [[{ x: 0, y: 0 }, { x: 215.9, y: 0 }, { x: 215.9, y: 279.4 }, { x: 0, y: 279.4 }]] };
+
+      const result = await service.nestStickersMultiSheetPolygon(
+        stickers, 215.9, 279.4, 2, 1.5875, 50, 0.1, [0, 90], true, [fullyUsed]
+      );
+
+      expect(result.sheets[0].placements).toHaveLength(0);
+      expect(result.sheets[1].placements.map(p => p.id)).toEqual(['a']);
+    });
+
+    it('should predict with and train the predictor it was given', async () => {
+      const predictor = new PageCountPredictor();
+      const predict = jest.spyOn(predictor, 'predict');
+      const record = jest.spyOn(predictor, 'recordCompletedJob');
+      const service = new NestingService(predictor);
+      // One 60 mm square per 4" sheet: three sheets, so the first two train the model
+      const stickers: Sticker[] = ['a', 'b', 'c'].map(id => ({ id, points: squarePoints(60), width: 60, height: 60 }));
+
+      await service.nestStickersMultiSheetPolygon(stickers, 101.6, 101.6, 1, 1.5875, 50, 0.1, [0, 90], true);
+
+      expect(predict).toHaveBeenCalledTimes(1);
+      expect(record).toHaveBeenCalledTimes(1);
+    });
+  });
+
+  describe('Hybrid packing', () => {
+    const triangle: PackablePolygon = {
+      id: 'triangle',
+      points: [
+        { x: 0, y: 0 },
+        { x: 3, y: 0 },
+        { x: 0, y: 3 },
+      ],
+      width: 3,
+      height: 3,
+      area: 4.5,
+    };
+
+    it('should classify designs by how much of their bounding box they fill', () => {
+      expect(getRectangularity(rectanglePolygon('r', 2, 3))).toBeCloseTo(1);
+      expect(getRectangularity(triangle)).toBeCloseTo(0.5);
+    });
+
+    it('should place rectangles and irregular designs without overlap', async () => {
+      const packer = new PolygonPacker(8, 8, 0.0625, 20, 0.25);
+      const polygons = [
+        rectanglePolygon('r1', 3, 2),
+        rectanglePolygon('r2', 2, 3),
+        rectanglePolygon('r3', 2, 2),
+        triangle,
+      ];
+
+      const result = await packer.packHybrid(polygons);
+
+      expect(result.placements.map(p => p.id).sort()).toEqual(['r1', 'r2', 'r3', 'triangle']);
+      expectNoOverlap(result.placements);
+    });
+
+    it('should hand designs whose MaxRects slot is blocked to the raster search', async () => {
+      // MaxRects doesn't see obstacles: its slot at the origin lands on the used left half
+      const packer = new PolygonPacker(6, 6, 0.0625, 20, 0.25);
+      packer.addObstacles({ polygons: [[{ x: 0, y: 0 }, { x: 3, y: 0 }, { x: 3, y: 6 }, { x: 0, y: 6 }]] });
+      const notched: PackablePolygon = {
+        ...rectanglePolygon('notched', 2, 2),
+        points: [{ x: 0, y: 0 }, { x: 1.75, y: 0 }, { x: 2, y: 0.25 }, { x: 2, y: 2 }, { x: 0, y: 2 }],
+        area: 4 - 0.03125,
+      };
+      expect(getRectangularity(notched)).toBeGreaterThanOrEqual(HYBRID_MIN_RECTANGULARITY);
+      const rasterPass = jest.spyOn(packer, 'pack');
+
+      const result = await packer.packHybrid([notched]);
+
+      expect(rasterPass).toHaveBeenCalledWith([notched], false);
+      expect(result.unplacedPolygons).toHaveLength(0);
+      expect(result.placements.map(p => p.id)).toEqual(['notched']);
+      expect(result.placements[0].x).toBeGreaterThanOrEqual(3);
+    });
+
+    it('should report designs neither pass can fit', async () => {
+      const packer = new PolygonPacker(4, 4, 0.0625, 20, 0.25);
+      const result = await packer.packHybrid([rectanglePolygon('big', 3.5, 3.5), rectanglePolygon('small', 1, 1)]);
+
+      expect(result.placements.map(p => p.id)).toEqual(['big']);
+      expect(result.unplacedPolygons.map(p => p.id)).toEqual(['small']);
+    });
+  });
+
+  describe('Beam-search packing', () => {
+    it('should place every item without overlap', async () => {
+      const packer = new PolygonPacker(8, 8, 0.0625, 20, 0.25);
+      const polygons = [
+        rectanglePolygon('a', 3, 2),
+        rectanglePolygon('b', 2, 3),
+        rectanglePolygon('c', 2, 2),
+        rectanglePolygon('d', 1, 4),
+      ];
+
+      const result = await packer.packBeam(polygons, 3);
+
+      expect(result.placements.map(p => p.id).sort()).toEqual(['a', 'b', 'c', 'd']);
+      expectNoOverlap(result.placements);
+      expect(packer.getUtilization()).toBeCloseTo(result.utilization);
+    });
+
+    it('should report items no branch could fit', async () => {
+      const packer = new PolygonPacker(4, 4, 0.0625, 20, 0.25);
+      const result = await packer.packBeam([rectanglePolygon('big', 3.5, 3.5), rectanglePolygon('small', 1, 1)], 2);
+
+      expect(result.placements.map(p => p.id)).toEqual(['big']);
+      expect(result.unplacedPolygons.map(p => p.id)).toEqual(['small']);
+    });
+
+    it('should copy the grid once per distinct surviving footprint', async () => {
+      // A square rotated 90/180/270 lands on the same cells, so the three candidates collapse to one
+      const packer = new PolygonPacker(8, 8, 0, 20, 0.25, [90, 180, 270]);
+      const clone = jest.spyOn(RasterGrid.prototype, 'clone');
+      const findPlacement = jest.spyOn(packer as any, 'findPlacement');
+
+      const result = await packer.packBeam([squarePolygon('sq', 2)], 3, true);
+      const clones = clone.mock.calls.length;
+      const calls = findPlacement.mock.calls.length;
+      [clone, findPlacement].forEach(spy => spy.mockRestore());
+
+      expect(result.placements.map(p => p.id)).toEqual(['sq']);
+      expect(clones).toBe(1);
+      expect(result.performance!.totalRotationsTried).toBe(calls);
+      expect(calls).toBe(3);
+    });
+  });
+
+  describe('Hole nesting', () => {
+    it('should nest a small design inside a ring on a sheet with no other room', async () => {
+      // 4" ring with a 2.5" hole on a 4.2" sheet: the square only fits inside the ring
+      const packer = new PolygonPacker(4.2, 4.2, 0.0625, 100, 0.05, [0]);
+      const ring: PackablePolygon = {
+        ...squarePolygon('ring', 4),
+        holes: [[
+          { x: 0.75, y: 0.75 },
+          { x: 3.25, y: 0.75 },
+          { x: 3.25, y: 3.25 },
+          { x: 0.75, y: 3.25 },
+        ]],
+        area: 9.75,
+      };
+
+      const result = await packer.pack([squarePolygon('square', 1), ring]);
+
+      expect(result.unplacedPolygons).toHaveLength(0);
+      // Placements are footprint corners: the hole spans 0.8125-3.3125" from the ring's corner
+      const host = result.placements.find(p => p.id === 'ring')!;
+      const nested = result.placements.find(p => p.id === 'square')!;
+      expect(nested.x - host.x).toBeGreaterThanOrEqual(0.8125);
+      expect(nested.y - host.y).toBeGreaterThanOrEqual(0.8125);
+      expect(nested.x - host.x + 1.125).toBeLessThanOrEqual(3.3125);
+      expect(nested.y - host.y + 1.125).toBeLessThanOrEqual(3.3125);
+    });
+  });
+
+  describe('chamferTransform', () => {
+    it('should count everything outside the grid as blocked', () => {
+      const dist = chamferTransform(new Uint8Array(25), 5, 5);
+
+      expect(dist[2 * 5 + 2]).toBe(9);
+      expect(dist[0]).toBe(3);
+      expect(dist[1 * 5 + 1]).toBe(6);
+    });
+  });
+
+  describe('Height-map pruning', () => {
+    it('should find the free strip below a filled band', async () => {
+      const packer = new PolygonPacker(6, 6, 0.0625, 20, 0.25);
+      packer.addObstacles({
+        polygons: [[{ x: 0, y: 0 }, { x: 6, y: 0 }, { x: 6, y: 3.75 }, { x: 0, y: 3.75 }]],
+      });
+      const result = await packer.pack([squarePolygon('sq', 1.5)]);
+
+      expect(result.placements).toHaveLength(1);
+      expect(result.placements[0].y).toBeGreaterThanOrEqual(3.75);
+    });
+
+    it('should probe fewer positions than the unpruned search', async () => {
+      // A 2.5" × 2" pocket walled in on every side, so no edge or corner start fits
+      const packPocket = async () => {
+        const packer = new PolygonPacker(6, 6, 0, 20, 0.05, [0]);
+        packer.addObstacles({
+          polygons: [
+            [{ x: 0, y: 0 }, { x: 6, y: 0 }, { x: 6, y: 3 }, { x: 0, y: 3 }],
+            [{ x: 0, y: 5 }, { x: 6, y: 5 }, { x: 6, y: 6 }, { x: 0, y: 6 }],
+            [{ x: 0, y: 3 }, { x: 2, y: 3 }, { x: 2, y: 5 }, { x: 0, y: 5 }],
+            [{ x: 4.5, y: 3 }, { x: 6, y: 3 }, { x: 6, y: 5 }, { x: 4.5, y: 5 }],
+          ],
+        });
+        return packer.pack([squarePolygon('sq', 1.5)], true);
+      };
+      const packer = PolygonPacker.prototype as any;
+      // Clearance pruning alone already skips the band; switch it off to measure the height map
+      const clearance = jest.spyOn(packer, 'clearanceDeficit').mockReturnValue(0);
+
+      const pruned = await packPocket();
+      const heightMap = [
+        jest.spyOn(packer, 'firstCandidateRow').mockReturnValue(0),
+        jest.spyOn(packer, 'rowMayFit').mockReturnValue(true),
+        jest.spyOn(packer, 'belowSkyline').mockReturnValue(true),
+      ];
+      const unpruned = await packPocket();
+      [clearance, ...heightMap].forEach(spy => spy.mockRestore());
+
+      expect(pruned.placements).toHaveLength(1);
+      expect(unpruned.placements).toHaveLength(1);
+      expect(pruned.performance!.totalPositionsTried).toBeLessThan(unpruned.performance!.totalPositionsTried);
+    });
+  });
+
+  describe('Concurrent placement', () => {
+    it('should reject a commit whose cells another packer already took', () => {
+      const grid = RasterGrid.createShared(2, 2, 10);
+      const other = new RasterGrid(2, 2, 10, grid.getSharedState()!);
+      const cells: GridCell[] = [{ x: 3, y: 3 }, { x: 4, y: 3 }];
+
+      expect(other.tryCommit(cells)).toBe(true);
+      expect(grid.tryCommit(cells)).toBe(false);
+      expect(grid.checkCollision([{ x: 4, y: 3 }])).toBe(true);
+    });
+
+    it('should not disturb cells another packer committed while a footprint is measured', () => {
+      const grid = RasterGrid.createShared(2, 2, 10);
+      const other = new RasterGrid(2, 2, 10, grid.getSharedState()!);
+      const footprint: GridCell[] = [{ x: 3, y: 3 }, { x: 4, y: 3 }];
+
+      // The other packer commits over the candidate between its fit check and its scoring
+      expect(other.tryCommit(footprint)).toBe(true);
+      grid.measureFootprint(footprint, 2);
+
+      expect(grid.checkCollision(footprint)).toBe(true);
+      expect(other.tryCommit(footprint)).toBe(false);
+    });
+
+    it('should split items between packers on one shared grid without overlap', async () => {
+      const grid = RasterGrid.createShared(8, 8, 20);
+      const packers = [grid, new RasterGrid(8, 8, 20, grid.getSharedState()!)].map(
+        g => new PolygonPacker(8, 8, 0.0625, 20, 0.25, [0, 90], undefined, undefined, g)
+      );
+      const sorted = Array.from({ length: 12 }, (_, i) => squarePolygon(`s${i}`, 1.5));
+      const claim = claimFrom(new SharedArrayBuffer(4));
+
+      const results = await Promise.all(packers.map(packer => packer.packShared(sorted, claim)));
+
+      const placements = results.flatMap(r => r.placements);
+      expect(placements.map(p => p.id).sort()).toEqual(sorted.map(p => p.id).sort());
+      expect(results.every(r => r.placements.length > 0)).toBe(true);
+      expectNoOverlap(placements);
+    });
+  });
+
+  describe('Scored placement', () => {
+    it('should prefer candidates with more contact and less hull growth', () => {
+      const scorer = createWeightedScorer();
+      const base = { x: 0, y: 0, rotation: 0, area: 100, perimeter: 40, slivers: 0, gapCells: 5 };
+
+      expect(scorer({ ...base, contact: 20, hullGrowth: 0 })).toBeLessThan(scorer({ ...base, contact: 10, hullGrowth: 0 }));
+      expect(scorer({ ...base, contact: 10, hullGrowth: 0 })).toBeLessThan(scorer({ ...base, contact: 10, hullGrowth: 50 }));
+      expect(scorer({ ...base, contact: 10, hullGrowth: 0 })).toBeLessThan(
+        scorer({ ...base, contact: 10, hullGrowth: 0, slivers: 20 })
+      );
+    });
+
+    it('should place into a corner and pack without overlap', async () => {
+      const packer = new PolygonPacker(8, 8, 0.0625, 20, 0.25);
+      packer.setPlacementScorer(createWeightedScorer());
+
+      const result = await packer.pack([
+        squarePolygon('a', 3),
+        squarePolygon('b', 2),
+        squarePolygon('c', 2),
+        squarePolygon('d', 1),
+      ]);
+
+      expect(result.unplacedPolygons).toHaveLength(0);
+      expect(result.placements[0]).toMatchObject({ id: 'a', x: 0, y: 0 });
+      expectNoOverlap(result.placements);
+    });
+  });
+
+  describe('Multi-stock packing', () => {
+    const stocks = [
+      { id: 'letter', width: 8.5, height: 11 },
+      { id: '4x6', width: 4, height: 6 },
+    ];
+
+    it('should open the smallest stock that takes every remaining item', async () => {
+      const items = [squarePolygon('a', 2), squarePolygon('b', 2)];
+      const next = await packNextStockSheet(items, stocks, 0.0625, 20, 0.25, [0, 90]);
+
+      expect(next?.stock.id).toBe('4x6');
+      expect(next?.result.unplacedPolygons).toHaveLength(0);
+    });
+
+    it('should open the densest stock when nothing takes everything', async () => {
+      const items = Array.from({ length: 30 }, (_, i) => squarePolygon(`s${i}`, 1.9));
+      const next = await packNextStockSheet(items, stocks, 0.0625, 20, 0.25, [0]);
+
+      expect(next?.stock.id).toBe('letter');
+      expect(next?.result.unplacedPolygons.length).toBeGreaterThan(0);
+    });
+
+    it('should pack every candidate stock with the supplied strategy', async () => {
+      const items = [squarePolygon('a', 2), squarePolygon('b', 2)];
+      const run = jest.fn((packer: PolygonPacker, polygons: PackablePolygon[]) => packer.packBeam(polygons, 2));
+      const next = await packNextStockSheet(items, stocks, 0.0625, 20, 0.25, [0, 90], new ShapeCache(), run);
+
+      expect(run).toHaveBeenCalledTimes(1);
+      expect(next?.stock.id).toBe('4x6');
+      expect(next?.result.unplacedPolygons).toHaveLength(0);
+    });
+
+    it('should return null when nothing fits on any stock', async () => {
+      expect(await packNextStockSheet([squarePolygon('huge', 20)], stocks, 0.0625, 20, 0.25, [0])).toBeNull();
+    });
+
+    it('should reuse cached outlines across packers', () => {
+      const cache = new ShapeCache();
+      const points = squarePolygon('a', 2).points;
+      let builds = 0;
+      const build = () => {
+        builds++;
+        return points;
+      };
+
+      cache.get(points, 90, 0.0625, build);
+      cache.get(points, 90, 0.0625, build);
+      cache.get(points, 0, 0.0625, build);
+
+      expect(builds).toBe(2);
+    });
+
+    it('should report each sheet with its stock in mm', async () => {
+      const service = new NestingService();
+      const stickers: Sticker[] = ['a', 'b', 'c'].map(id => ({
+        id,
+        points: [
+          { x: 0, y: 0 },
+          { x: 90, y: 0 },
+          { x: 90, y: 90 },
+          { x: 0, y: 90 },
+        ],
+        width: 90,
+        height: 90,
+      }));
+
+      const result = await service.nestStickersMultiStockPolygon(
+        stickers,
+        [{ id: 'letter', width: 215.9, height: 279.4 }, { id: '4x6', width: 101.6, height: 152.4 }],
+        1.5875,
+        20,
+        0.25,
+        [0]
+      );
+
+      // A 4x6 holds only one 90mm square; letter is the smallest stock that takes all three
+      expect(result.sheets).toHaveLength(1);
+      expect(result.sheets[0].stock).toEqual({ id: 'letter', width: 215.9, height: 279.4 });
+      expect(Object.keys(result.quantities).sort()).toEqual(['a', 'b', 'c']);
+    });
+  });
+
   describe('Performance and Edge Cases', () => {
     it('should handle empty polygon list', async () => {
       const packer = new PolygonPacker(12, 12, 0.0625);
@@ -419,4 +1095,89 @@ describe('PolygonPacking', () => {
       expect(result.placements).toHaveLength(1);
     });
   });
+
+  describe('toPackablePolygon', () => {
+    it('should use exact polygon area instead of bounding-box area', () => {
+      // Right triangle 50.8mm x 50.8mm (2" x 2"): bbox area 4 sq in, exact area 2 sq in
+      const polygon = toPackablePolygon({
+        id: 'triangle',
+        points: [
+          { x: 0, y: 0 },
+          { x: 50.8, y: 0 },
+          { x: 0, y: 50.8 },
+        ],
+        width: 50.8,
+        height: 50.8,
+      });
+
+      expect(polygon.width).toBeCloseTo(2, 5);
+      expect(polygon.area).toBeCloseTo(2, 5);
+      expect(polygon.solidity).toBeCloseTo(1, 5);
+    });
+
+    it('should reuse trace-time descriptors converted from mm to inches', () => {
+      const polygon = toPackablePolygon({
+        id: 'precomputed',
+        points: [
+          { x: 0, y: 0 },
+          { x: 25.4, y: 0 },
+          { x: 25.4, y: 25.4 },
+          { x: 0, y: 25.4 },
+        ],
+        width: 25.4,
+        height: 25.4,
+        descriptors: { area: 322.58, hullArea: 645.16, perimeter: 101.6, solidity: 0.5 },
+      });
+
+      expect(polygon.area).toBeCloseTo(0.5, 5);
+      expect(polygon.hullArea).toBeCloseTo(1, 5);
+      expect(polygon.perimeter).toBeCloseTo(4, 5);
+      expect(polygon.solidity).toBe(0.5);
+    });
+
+    it('should subtract hole area from the design area', () => {
+      // 2" square with a 1" square hole, in mm
+      const polygon = toPackablePolygon({
+        id: 'frame',
+        points: [
+          { x: 0, y: 0 },
+          { x: 50.8, y: 0 },
+          { x: 50.8, y: 50.8 },
+          { x: 0, y: 50.8 },
+        ],
+        holes: [[
+          { x: 12.7, y: 12.7 },
+          { x: 38.1, y: 12.7 },
+          { x: 38.1, y: 38.1 },
+          { x: 12.7, y: 38.1 },
+        ]],
+        width: 50.8,
+        height: 50.8,
+      });
+
+      expect(polygon.area).toBeCloseTo(3, 5);
+      expect(polygon.holes).toHaveLength(1);
+      expect(polygon.holes![0][1].x).toBeCloseTo(1.5, 5);
+    });
+
+    it('should estimate fewer pages for concave designs than bounding-box area implies', () => {
+      // L-shape with 7 sq in exact area inside a 4" x 4" (16 sq in) bounding box
+      const lShapeMM = [
+        { x: 0, y: 0 },
+        { x: 4, y: 0 },
+        { x: 4, y: 1 },
+        { x: 1, y: 1 },
+        { x: 1, y: 4 },
+        { x: 0, y: 4 },
+      ].map(p => ({ x: p.x * 25.4, y: p.y * 25.4 }));
+
+      const polygons = Array.from({ length: 10 }, (_, i) =>
+        toPackablePolygon({ id: `l_${i}`, points: lShapeMM, width: 101.6, height: 101.6 })
+      );
+
+      const estimate = estimateSpaceRequirements(polygons, 8.5, 11, 1);
+
+      expect(estimate.totalItemArea).toBeCloseTo(70, 3);
+    });
+  });
 });
@@ -0,0 +1,115 @@
+import {
+  SheetTemplateCache,
+  SheetTemplateContext,
+  designHashOf,
+  multisetFingerprint
+} from '../services/sheet-template-cache.service';
+import { SheetPlacement } from '../services/nesting.service';
+import { PackableSticker } from '../services/polygon-packing.service';
+
+const context: SheetTemplateContext = {
+  sheetWidth: 215.9,
+  sheetHeight: 279.4,
+  spacing: 1.5875,
+  cellsPerInch: 100,
+  stepSize: 0.05,
+  rotations: [0, 90, 180, 270],
+};
+
+function square(id: string, size: number): PackableSticker {
+  return {
+    id,
+    points: [
+      { x: 0, y: 0 },
+      { x: size, y: 0 },
+      { x: size, y: size },
+      { x: 0, y: size },
+    ],
+    width: size,
+    height: size,
+  };
+}
+
+// Sheet 0: two cats and a dog; sheet 1 (last, leftovers): one cat
+const firstJob = [square('cat_0', 10), square('cat_1', 10), square('cat_2', 10), square('dog_0', 20)];
+const firstSheets: SheetPlacement[] = [
+  {
+    sheetIndex: 0,
+    placements: [
+      { id: 'cat_0', x: 0, y: 0, rotation: 0 },
+      { id: 'cat_1', x: 12, y: 0, rotation: 0 },
+      { id: 'dog_0', x: 0, y: 12, rotation: 90 },
+    ],
+    utilization: 80,
+  },
+  { sheetIndex: 1, placements: [{ id: 'cat_2', x: 0, y: 0, rotation: 0 }], utilization: 5 },
+];
+
+describe('SheetTemplateCache', () => {
+  it('should reuse cached full sheets contained in a new order and leave the residual', () => {
+    const cache = new SheetTemplateCache();
+    cache.record(context, firstJob, firstSheets);
+
+    // Repeat order under new names, two full mixes plus a new design
+    const order = [
+      square('kitty_0', 10), square('kitty_1', 10), square('kitty_2', 10), square('kitty_3', 10),
+      square('hound_0', 20), square('hound_1', 20),
+      square('fox_0', 15),
+    ];
+    const reuse = cache.reuse(context, order);
+
+    expect(reuse.sheets.map(s => s.sheetIndex)).toEqual([0, 1]);
+    expect(reuse.sheets[0].placements).toEqual([
+      { id: 'kitty_0', x: 0, y: 0, rotation: 0 },
+      { id: 'kitty_1', x: 12, y: 0, rotation: 0 },
+      { id: 'hound_0', x: 0, y: 12, rotation: 90 },
+    ]);
+    expect(reuse.sheets[1].utilization).toBe(80);
+    expect(reuse.remainingIds).toEqual(['fox_0']);
+  });
+
+  it('should not cache the last sheet of a job', () => {
+    const cache = new SheetTemplateCache();
+    cache.record(context, firstJob, firstSheets);
+
+    expect(cache.size).toBe(1);
+    expect(cache.reuse(context, [square('cat_9', 10)]).sheets).toHaveLength(0);
+  });
+
+  it('should only reuse sheets packed with the same settings', () => {
+    const cache = new SheetTemplateCache();
+    cache.record(context, firstJob, firstSheets);
+
+    const reuse = cache.reuse({ ...context, spacing: 3 }, firstJob);
+
+    expect(reuse.sheets).toHaveLength(0);
+    expect(reuse.remainingIds).toEqual(firstJob.map(s => s.id));
+  });
+
+  it('should evict the least recently used sheet', () => {
+    const cache = new SheetTemplateCache(1);
+    cache.record(context, firstJob, firstSheets);
+    const other = [square('owl_0', 30), square('owl_1', 30)];
+    cache.record(context, other, [
+      { sheetIndex: 0, placements: [{ id: 'owl_0', x: 0, y: 0, rotation: 0 }], utilization: 40 },
+      { sheetIndex: 1, placements: [{ id: 'owl_1', x: 0, y: 0, rotation: 0 }], utilization: 40 },
+    ]);
+
+    expect(cache.size).toBe(1);
+    expect(cache.reuse(context, firstJob).sheets).toHaveLength(0);
+    expect(cache.reuse(context, other).sheets).toHaveLength(2);
+  });
+
+  it('should fingerprint a multiset independently of order', () => {
+    const a = new Map([['x', 2], ['y', 1]]);
+    const b = new Map([['y', 1], ['x', 2]]);
+
+    expect(multisetFingerprint(context, a)).toBe(multisetFingerprint(context, b));
+    expect(multisetFingerprint(context, a)).not.toBe(multisetFingerprint({ ...context, rotations: [0] }, a));
+  });
+
+  it('should hash designs by outline, not by name', () => {
+    expect(designHashOf(square('a', 10))).toBe(designHashOf(square('b', 10)));
+    expect(designHashOf(square('a', 10))).not.toBe(designHashOf(square('a', 11)));
+  });
+});
@@ -0,0 +1,109 @@
+import { SvgService, parsePathData, flatten } from '../services/svg.service';
+
+describe('SvgService', () => {
+  let service: SvgService;
+
+  beforeEach(() => {
+    service = new SvgService();
+  });
+
+  const svg = (body: string) => Buffer.from(`<?xml version="1.0"?>\n<svg xmlns="http://www.w3.org/2000/svg" viewBox="0 0 100 100">${body}</svg>`);
+
+  describe('isSvg', () => {
+    it('should recognise SVG markup and reject raster data', () => {
+      expect(service.isSvg(svg('<rect width="10" height="10"/>'))).toBe(true);
+      expect(service.isSvg(Buffer.from([0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a]))).toBe(false);
+    });
+  });
+
+  describe('parse', () => {
+    it('should take the outline from the filled geometry, including group transforms', () => {
+      const artwork = service.parse(svg('<g transform="translate(10,20) scale(2)"><rect width="30" height="10" fill="red"/></g>'))!;
+
+      expect(artwork.shapes).toHaveLength(1);
+      expect(artwork.bounds.minX).toBeCloseTo(10, 2);
+      expect(artwork.bounds.minY).toBeCloseTo(20, 2);
+      expect(artwork.bounds.width).toBeCloseTo(60, 2);
+      expect(artwork.bounds.height).toBeCloseTo(20, 2);
+    });
+
+    it('should report an even-odd cut-out as a hole of the outline', () => {
+      const artwork = service.parse(svg('<path fill-rule="evenodd" d="M0 0H80V80H0Z M20 20H60V60H20Z"/>'))!;
+      const { path, holes } = service.traceOutline(artwork, 0.1);
+
+      expect(path).toHaveLength(4);
+      expect(holes).toHaveLength(1);
+    });
+
+    it('should widen the outline by half the stroke width', () => {
+      const artwork = service.parse(svg('<line x1="0" y1="50" x2="100" y2="50" stroke="black" stroke-width="10"/>'))!;
+
+      // Butt caps (the default) end flush with the line
+      expect(artwork.bounds.height).toBeCloseTo(10, 1);
+      expect(artwork.bounds.width).toBeCloseTo(100, 1);
+    });
+
+    it('should extend round and square caps past the line ends', () => {
+      const line = (cap: string) =>
+        service.parse(svg(`<line x1="0" y1="50" x2="100" y2="50" stroke="black" stroke-width="10" stroke-linecap="${cap}"/>`))!;
+
+      expect(line('round').bounds.width).toBeCloseTo(110, 1);
+      expect(line('square').bounds.width).toBeCloseTo(110, 1);
+    });
+
+    it('should follow the stroke line join at corners', () => {
+      // Right-angled corner at (50, 50): a miter reaches 5·√2 past it, a round join 5
+      const corner = (join: string) =>
+        service.parse(svg(`<path d="M0 0L50 50L0 100" fill="none" stroke="black" stroke-width="10" style="stroke-linejoin:${join}"/>`))!;
+
+      expect(corner('miter').bounds.maxX).toBeCloseTo(50 + 5 * Math.SQRT2, 1);
+      expect(corner('round').bounds.maxX).toBeCloseTo(55, 1);
+      expect(corner('bevel').bounds.maxX).toBeLessThan(corner('miter').bounds.maxX);
+    });
+
+    it('should read fills from class rules in a style block', () => {
+      const artwork = service.parse(svg('<style>.cls-1{fill:#ff0000;}</style><circle class="cls-1" cx="50" cy="50" r="10"/>'))!;
+
+      expect(artwork.shapes[0].fill).toBe('#ff0000');
+    });
+
+    it('should leave artwork it cannot reproduce to the raster fallback', () => {
+      expect(service.parse(svg('<text x="0" y="10">Hi</text>'))).toBeNull();
+      expect(service.parse(svg('<rect width="10" height="10" fill="url(#grad)"/>'))).toBeNull();
+      expect(service.parse(svg('<rect width="10" height="10" fill="none"/>'))).toBeNull();
+    });
+  });
+
+  describe('traceOutline', () => {
+    it('should flatten curves to within the tolerance', () => {
+      const artwork = service.parse(svg('<circle cx="50" cy="50" r="40"/>'))!;
+
+      const coarse = service.traceOutline(artwork, 1).path;
+      const fine = service.traceOutline(artwork, 0.01).path;
+
+      expect(fine.length).toBeGreaterThan(coarse.length);
+      // Chord midpoints of the fine polyline stay within tolerance of the circle
+      for (let i = 0; i < fine.length; i++) {
+        const a = fine[i];
+        const b = fine[(i + 1) % fine.length];
+        const r = Math.hypot((a.x + b.x) / 2 - 50, (a.y + b.y) / 2 - 50);
+        expect(40 - r).toBeLessThan(0.02);
+      }
+    });
+  });
+
+  describe('parsePathData', () => {
+    it('should handle relative commands, shorthand curves, arcs and packed arc flags', () => {
+      const subpaths = parsePathData('M0,0 h10 v10 h-10 z m20 0 c0,5 5,10 10,10 s10-5 10-10 a5 5 0 1 1-10 0z M0 0a1 1 0 00 1 1');
+
+      expect(subpaths).toHaveLength(3);
+      expect(subpaths[0].segments.map(s => s.type).join('')).toBe('LLL');
+      expect(subpaths[1].start).toEqual({ x: 20, y: 0 });
+      expect(subpaths[1].closed).toBe(true);
+      expect(subpaths[2].segments.length).toBeGreaterThan(0);
+      const end = flatten(subpaths[2], 0.01).pop()!;
+      expect(end.x).toBeCloseTo(1, 5);
+      expect(end.y).toBeCloseTo(1, 5);
+    });
+  });
+});
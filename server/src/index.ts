@@ -4,117 +4,244 @@ import multer from 'multer';
 import path from 'path';
 import { createServer } from 'http';
 import { Server as SocketIOServer } from 'socket.io';
-import { nestingRouter } from './routes/nesting.routes';
+import { nestingRouter, resumeCheckpointedJobs, jobRoom, createGangRunDispatcher } from './routes/nesting.routes';
 import { pdfRouter } from './routes/pdf.routes';
 import { WorkerManagerService } from './services/worker-manager.service';
+import { JobSchedulerService } from './services/job-scheduler.service';
+import { PageCountPredictor, ClusterPageCountPredictor, PackingSample } from './services/page-count-predictor.service';
+import { MemoryJobStore, ClusterJobStore } from './services/job-store.service';
+import { startClusterPrimary, attachStickyConnections, ProgressFanout } from './services/cluster.service';
+import { JobCheckpointService } from './services/job-checkpoint.service';
+import { JobEventsService } from './services/job-events.service';
+import { GangRunService } from './services/gang-run.service';
+import { SheetTemplateCache } from './services/sheet-template-cache.service';
+import { NestingService } from './services/nesting.service';
+import cluster from 'cluster';
+import os from 'os';
+import fs from 'fs';
 
 const app: Express = express();
 const httpServer = createServer(app);
 const PORT = process.env.PORT || 3001;
 
-// Initialize Socket.IO
-const io = new SocketIOServer(httpServer, {
-  cors: {
-    origin: process.env.NODE_ENV === 'production'
-      ? false // In production, use same origin
-      : ['http://localhost:4200', 'http://localhost:8084'], // Allow dev servers
-    methods: ['GET', 'POST']
-  },
-  pingTimeout: 60000, // 60 seconds
-  pingInterval: 25000  // 25 seconds
-});
-
-// Initialize Worker Manager
-const workerManager = new WorkerManagerService();
-
-// Make io and workerManager available to routes via app.locals
-app.locals.io = io;
-app.locals.workerManager = workerManager;
-
-// Middleware
-app.use(cors());
-app.use(express.json({ limit: '50mb' }));
-app.use(express.urlencoded({ extended: true, limit: '50mb' }));
-
-// Routes
-app.use('/api/nesting', nestingRouter);
-app.use('/api/pdf', pdfRouter);
-
-// Health check
-app.get('/api/health', (req: Request, res: Response) => {
-  res.json({ status: 'ok', message: 'Mosaic API is running' });
-});
-
-// Serve static files from Angular frontend (production mode)
-const publicPath = path.join(__dirname, '../public');
-app.use(express.static(publicPath));
-
-// All non-API routes should serve the Angular app
-app.get('*', (req: Request, res: Response) => {
-  if (!req.path.startsWith('/api')) {
-    res.sendFile(path.join(publicPath, 'index.html'));
-  }
-});
-
-// Error handling middleware
-app.use((err: any, req: Request, res: Response, next: any) => {
-  console.error('Error occurred:', err);
-
-  // Handle Multer errors specifically
-  if (err instanceof multer.MulterError) {
-    console.error('Multer Error Details:');
-    console.error('- Error code:', err.code);
-    console.error('- Field name:', err.field);
-    console.error('- Request path:', req.path);
-    console.error('- Request method:', req.method);
-    console.error('- Content-Type:', req.headers['content-type']);
-
-    return res.status(400).json({
-      error: 'File upload error',
-      message: err.message,
-      code: err.code,
-      field: err.field
-    });
+// Cluster mode: CLUSTER_WORKERS > 1 runs that many server processes behind a
+// primary that routes sticky connections and hosts the shared job registry
+const CLUSTER_WORKERS = parseInt(process.env.CLUSTER_WORKERS || '0', 10);
+const clusterMode = CLUSTER_WORKERS > 1;
+const isClusterPrimary = clusterMode && cluster.isPrimary;
+
+// Initialize page-count predictor
+// PAGE_PREDICTOR_MODEL: file-backed model state (updated online after each job)
+// PAGE_PREDICTOR_CORPUS: benchmark samples used to train offline when no model exists yet
+// In cluster mode only the primary loads, trains and saves the model; workers keep a
+// replica and forward their completed jobs to it
+function createPageCountPredictor(): PageCountPredictor {
+  const predictorModelPath = process.env.PAGE_PREDICTOR_MODEL;
+  const predictorCorpusPath = process.env.PAGE_PREDICTOR_CORPUS;
+  const predictor = predictorModelPath
+    ? PageCountPredictor.loadFromFile(predictorModelPath)
+    : new PageCountPredictor();
+  if (predictorCorpusPath && !(predictorModelPath && fs.existsSync(predictorModelPath))) {
+    try {
+      const corpus = JSON.parse(fs.readFileSync(predictorCorpusPath, 'utf-8')) as PackingSample[];
+      predictor.trainOffline(corpus);
+      if (predictorModelPath) {
+        predictor.saveToFile(predictorModelPath);
+      }
+    } catch (error) {
+      console.warn(`Failed to train page-count predictor from ${predictorCorpusPath}:`, error);
+    }
   }
+  return predictor;
+}
+
+/**
+ * API process: HTTP routes, Socket.IO, packing threads and the job services behind them
+ * (the whole server outside cluster mode, each forked worker inside it)
+ */
+function startApiServer(): void {
+  // Initialize Socket.IO
+  const io = new SocketIOServer(httpServer, {
+    cors: {
+      origin: process.env.NODE_ENV === 'production'
+        ? false // In production, use same origin
+        : ['http://localhost:4200', 'http://localhost:8084'], // Allow dev servers
+      methods: ['GET', 'POST']
+    },
+    pingTimeout: 60000, // 60 seconds
+    pingInterval: 25000  // 25 seconds
+  });
+
+  // Initialize Worker Manager and the scheduler in front of it
+  // In cluster mode each process gets its share of the CPUs for packing threads
+  const workerManager = new WorkerManagerService();
+  const jobScheduler = new JobSchedulerService(workerManager, {
+    maxConcurrent: process.env.MAX_CONCURRENT_JOBS
+      ? parseInt(process.env.MAX_CONCURRENT_JOBS, 10)
+      : clusterMode
+        ? Math.max(1, Math.floor((os.cpus().length - 1) / CLUSTER_WORKERS))
+        : undefined,
+    queueBudgetSeconds: process.env.QUEUE_BUDGET_SECONDS ? parseFloat(process.env.QUEUE_BUDGET_SECONDS) : undefined,
+  });
+
+  // Page-count predictor (in cluster mode a replica of the primary's model)
+  const pageCountPredictor = clusterMode ? new ClusterPageCountPredictor() : createPageCountPredictor();
+
+  // Job registry and progress fan-out (shared across processes in cluster mode)
+  const jobStore = clusterMode ? new ClusterJobStore() : new MemoryJobStore();
+  const progressFanout = new ProgressFanout(io, clusterMode);
+  const jobEvents = new JobEventsService(); // Per-process feed for HTTP streaming endpoints
+
+  // Crash-safe checkpoints for multi-sheet jobs (JOB_CHECKPOINT_DIR=off disables)
+  const checkpointDir = process.env.JOB_CHECKPOINT_DIR || path.join(os.tmpdir(), 'mosaic-jobs');
+  const jobCheckpoints = checkpointDir !== 'off' ? new JobCheckpointService(checkpointDir) : undefined;
+
+  // Full sheets from finished jobs, reused by later jobs with the same design mix
+  // (SHEET_TEMPLATE_CACHE_SIZE=0 disables)
+  const sheetTemplateCacheSize = parseInt(process.env.SHEET_TEMPLATE_CACHE_SIZE || '500', 10);
+  const sheetTemplates = sheetTemplateCacheSize > 0 ? new SheetTemplateCache(sheetTemplateCacheSize) : undefined;
+
+  // Gang runs: small orders collected over GANG_RUN_WINDOW_SECONDS are packed onto shared sheets
+  const gangRuns = new GangRunService(createGangRunDispatcher(app), {
+    windowMs: process.env.GANG_RUN_WINDOW_SECONDS ? parseFloat(process.env.GANG_RUN_WINDOW_SECONDS) * 1000 : undefined,
+    maxOrderItems: process.env.GANG_RUN_MAX_ORDER_ITEMS ? parseInt(process.env.GANG_RUN_MAX_ORDER_ITEMS, 10) : undefined,
+    maxBatchItems: process.env.GANG_RUN_MAX_BATCH_ITEMS ? parseInt(process.env.GANG_RUN_MAX_BATCH_ITEMS, 10) : undefined,
+  });
+
+  // Make io, workerManager, scheduler, predictor, job registry and checkpoints available to routes via app.locals
+  app.locals.io = io;
+  app.locals.workerManager = workerManager;
+  app.locals.jobScheduler = jobScheduler;
+  app.locals.pageCountPredictor = pageCountPredictor;
+  app.locals.nestingService = new NestingService(pageCountPredictor); // Predicts and trains on the shared model
+  app.locals.jobStore = jobStore;
+  app.locals.progressFanout = progressFanout;
+  app.locals.jobEvents = jobEvents;
+  app.locals.jobCheckpoints = jobCheckpoints;
+  app.locals.gangRuns = gangRuns;
+  app.locals.sheetTemplates = sheetTemplates;
+
+  // Middleware
+  app.use(cors());
+  app.use(express.json({ limit: '50mb' }));
+  app.use(express.urlencoded({ extended: true, limit: '50mb' }));
+
+  // Routes
+  app.use('/api/nesting', nestingRouter);
+  app.use('/api/pdf', pdfRouter);
+
+  // Health check
+  app.get('/api/health', (req: Request, res: Response) => {
+    res.json({ status: 'ok', message: 'Mosaic API is running' });
+  });
 
-  console.error(err.stack);
-  res.status(500).json({
-    error: 'Internal Server Error',
-    message: err.message
+  // Serve static files from Angular frontend (production mode)
+  const publicPath = path.join(__dirname, '../public');
+  app.use(express.static(publicPath));
+
+  // All non-API routes should serve the Angular app
+  app.get('*', (req: Request, res: Response) => {
+    if (!req.path.startsWith('/api')) {
+      res.sendFile(path.join(publicPath, 'index.html'));
+    }
+  });
+
+  // Error handling middleware
+  app.use((err: any, req: Request, res: Response, next: any) => {
+    console.error('Error occurred:', err);
+
+    // Handle Multer errors specifically
+    if (err instanceof multer.MulterError) {
+      console.error('Multer Error Details:');
+      console.error('- Error code:', err.code);
+      console.error('- Field name:', err.field);
+      console.error('- Request path:', req.path);
+      console.error('- Request method:', req.method);
+      console.error('- Content-Type:', req.headers['content-type']);
+
+      return res.status(400).json({
+        error: 'File upload error',
+        message: err.message,
+        code: err.code,
+        field: err.field
+      });
+    }
+
+    console.error(err.stack);
+    res.status(500).json({
+      error: 'Internal Server Error',
+      message: err.message
+    });
   });
-});
 
-// Socket.IO connection handling
-io.on('connection', (socket) => {
-  console.log(`🔌 Client connected: ${socket.id}`);
+  // Socket.IO connection handling
+  io.on('connection', (socket) => {
+    console.log(`🔌 Client connected: ${socket.id}`);
+
+    // Reattach to a job's events (e.g. after reconnecting, or after a server restart)
+    socket.on('nesting:attach', async ({ jobId }: { jobId: string }) => {
+      if (!jobId) return;
+      socket.join(jobRoom(jobId));
+
+      // Replay the job's current state so a late subscriber doesn't miss the outcome
+      const record = await jobStore.get(jobId);
+      if (record?.status === 'complete') {
+        socket.emit('nesting:complete', { jobId, result: record.result });
+      } else if (record?.status === 'error') {
+        socket.emit('nesting:error', { jobId, error: record.error });
+      } else if (record) {
+        socket.emit('nesting:progress', { jobId, type: 'progress', message: record.message || 'Resuming...', percentComplete: record.percentComplete });
+      }
+    });
+
+    socket.on('disconnect', (reason) => {
+      console.log(`❌ Client disconnected: ${socket.id} (${reason})`);
+    });
 
-  socket.on('disconnect', (reason) => {
-    console.log(`❌ Client disconnected: ${socket.id} (${reason})`);
+    socket.on('error', (error) => {
+      console.error(`⚠️  Socket error for ${socket.id}:`, error);
+    });
+  });
+
+  // Graceful shutdown: terminate all workers
+  process.on('SIGTERM', () => {
+    console.log('SIGTERM received, cleaning up workers...');
+    gangRuns.flush(); // Open batches become checkpointed jobs, resumed after the restart
+    jobScheduler.clearQueue();
+    workerManager.terminateAll();
+    process.exit(0);
   });
 
-  socket.on('error', (error) => {
-    console.error(`⚠️  Socket error for ${socket.id}:`, error);
+  process.on('SIGINT', () => {
+    console.log('SIGINT received, cleaning up workers...');
+    gangRuns.flush(); // Open batches become checkpointed jobs, resumed after the restart
+    jobScheduler.clearQueue();
+    workerManager.terminateAll();
+    process.exit(0);
   });
-});
-
-// Graceful shutdown: terminate all workers
-process.on('SIGTERM', () => {
-  console.log('SIGTERM received, cleaning up workers...');
-  workerManager.terminateAll();
-  process.exit(0);
-});
-
-process.on('SIGINT', () => {
-  console.log('SIGINT received, cleaning up workers...');
-  workerManager.terminateAll();
-  process.exit(0);
-});
-
-// Start server
-httpServer.listen(PORT, () => {
-  console.log(`⚡️ Server is running on port ${PORT}`);
-  console.log(`🎨 Mosaic API ready at http://localhost:${PORT}/api`);
-  console.log(`🔌 Socket.IO ready for real-time communication`);
-});
+
+  // Pick up jobs interrupted by a restart (at most one sheet of work is redone)
+  resumeCheckpointedJobs(app);
+
+  if (clusterMode) {
+    // Connections arrive from the primary, already routed to this process
+    attachStickyConnections(httpServer);
+    console.log(`⚡️ Cluster worker ${process.pid} ready`);
+  } else {
+    // Start server
+    httpServer.listen(PORT, () => {
+      console.log(`⚡️ Server is running on port ${PORT}`);
+      console.log(`🎨 Mosaic API ready at http://localhost:${PORT}/api`);
+      console.log(`🔌 Socket.IO ready for real-time communication`);
+    });
+  }
+}
+
+if (isClusterPrimary) {
+  // Primary only routes connections and owns the predictor model; the API runs in the forked workers
+  startClusterPrimary(PORT, CLUSTER_WORKERS, createPageCountPredictor());
+} else {
+  startApiServer();
+}
 
 export default app;
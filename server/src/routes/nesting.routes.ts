@@ -1,20 +1,458 @@
-import { Router, Request, Response } from 'express';
+import { Router, Request, Response, Express } from 'express';
+import os from 'os';
 import { upload } from '../config/multer';
-import { ImageService } from '../services/image.service';
-import { GeometryService } from '../services/geometry.service';
-import { NestingService } from '../services/nesting.service';
-import { WorkerManagerService } from '../services/worker-manager.service';
+import { ImageService, Point } from '../services/image.service';
+import { SvgService } from '../services/svg.service';
+import { GeometryService, ShapeDescriptors } from '../services/geometry.service';
+import { NestingService, SheetPlacement, MultiSheetResult } from '../services/nesting.service';
+import { JobSchedulerService } from '../services/job-scheduler.service';
+import { RotationConfigService } from '../services/rotation-config.service';
+import { PageCountPredictor } from '../services/page-count-predictor.service';
+import { JobStore, JobRecord, ClusterJobStore } from '../services/job-store.service';
+import { JobEventsService, JobStreamEvent, summarizeResult } from '../services/job-events.service';
+import { ProgressFanout } from '../services/cluster.service';
+import { JobCheckpointService } from '../services/job-checkpoint.service';
+import { WorkerJobOptions } from '../services/worker-manager.service';
+import { GangRunDispatcher, GangRunService } from '../services/gang-run.service';
+import { SheetTemplateCache } from '../services/sheet-template-cache.service';
+import { PackingWorkerData } from '../workers/packing.worker';
+import { SheetObstacles, SheetStock } from '../services/polygon-packing.service';
 import { Server as SocketIOServer } from 'socket.io';
 import { v4 as uuidv4 } from 'uuid';
 
 const router = Router();
 const imageService = new ImageService();
+const svgService = new SvgService();
 const geometryService = new GeometryService();
-const nestingService = new NestingService();
+
+// Minimum density of an incremental layout relative to the one it replaces
+const DEFAULT_INCREMENTAL_QUALITY = parseFloat(process.env.INCREMENTAL_QUALITY_THRESHOLD || '0.9');
+
+// Beam search cost grows linearly with width; wider beams rarely pay for themselves
+const MAX_BEAM_WIDTH = 8;
+
+// How often an NDJSON stream polls the shared registry for a job running in another cluster process
+const NDJSON_POLL_INTERVAL_MS = 500;
+
+/**
+ * Resolve polygon packing parameters from a rotation preset key, falling back to
+ * explicitly provided values, then to the 90° defaults
+ */
+export function resolvePackingSettings(
+  rotationPreset?: string,
+  rotations?: number[],
+  cellsPerInch?: number,
+  stepSize?: number
+): { rotations: number[]; cellsPerInch: number; stepSize: number } {
+  const preset = rotationPreset ? RotationConfigService.getPresetByKey(rotationPreset) : undefined;
+  if (preset) {
+    return { rotations: preset.rotations, cellsPerInch: preset.cellsPerInch, stepSize: preset.stepSize };
+  }
+  return {
+    rotations: rotations || [0, 90, 180, 270],
+    cellsPerInch: cellsPerInch || 100,
+    stepSize: stepSize || 0.05
+  };
+}
+
+/**
+ * Normalize remnant sheets from a request, by sheet index (null = fresh stock)
+ * Polygons pass through in mm; mask images (base64 or data URL) are decoded to bitmaps
+ */
+export async function resolveRemnants(remnants: any): Promise<Array<SheetObstacles | null> | undefined> {
+  if (!Array.isArray(remnants) || remnants.length === 0) return undefined;
+  return Promise.all(remnants.map(async (remnant: any): Promise<SheetObstacles | null> => {
+    if (!remnant || (!remnant.polygons && !remnant.mask)) return null;
+    const mask = typeof remnant.mask === 'string'
+      ? await imageService.decodeOccupancyMask(Buffer.from(remnant.mask.replace(/^data:[^,]*,/, ''), 'base64'))
+      : remnant.mask;
+    return { polygons: remnant.polygons, mask };
+  }));
+}
+
+/**
+ * Socket.IO room that receives a job's events
+ */
+export function jobRoom(jobId: string): string {
+  return `job:${jobId}`;
+}
+
+/**
+ * Whether a job's sheets can be shared with other jobs through the sheet-template cache
+ * (single stock size, fresh sheets, every item packed)
+ */
+function usesSheetTemplates(data: PackingWorkerData): boolean {
+  return data.type === 'multi-sheet' && !data.stocks && !data.remnants && data.packAllItems !== false;
+}
+
+/**
+ * Start a multi-sheet job from cached sheets whose design mix the job contains
+ * The cached sheets go in as an already-packed prefix (like a checkpoint), so the worker
+ * only packs the residual items
+ */
+export function applySheetTemplates(app: Express, data: PackingWorkerData): PackingWorkerData {
+  const sheetTemplates: SheetTemplateCache | undefined = app.locals.sheetTemplates;
+  if (!sheetTemplates || !usesSheetTemplates(data) || data.resumeFrom) return data;
+
+  const reuse = sheetTemplates.reuse(data, data.stickers);
+  if (reuse.sheets.length === 0) return data;
+
+  console.log(`[Nesting] Reusing ${reuse.sheets.length} cached sheets, ${reuse.remainingIds.length} items left to pack`);
+  return {
+    ...data,
+    resumeFrom: {
+      sheets: reuse.sheets,
+      remainingIds: reuse.remainingIds,
+      pageCount: Math.max(data.pageCount ?? 1, reuse.sheets.length),
+      attempts: 0,
+      savedAt: Date.now()
+    }
+  };
+}
+
+/**
+ * Build the worker callbacks for a polygon packing job
+ * Updates the job registry and checkpoints, and emits progress to the job's room;
+ * with the job's input, also feeds its full sheets to the sheet-template cache
+ */
+export function createPackingJobOptions(app: Express, jobId: string, data?: PackingWorkerData): WorkerJobOptions {
+  const progressFanout: ProgressFanout = app.locals.progressFanout;
+  const jobStore: JobStore = app.locals.jobStore;
+  const pageCountPredictor: PageCountPredictor | undefined = app.locals.pageCountPredictor;
+  const checkpoints: JobCheckpointService | undefined = app.locals.jobCheckpoints;
+  const jobEvents: JobEventsService | undefined = app.locals.jobEvents;
+  const sheetTemplates: SheetTemplateCache | undefined = app.locals.sheetTemplates;
+  const room = jobRoom(jobId);
+  const sheets: SheetPlacement[] = [];
+
+  return {
+    onProgress: (progress) => {
+      jobStore.update(jobId, {
+        status: 'running',
+        message: progress.message,
+        percentComplete: progress.percentComplete
+      });
+      // Send progress updates via Socket.IO (relayed if the socket lives in another process)
+      progressFanout.emitTo(room, 'nesting:progress', {
+        jobId,
+        ...progress
+      });
+    },
+    onSheet: (sheet) => {
+      // Finalized sheet: stream it out before the rest of the job finishes
+      if (!sheets.some(s => s.sheetIndex === sheet.sheetIndex)) {
+        sheets.push(sheet);
+      }
+      jobStore.update(jobId, { sheets });
+      jobEvents?.publish(jobId, { type: 'sheet', sheet });
+      progressFanout.emitTo(room, 'nesting:sheet', {
+        jobId,
+        sheet
+      });
+    },
+    onCheckpoint: (checkpoint) => {
+      checkpoints?.saveCheckpoint(jobId, checkpoint);
+    },
+    onComplete: (result) => {
+      jobStore.update(jobId, { status: 'complete', percentComplete: 100, result });
+      if (data && sheetTemplates && usesSheetTemplates(data) && Array.isArray(result?.sheets)) {
+        sheetTemplates.record(data, data.stickers, result.sheets);
+      }
+      checkpoints?.completeJob(jobId);
+      jobEvents?.publish(jobId, { type: 'complete', summary: summarizeResult(result) });
+      // Send completion event via Socket.IO
+      progressFanout.emitTo(room, 'nesting:complete', {
+        jobId,
+        result
+      });
+    },
+    onCalibration: (sample) => {
+      // Online training: refine page-count predictions from completed jobs
+      pageCountPredictor?.recordCompletedJob(sample);
+    },
+    onError: (error) => {
+      jobStore.update(jobId, { status: 'error', error });
+      checkpoints?.completeJob(jobId);
+      jobEvents?.publish(jobId, { type: 'error', error });
+      // Send error event via Socket.IO
+      progressFanout.emitTo(room, 'nesting:error', {
+        jobId,
+        error
+      });
+    }
+  };
+}
+
+/**
+ * Pack closed gang-run batches through the scheduler like any other multi-sheet job
+ * Clients can follow a batch's job by ID; the gang-run service splits the result per order.
+ * Batch jobs are checkpointed with the batch's snapshot, so a batch flushed on shutdown is
+ * rebuilt and resumed after the restart (see resumeCheckpointedJobs)
+ */
+export function createGangRunDispatcher(app: Express): GangRunDispatcher {
+  return (jobId, data, snapshot) => {
+    const checkpoints: JobCheckpointService | undefined = app.locals.jobCheckpoints;
+    data = applySheetTemplates(app, data);
+    checkpoints?.createJob(jobId, data, null, snapshot);
+    return packGangRun(app, jobId, data);
+  };
+}
+
+/**
+ * Run a gang-run batch's packing job; resolves with its result
+ * Orders were accepted when they joined the batch, so the batch bypasses the queue budget
+ */
+function packGangRun(app: Express, jobId: string, data: PackingWorkerData): Promise<MultiSheetResult> {
+  return new Promise((resolve, reject) => {
+    const jobScheduler: JobSchedulerService = app.locals.jobScheduler;
+    const jobStore: JobStore = app.locals.jobStore;
+    const options = createPackingJobOptions(app, jobId, data);
+
+    const admission = jobScheduler.submit(jobId, data, {
+      ...options,
+      onComplete: (result) => {
+        options.onComplete?.(result);
+        resolve(result);
+      },
+      onError: (error) => {
+        options.onError?.(error);
+        reject(new Error(error));
+      }
+    }, { force: true });
+    jobStore.update(jobId, { status: admission.position ? 'queued' : 'running', socketId: null });
+  });
+}
+
+/**
+ * Resume multi-sheet jobs interrupted by a restart, from their last checkpoint
+ * Clients reattach by emitting 'nesting:attach' with the jobId; gang-run batches are
+ * rebuilt in this process's gang-run service so their orders get their cut data
+ */
+export function resumeCheckpointedJobs(app: Express): void {
+  const checkpoints: JobCheckpointService | undefined = app.locals.jobCheckpoints;
+  const jobScheduler: JobSchedulerService = app.locals.jobScheduler;
+  const jobStore: JobStore = app.locals.jobStore;
+  const gangRuns: GangRunService | undefined = app.locals.gangRuns;
+  if (!checkpoints) return;
+
+  for (const job of checkpoints.claimOrphanedJobs()) {
+    console.log(`[Nesting] Resuming job ${job.jobId} from ${job.checkpoint ? `${job.checkpoint.sheets.length} checkpointed sheets` : 'the start'}`);
+    const data = { ...job.data, resumeFrom: job.checkpoint };
+    if (job.gangRun && gangRuns) {
+      gangRuns.resume(job.jobId, job.gangRun, packGangRun(app, job.jobId, data));
+      continue;
+    }
+
+    // Resumed jobs bypass the queue budget: they were already admitted before the restart
+    jobScheduler.submit(job.jobId, data, createPackingJobOptions(app, job.jobId, job.data), { force: true });
+    jobStore.update(job.jobId, { status: 'queued', socketId: job.socketId });
+  }
+}
+
+/**
+ * Submit a polygon packing job to the worker pool and answer with its job ID
+ * Progress and the result reach the client over Socket.IO (room: jobRoom(jobId))
+ */
+function startPolygonJob(
+  req: Request,
+  res: Response,
+  jobId: string,
+  jobData: PackingWorkerData,
+  socketId: string | null
+): void {
+  const jobScheduler: JobSchedulerService = req.app.locals.jobScheduler;
+  jobData = applySheetTemplates(req.app, jobData);
+
+  // The submitting socket follows the job's room; clients rejoin it by jobId after reconnecting
+  const io: SocketIOServer | undefined = req.app.locals.io;
+  if (socketId && io) {
+    io.in(socketId).socketsJoin(jobRoom(jobId));
+  }
+
+  // Checkpoint long multi-sheet jobs so they survive a server restart
+  // Recorded before submitting: a job that finishes right away must find its checkpoint to remove
+  const checkpoints: JobCheckpointService | undefined = req.app.locals.jobCheckpoints;
+  const checkpointed = jobData.type === 'multi-sheet' && !!checkpoints;
+  if (checkpointed) {
+    checkpoints!.createJob(jobId, jobData, socketId);
+  }
+
+  // Submit to the scheduler (admission control + shortest-expected-job-first)
+  const admission = jobScheduler.submit(jobId, jobData, createPackingJobOptions(req.app, jobId, jobData));
+
+  if (!admission.accepted) {
+    if (checkpointed) checkpoints!.completeJob(jobId);
+    res.setHeader('Retry-After', String(admission.retryAfterSeconds));
+    res.status(429).json({
+      error: 'Packing queue is full',
+      message: `Server is busy. Retry in ~${admission.retryAfterSeconds}s.`,
+      retryAfter: admission.retryAfterSeconds,
+      queue: admission.queue
+    });
+    return;
+  }
+
+  const jobStore: JobStore = req.app.locals.jobStore;
+  jobStore.update(jobId, {
+    status: admission.position ? 'queued' : 'running',
+    socketId
+  });
+
+  // Return immediately with job ID
+  res.json({
+    jobId,
+    message: admission.position
+      ? `Polygon packing queued (position ${admission.position}). Listen for progress via Socket.IO.`
+      : 'Polygon packing started. Listen for progress via Socket.IO.',
+    type: jobData.type,
+    queue: admission.queue,
+    estimatedSeconds: Math.ceil(admission.expectedSeconds)
+  });
+}
+
+/**
+ * A processed upload: outline (and holes) in mm, normalized to the sticker's bounding box
+ */
+interface ProcessedUpload {
+  id: string;
+  path: Point[];
+  holes?: Point[][];
+  width: number;
+  height: number;
+  descriptors: ShapeDescriptors;
+}
+
+type ProcessStreamEvent =
+  | { type: 'image'; index: number; image: ProcessedUpload } // index = position in the upload
+  | { type: 'error'; index: number; id: string; error: string }
+  | { type: 'complete'; summary: { processed: number; failed: number } };
+
+/**
+ * An outline the browser already traced for an upload (pixels of the uploaded image)
+ */
+interface ClientOutline {
+  path: Point[];
+  holes: Point[][];
+}
+
+const MM_PER_INCH = 25.4;
+
+function isRing(value: unknown): value is Point[] {
+  return Array.isArray(value) && value.length >= 3 &&
+    value.every(p => p && Number.isFinite(p.x) && Number.isFinite(p.y));
+}
+
+/**
+ * Parse the optional `outlines` form field: a JSON array aligned with the uploaded files,
+ * null where the server should trace the file itself. Throws on malformed input
+ */
+function parseClientOutlines(field: unknown, fileCount: number): Array<ClientOutline | null> {
+  if (field === undefined || field === '') return new Array(fileCount).fill(null);
+
+  const outlines = JSON.parse(String(field));
+  if (!Array.isArray(outlines) || outlines.length !== fileCount) {
+    throw new Error('outlines must list one entry (or null) per uploaded file');
+  }
+  return outlines.map((outline: any, index: number) => {
+    if (outline === null) return null;
+    const holes = outline.holes ?? [];
+    if (!isRing(outline.path) || !Array.isArray(holes) || !holes.every(isRing)) {
+      throw new Error(`Invalid outline for file ${index}`);
+    }
+    return { path: outline.path, holes };
+  });
+}
+
+/**
+ * Trace one uploaded file and scale it so its largest dimension is targetMaxMM
+ * A client outline replaces the raster trace (the browser already traced the same pixels)
+ */
+async function processUpload(
+  file: Express.Multer.File,
+  targetMaxMM: number,
+  flattenToleranceMM: number,
+  clientOutline: ClientOutline | null = null
+): Promise<ProcessedUpload> {
+  // Vector artwork: outline straight from the geometry (null = needs the raster fallback)
+  const artwork = !clientOutline && svgService.isSvg(file.buffer) ? svgService.parse(file.buffer) : null;
+  if (artwork) {
+    const { bounds } = artwork;
+    const scaleFactor = targetMaxMM / Math.max(bounds.width, bounds.height); // mm per SVG unit
+    const { path, holes } = svgService.traceOutline(artwork, flattenToleranceMM / scaleFactor);
+    const toMM = (p: Point) => ({
+      x: (p.x - bounds.minX) * scaleFactor,
+      y: (p.y - bounds.minY) * scaleFactor
+    });
+    const normalizedPath = path.map(toMM);
+    const normalizedHoles = holes.map(hole => hole.map(toMM));
+
+    return {
+      id: file.originalname,
+      path: normalizedPath,
+      holes: normalizedHoles.length > 0 ? normalizedHoles : undefined,
+      width: bounds.width * scaleFactor,
+      height: bounds.height * scaleFactor,
+      descriptors: geometryService.getShapeDescriptors(normalizedPath)
+    };
+  }
+
+  const { path, holes } = clientOutline ?? await imageService.processImage(file.buffer);
+  const simplified = geometryService.simplifyPath(path, 2.0);
+
+  // Calculate bounding box of the traced path (ignoring transparent background)
+  const bbox = geometryService.getBoundingBox(simplified);
+
+  // Convert bounding box to millimeters (300 DPI -> pixels to inches -> inches to mm)
+  const widthMM = (bbox.width / 300) * MM_PER_INCH;
+  const heightMM = (bbox.height / 300) * MM_PER_INCH;
+
+  // Scale image so largest dimension equals the user-specified max
+  const maxDimensionMM = Math.max(widthMM, heightMM);
+  const scaleFactor = targetMaxMM / maxDimensionMM;
+
+  // Calculate final dimensions in mm
+  const finalWidthMM = widthMM * scaleFactor;
+  const finalHeightMM = heightMM * scaleFactor;
+
+  // Normalize path coordinates relative to bounding box origin,
+  // convert to mm (300 DPI -> inches -> mm), and apply scale factor
+  const toMM = (p: Point) => ({
+    x: (((p.x - bbox.minX) / 300) * MM_PER_INCH) * scaleFactor,
+    y: (((p.y - bbox.minY) / 300) * MM_PER_INCH) * scaleFactor
+  });
+  const normalizedPath = simplified.map(toMM);
+
+  // Interior holes (rings, letters) in the same frame: packing nests small stickers in them
+  const normalizedHoles = holes
+    .map(hole => geometryService.simplifyPath(hole, 2.0).map(toMM))
+    .filter(hole => hole.length >= 3);
+
+  // Compute exact shape descriptors once per design (mm units) so packing
+  // doesn't have to approximate area from the bounding box
+  const descriptors = geometryService.getShapeDescriptors(normalizedPath);
+
+  return {
+    id: file.originalname,
+    path: normalizedPath,
+    holes: normalizedHoles.length > 0 ? normalizedHoles : undefined,
+    width: finalWidthMM,
+    height: finalHeightMM,
+    descriptors
+  };
+}
 
 /**
  * Process uploaded images and return traced paths
  * Accepts maxDimension and unit parameters to scale all images uniformly
+ * SVG uploads skip the raster trace: their outline comes from the vector geometry, with
+ * curves flattened to half a packing grid cell (cellsPerInch / rotationPreset, optional)
+ *
+ * With Accept: application/x-ndjson the response streams one line per file as soon as
+ * it is traced ({ type: 'image', index, image } or { type: 'error', index, id, error }),
+ * then a { type: 'complete' } line; a failed file no longer fails the whole batch
+ *
+ * Optional `outlines` field: JSON array aligned with the files, each { path, holes } in
+ * pixels of that file or null - files with an outline skip the server-side trace
  */
 router.post('/process', upload.array('images', 100), async (req: Request, res: Response) => {
   try {
@@ -23,54 +461,48 @@ router.post('/process', upload.array('images', 100), async (req: Request, res: R
       return res.status(400).json({ error: 'No files uploaded' });
     }
 
+    let clientOutlines: Array<ClientOutline | null>;
+    try {
+      clientOutlines = parseClientOutlines(req.body.outlines, files.length);
+    } catch (error: any) {
+      return res.status(400).json({ error: `Invalid outlines: ${error.message}` });
+    }
+
     // Get max dimension and unit from request body (sent as form fields)
     const maxDimension = parseFloat(req.body.maxDimension) || 3;
     const unit = req.body.unit || 'inches';
-    const MM_PER_INCH = 25.4;
 
     // Convert max dimension to mm for internal processing
     const targetMaxMM = unit === 'inches' ? maxDimension * MM_PER_INCH : maxDimension;
+    const { cellsPerInch } = resolvePackingSettings(req.body.rotationPreset, undefined, parseFloat(req.body.cellsPerInch) || undefined);
+    const flattenToleranceMM = MM_PER_INCH / cellsPerInch / 2;
+
+    if (wantsNdjson(req)) {
+      startNdjson(res);
+      let failed = 0;
+      await Promise.all(
+        files.map(async (file, index) => {
+          try {
+            writeNdjson(res, { type: 'image', index, image: await processUpload(file, targetMaxMM, flattenToleranceMM, clientOutlines[index]) });
+          } catch (error: any) {
+            failed++;
+            console.error(`Error processing ${file.originalname}:`, error);
+            writeNdjson(res, { type: 'error', index, id: file.originalname, error: error.message });
+          }
+        })
+      );
+      writeNdjson(res, { type: 'complete', summary: { processed: files.length - failed, failed } });
+      return res.end();
+    }
 
     const processed = await Promise.all(
-      files.map(async (file) => {
-        const { path } = await imageService.processImage(file.buffer);
-        const simplified = geometryService.simplifyPath(path, 2.0);
-
-        // Calculate bounding box of the traced path (ignoring transparent background)
-        const bbox = geometryService.getBoundingBox(simplified);
-
-        // Convert bounding box to millimeters (300 DPI -> pixels to inches -> inches to mm)
-        const MM_PER_INCH = 25.4;
-        const widthMM = (bbox.width / 300) * MM_PER_INCH;
-        const heightMM = (bbox.height / 300) * MM_PER_INCH;
-
-        // Scale image so largest dimension equals the user-specified max
-        const maxDimensionMM = Math.max(widthMM, heightMM);
-        const scaleFactor = targetMaxMM / maxDimensionMM;
-
-        // Calculate final dimensions in mm
-        const finalWidthMM = widthMM * scaleFactor;
-        const finalHeightMM = heightMM * scaleFactor;
-
-        // Normalize path coordinates relative to bounding box origin,
-        // convert to mm (300 DPI -> inches -> mm), and apply scale factor
-        const normalizedPath = simplified.map(p => ({
-          x: (((p.x - bbox.minX) / 300) * MM_PER_INCH) * scaleFactor,
-          y: (((p.y - bbox.minY) / 300) * MM_PER_INCH) * scaleFactor
-        }));
-
-        return {
-          id: file.originalname,
-          path: normalizedPath,
-          width: finalWidthMM,
-          height: finalHeightMM
-        };
-      })
+      files.map((file, index) => processUpload(file, targetMaxMM, flattenToleranceMM, clientOutlines[index]))
     );
 
     res.json({ images: processed });
   } catch (error: any) {
     console.error('Error processing images:', error);
+    if (res.headersSent) return res.end();
     res.status(500).json({ error: error.message });
   }
 });
@@ -95,123 +527,115 @@ router.post('/nest', async (req: Request, res: Response) => {
       stepSize,                  // Position search step size for polygon packing (optional, derived from preset)
       rotations,                 // Rotation angles to try in degrees (optional, derived from preset)
       packAllItems = true,       // Smart packing: true = auto-expand pages, false = fixed pages with fail-fast
+      hybrid = false,            // Polygon packing: MaxRects for near-rectangular designs, raster search for the rest
+      beamWidth,                 // Polygon packing: > 1 enables beam-search lookahead over this many partial layouts
+      placementScoring,          // Polygon packing: true or { contact, hullGrowth, fragmentation } weights to rank positions
+      placementWorkers,          // Single-sheet polygon packing: threads placing items concurrently (big sheets, many items)
+      remnants,                  // Partially used sheets: [{ polygons?: mm outlines, mask?: image }], by sheet index
+      stocks,                    // Multi-stock mode: [{ id, width, height }] (mm) - packer picks a stock per sheet
       socketId = null            // Socket ID for real-time progress updates
     } = req.body;
 
     // Convert rotationPreset to actual parameters if provided
-    let finalRotations = rotations || [0, 90, 180, 270];
-    let finalCellsPerInch = cellsPerInch || 100;
-    let finalStepSize = stepSize || 0.05;
-
-    if (rotationPreset) {
-      // Map preset to optimized parameters
-      switch (rotationPreset) {
-        case '90':
-          finalRotations = [0, 90, 180, 270];
-          finalCellsPerInch = 100;
-          finalStepSize = 0.05;
-          break;
-        case '45':
-          finalRotations = [0, 45, 90, 135, 180, 225, 270, 315];
-          finalCellsPerInch = 75;
-          finalStepSize = 0.075;
-          break;
-        case '15':
-          finalRotations = [0, 15, 30, 45, 60, 75, 90, 105, 120, 135, 150, 165, 180, 195, 210, 225, 240, 255, 270, 285, 300, 315, 330, 345];
-          finalCellsPerInch = 50;
-          finalStepSize = 0.1;
-          break;
-        case '10':
-          finalRotations = Array.from({ length: 36 }, (_, i) => i * 10);
-          finalCellsPerInch = 50;
-          finalStepSize = 0.1;
-          break;
-        case '5':
-          finalRotations = Array.from({ length: 72 }, (_, i) => i * 5);
-          finalCellsPerInch = 40;
-          finalStepSize = 0.15;
-          break;
-        default:
-          // Use provided rotations or default
-          break;
-      }
+    const { rotations: finalRotations, cellsPerInch: finalCellsPerInch, stepSize: finalStepSize } =
+      resolvePackingSettings(rotationPreset, rotations, cellsPerInch, stepSize);
+
+    const sheetStocks: SheetStock[] | undefined = Array.isArray(stocks) && stocks.length > 0 ? stocks : undefined;
+    if (sheetStocks?.some(stock => !stock.id || !(stock.width > 0) || !(stock.height > 0))) {
+      return res.status(400).json({ error: 'Each stock needs an id, width and height' });
     }
 
-    if (!stickers || stickers.length === 0 || !sheetWidth || !sheetHeight) {
+    if (!stickers || stickers.length === 0 || ((!sheetWidth || !sheetHeight) && !sheetStocks)) {
       return res.status(400).json({ error: 'Missing required parameters' });
     }
 
     const finalSpacing = spacing !== undefined ? spacing : 0.0625;
 
-    // Get Socket.IO and WorkerManager from app.locals
-    const io: SocketIOServer = req.app.locals.io;
-    const workerManager: WorkerManagerService = req.app.locals.workerManager;
+    if (beamWidth !== undefined && !Number.isFinite(beamWidth)) {
+      return res.status(400).json({ error: 'beamWidth must be a number' });
+    }
+
+    // Search options shared by every polygon job
+    const searchOptions: Pick<PackingWorkerData, 'hybrid' | 'beamWidth' | 'placementScoring'> = {
+      hybrid,
+      beamWidth: beamWidth !== undefined ? Math.max(1, Math.min(MAX_BEAM_WIDTH, Math.floor(beamWidth))) : undefined,
+      placementScoring: placementScoring === true ? {} : placementScoring || undefined,
+    };
+
+    // Multi-stock jobs: polygon packing across all sheets, sized by the largest stock for scheduling
+    if (sheetStocks) {
+      // Remnants are tied to one sheet size and concurrent placement is single-sheet only
+      if (remnants !== undefined) {
+        return res.status(400).json({ error: 'remnants cannot be combined with stocks' });
+      }
+      if (placementWorkers > 1) {
+        return res.status(400).json({ error: 'placementWorkers cannot be combined with stocks' });
+      }
+
+      const largest = sheetStocks.reduce((a, b) => (b.width * b.height > a.width * a.height ? b : a));
+      const jobId = uuidv4();
+      console.log(`[Nesting] Starting multi-stock packing job ${jobId} (${sheetStocks.map(s => s.id).join(', ')})`);
+      return startPolygonJob(req, res, jobId, {
+        type: 'multi-sheet',
+        stickers,
+        sheetWidth: largest.width,
+        sheetHeight: largest.height,
+        spacing: finalSpacing,
+        cellsPerInch: finalCellsPerInch,
+        stepSize: finalStepSize,
+        rotations: finalRotations,
+        packAllItems: true,
+        ...searchOptions,
+        stocks: sheetStocks
+      }, socketId);
+    }
+
+    // Get predictor from app.locals
+    const pageCountPredictor: PageCountPredictor | undefined = req.app.locals.pageCountPredictor;
+
+    // Remnant sheets need the raster grid: their used regions are arbitrary shapes
+    const sheetRemnants = await resolveRemnants(remnants);
+    if (sheetRemnants && !usePolygonPacking) {
+      console.log('[Nesting] Remnant sheets supplied - using polygon packing');
+    }
 
     // If using polygon packing, use worker threads
-    if (usePolygonPacking) {
+    if (usePolygonPacking || sheetRemnants) {
       const jobId = uuidv4();
       console.log(`[Nesting] Starting polygon packing job ${jobId} (socket: ${socketId || 'none'})`);
 
       // Determine packing type
       const packingType = (productionMode && sheetCount !== undefined) ? 'multi-sheet' : 'single-sheet';
 
-      // Start worker job (non-blocking)
-      workerManager.executePackingJob(
-        jobId,
-        {
-          type: packingType,
-          stickers,
-          sheetWidth,
-          sheetHeight,
-          spacing: finalSpacing,
-          cellsPerInch: finalCellsPerInch,
-          stepSize: finalStepSize,
-          rotations: finalRotations,
-          pageCount: sheetCount,
-          packAllItems
-        },
-        {
-          onProgress: (progress) => {
-            // Send progress updates via Socket.IO
-            if (socketId && io) {
-              io.to(socketId).emit('nesting:progress', {
-                jobId,
-                ...progress
-              });
-            }
-          },
-          onComplete: (result) => {
-            // Send completion event via Socket.IO
-            if (socketId && io) {
-              io.to(socketId).emit('nesting:complete', {
-                jobId,
-                result
-              });
-            }
-          },
-          onError: (error) => {
-            // Send error event via Socket.IO
-            if (socketId && io) {
-              io.to(socketId).emit('nesting:error', {
-                jobId,
-                error
-              });
-            }
-          }
-        }
-      ).catch(error => {
-        console.error(`[Nesting] Worker job ${jobId} failed:`, error);
-      });
+      // Concurrent placement runs the raster search only; it has no MaxRects pass to hand off from
+      if (packingType === 'single-sheet' && placementWorkers > 1 && hybrid) {
+        return res.status(400).json({ error: 'hybrid packing cannot be combined with placementWorkers' });
+      }
 
-      // Return immediately with job ID
-      return res.json({
-        jobId,
-        message: 'Polygon packing started. Listen for progress via Socket.IO.',
-        type: packingType
-      });
+      const jobData: PackingWorkerData = {
+        type: packingType,
+        stickers,
+        sheetWidth,
+        sheetHeight,
+        spacing: finalSpacing,
+        cellsPerInch: finalCellsPerInch,
+        stepSize: finalStepSize,
+        rotations: finalRotations,
+        pageCount: sheetCount,
+        packAllItems,
+        predictorModel: pageCountPredictor?.getModel(),
+        ...searchOptions,
+        placementWorkers: packingType === 'single-sheet' && placementWorkers > 1
+          ? Math.min(Math.floor(placementWorkers), os.cpus().length)
+          : undefined,
+        remnants: sheetRemnants
+      };
+
+      return startPolygonJob(req, res, jobId, jobData, socketId);
     }
 
     // For non-polygon packing, use synchronous methods (fast enough)
+    const nestingService: NestingService = req.app.locals.nestingService;
     if (productionMode && sheetCount !== undefined) {
       const result = nestingService.nestStickersMultiSheet(
         stickers,
@@ -220,6 +644,13 @@ router.post('/nest', async (req: Request, res: Response) => {
         sheetCount,
         finalSpacing
       );
+      if (wantsNdjson(req)) {
+        // Same line format as /jobs/:jobId/sheets so clients handle both paths alike
+        startNdjson(res);
+        result.sheets.forEach(sheet => writeNdjson(res, { type: 'sheet', sheet }));
+        writeNdjson(res, { type: 'complete', summary: summarizeResult(result) });
+        return res.end();
+      }
       res.json(result);
     } else {
       const result = nestingService.nestStickers(
@@ -236,4 +667,247 @@ router.post('/nest', async (req: Request, res: Response) => {
   }
 });
 
+/**
+ * Re-nest a single sheet after a small edit (resize, add, remove) without starting over
+ * Keeps the previous polygon layout and only searches for the changed stickers and the
+ * neighbours they displace. If the result is less dense than the previous layout by more
+ * than qualityThreshold allows (or something no longer fits), falls back to a full
+ * polygon packing job and answers like /nest does
+ */
+router.post('/nest/incremental', async (req: Request, res: Response) => {
+  try {
+    const {
+      stickers,
+      previous,                  // Placements from the last single-sheet result (mm)
+      changes = {},              // { added?, removed?, resized? } sticker IDs
+      sheetWidth,
+      sheetHeight,
+      spacing,
+      rotationPreset,
+      cellsPerInch,
+      stepSize,
+      rotations,
+      qualityThreshold = DEFAULT_INCREMENTAL_QUALITY,
+      socketId = null
+    } = req.body;
+
+    if (!stickers || stickers.length === 0 || !Array.isArray(previous) || !sheetWidth || !sheetHeight) {
+      return res.status(400).json({ error: 'Missing required parameters' });
+    }
+
+    const settings = resolvePackingSettings(rotationPreset, rotations, cellsPerInch, stepSize);
+    const finalSpacing = spacing !== undefined ? spacing : 0.0625;
+
+    const nestingService: NestingService = req.app.locals.nestingService;
+    const result = await nestingService.renestStickersPolygon(
+      stickers,
+      previous,
+      changes,
+      sheetWidth,
+      sheetHeight,
+      finalSpacing,
+      settings.cellsPerInch,
+      settings.stepSize,
+      settings.rotations
+    );
+
+    if (result.unplaced.length === 0 && result.quality >= qualityThreshold) {
+      return res.json({ ...result, incremental: true });
+    }
+
+    const jobId = uuidv4();
+    console.log(
+      `[Nesting] Incremental re-nest fell back to full packing job ${jobId} ` +
+      `(quality ${result.quality.toFixed(2)}, ${result.unplaced.length} unplaced)`
+    );
+    const removed = new Set<string>(changes.removed || []);
+    const pageCountPredictor: PageCountPredictor | undefined = req.app.locals.pageCountPredictor;
+    startPolygonJob(req, res, jobId, {
+      type: 'single-sheet',
+      stickers: stickers.filter((s: { id: string }) => !removed.has(s.id)),
+      sheetWidth,
+      sheetHeight,
+      spacing: finalSpacing,
+      ...settings,
+      predictorModel: pageCountPredictor?.getModel()
+    }, socketId);
+  } catch (error: any) {
+    console.error('Error re-nesting stickers:', error);
+    res.status(500).json({ error: error.message });
+  }
+});
+
+/**
+ * Add a small order to the open gang run for its sheet settings
+ * Orders collected over the batching window are packed together onto shared sheets;
+ * poll the order (or follow the batch's jobId) for its placements once packed
+ */
+router.post('/gang-run/orders', (req: Request, res: Response) => {
+  try {
+    const gangRuns: GangRunService = req.app.locals.gangRuns;
+    const {
+      orderId,
+      stickers,
+      sheetWidth,
+      sheetHeight,
+      spacing,
+      rotationPreset,
+      cellsPerInch,
+      stepSize,
+      rotations
+    } = req.body;
+
+    if (!stickers || stickers.length === 0 || !sheetWidth || !sheetHeight) {
+      return res.status(400).json({ error: 'Missing required parameters' });
+    }
+
+    const order = {
+      orderId,
+      stickers,
+      sheetWidth,
+      sheetHeight,
+      spacing: spacing !== undefined ? spacing : 0.0625,
+      ...resolvePackingSettings(rotationPreset, rotations, cellsPerInch, stepSize)
+    };
+    if (!gangRuns.accepts(order)) {
+      return res.status(400).json({ error: 'Order is too large for a gang run - nest it on its own sheets' });
+    }
+
+    const state = gangRuns.submit(order);
+    res.status(202).json({ ...state, closesAt: gangRuns.getBatch(state.batchId)?.closesAt });
+  } catch (error: any) {
+    console.error('Error adding gang-run order:', error);
+    res.status(400).json({ error: error.message });
+  }
+});
+
+/**
+ * Get a gang-run order's status and, once its batch is packed, its cut data
+ * (placements on the shared sheets, with the order's own item IDs)
+ */
+router.get('/gang-run/orders/:orderId', (req: Request, res: Response) => {
+  const gangRuns: GangRunService = req.app.locals.gangRuns;
+  const order = gangRuns.getOrder(req.params.orderId);
+  if (!order) {
+    return res.status(404).json({ error: 'Order not found' });
+  }
+  res.json(order);
+});
+
+/**
+ * Get a gang-run batch: its shared sheets and the per-sheet sort list
+ */
+router.get('/gang-run/batches/:batchId', (req: Request, res: Response) => {
+  const gangRuns: GangRunService = req.app.locals.gangRuns;
+  const batch = gangRuns.getBatch(req.params.batchId);
+  if (!batch) {
+    return res.status(404).json({ error: 'Batch not found' });
+  }
+  res.json(batch);
+});
+
+/**
+ * Get status (and result, once complete) of a polygon packing job
+ * Served by whichever process receives the request, via the shared job registry
+ */
+router.get('/jobs/:jobId', async (req: Request, res: Response) => {
+  try {
+    const jobStore: JobStore = req.app.locals.jobStore;
+    const record = await jobStore.get(req.params.jobId);
+    if (!record) {
+      return res.status(404).json({ error: 'Job not found' });
+    }
+    res.json(record);
+  } catch (error: any) {
+    console.error('Error fetching job status:', error);
+    res.status(500).json({ error: error.message });
+  }
+});
+
+/**
+ * Stream a multi-sheet job's finalized sheets as NDJSON, one line per sheet as it closes
+ * Sheets finished before the request are replayed first; the last line is 'complete' or 'error'
+ */
+router.get('/jobs/:jobId/sheets', async (req: Request, res: Response) => {
+  try {
+    const jobStore: JobStore = req.app.locals.jobStore;
+    const jobEvents: JobEventsService = req.app.locals.jobEvents;
+    const { jobId } = req.params;
+
+    const record = await jobStore.get(jobId);
+    if (!record) {
+      return res.status(404).json({ error: 'Job not found' });
+    }
+
+    startNdjson(res);
+
+    const sentSheets = new Set<number>();
+    let finished = false;
+
+    const write = (event: JobStreamEvent) => {
+      if (finished) return;
+      if (event.type === 'sheet') {
+        if (sentSheets.has(event.sheet.sheetIndex)) return;
+        sentSheets.add(event.sheet.sheetIndex);
+      }
+      writeNdjson(res, event);
+      if (event.type !== 'sheet') {
+        stop();
+        res.end();
+      }
+    };
+
+    const replay = (latest: JobRecord) => {
+      latest.sheets?.forEach(sheet => write({ type: 'sheet', sheet }));
+      if (latest.status === 'complete') {
+        write({ type: 'complete', summary: summarizeResult(latest.result) });
+      } else if (latest.status === 'error') {
+        write({ type: 'error', error: latest.error || 'Unknown error' });
+      }
+    };
+
+    const unsubscribe = jobEvents.subscribe(jobId, write);
+
+    // Jobs running in another cluster process only reach this one through the registry
+    const poll = jobStore instanceof ClusterJobStore
+      ? setInterval(async () => {
+          const latest = await jobStore.get(jobId);
+          if (latest) replay(latest);
+        }, NDJSON_POLL_INTERVAL_MS)
+      : undefined;
+
+    const stop = () => {
+      finished = true;
+      unsubscribe();
+      if (poll) clearInterval(poll);
+    };
+    req.on('close', stop);
+
+    replay(record);
+  } catch (error: any) {
+    console.error('Error streaming job sheets:', error);
+    if (!res.headersSent) {
+      res.status(500).json({ error: error.message });
+    } else {
+      res.end();
+    }
+  }
+});
+
+function wantsNdjson(req: Request): boolean {
+  return (req.headers.accept || '').includes('application/x-ndjson');
+}
+
+function startNdjson(res: Response): void {
+  res.status(200);
+  res.setHeader('Content-Type', 'application/x-ndjson');
+  res.setHeader('Cache-Control', 'no-cache');
+  res.setHeader('X-Accel-Buffering', 'no'); // Don't let nginx buffer the stream
+  res.flushHeaders();
+}
+
+function writeNdjson(res: Response, event: JobStreamEvent | ProcessStreamEvent): void {
+  res.write(JSON.stringify(event) + '\n');
+}
+
 export const nestingRouter = router;
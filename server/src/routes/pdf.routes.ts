@@ -1,11 +1,37 @@
 import { Router, Request, Response } from 'express';
 import { upload } from '../config/multer';
-import { PdfService } from '../services/pdf.service';
-import { Sticker } from '../services/nesting.service';
+import { PdfService, SheetPdfRenderer } from '../services/pdf.service';
+import { Sticker, NestingService } from '../services/nesting.service';
+import { JobSchedulerService } from '../services/job-scheduler.service';
+import { JobStore } from '../services/job-store.service';
+import { PageCountPredictor } from '../services/page-count-predictor.service';
+import { applySheetTemplates, createPackingJobOptions, resolvePackingSettings, resolveRemnants, jobRoom } from './nesting.routes';
+import { Server as SocketIOServer } from 'socket.io';
+import { v4 as uuidv4 } from 'uuid';
 
 const router = Router();
 const pdfService = new PdfService();
 
+/**
+ * Build the sticker map from uploaded images (files are named by sticker ID)
+ */
+function buildStickerMap(files: Express.Multer.File[], parsedStickers: any[]): Map<string, Sticker & { imageBuffer: Buffer }> {
+  const stickerMap = new Map<string, Sticker & { imageBuffer: Buffer }>();
+  files.forEach((file) => {
+    // The original filename should match a sticker ID
+    const sticker = parsedStickers.find((s: any) => s.id === file.originalname);
+    if (sticker) {
+      stickerMap.set(sticker.id, {
+        ...sticker,
+        imageBuffer: file.buffer
+      });
+    } else {
+      console.warn(`No sticker found for file: ${file.originalname}`);
+    }
+  });
+  return stickerMap;
+}
+
 /**
  * Generate PDF from placements
  */
@@ -33,19 +59,7 @@ router.post('/generate', upload.array('images', 100), async (req: Request, res:
 
     // Create sticker map with images
     // Files are uploaded with sticker ID as the filename
-    const stickerMap = new Map<string, Sticker & { imageBuffer: Buffer }>();
-    files.forEach((file) => {
-      // The original filename should match a sticker ID
-      const sticker = parsedStickers.find((s: any) => s.id === file.originalname);
-      if (sticker) {
-        stickerMap.set(sticker.id, {
-          ...sticker,
-          imageBuffer: file.buffer
-        });
-      } else {
-        console.warn(`No sticker found for file: ${file.originalname}`);
-      }
-    });
+    const stickerMap = buildStickerMap(files, parsedStickers);
 
     // Set response headers for PDF streaming
     res.setHeader('Content-Type', 'application/pdf');
@@ -80,4 +94,136 @@ router.post('/generate', upload.array('images', 100), async (req: Request, res:
   }
 });
 
+/**
+ * Pack and render in one job: each sheet is drawn as a PDF page as soon as the packer
+ * finalizes it, and the PDF streams out while later sheets are still packing
+ * End-to-end latency is ~max(pack, render) instead of pack + round trip + render
+ *
+ * Multipart fields: images (named by sticker ID), stickers (JSON, with points),
+ * sheetWidth, sheetHeight, sheetCount, spacing, rotationPreset, packAllItems,
+ * usePolygonPacking, socketId (optional, for progress events)
+ * The job ID is returned in the X-Job-Id header
+ */
+router.post('/pack-and-render', upload.array('images', 100), async (req: Request, res: Response) => {
+  try {
+    const files = req.files as Express.Multer.File[];
+    const { stickers, sheetWidth, sheetHeight, sheetCount, spacing, rotationPreset, socketId } = req.body;
+
+    if (!files || !sheetWidth || !sheetHeight || !stickers) {
+      return res.status(400).json({ error: 'Missing required parameters' });
+    }
+
+    const parsedStickers = JSON.parse(stickers);
+    const stickerMap = buildStickerMap(files, parsedStickers);
+    const width = parseFloat(sheetWidth);
+    const height = parseFloat(sheetHeight);
+    const pageCount = sheetCount ? parseInt(sheetCount, 10) : 1;
+    const finalSpacing = spacing !== undefined ? parseFloat(spacing) : 0.0625;
+    const packAllItems = req.body.packAllItems !== 'false';
+    // Remnant sheets (JSON, same shape as /api/nesting/nest) always use polygon packing
+    const remnants = req.body.remnants ? await resolveRemnants(JSON.parse(req.body.remnants)) : undefined;
+    const usePolygonPacking = req.body.usePolygonPacking !== 'false' || remnants !== undefined;
+
+    // Rectangle packing is synchronous and fast: pack, then render
+    if (!usePolygonPacking) {
+      const nestingService: NestingService = req.app.locals.nestingService;
+      const result = nestingService.nestStickersMultiSheet(parsedStickers, width, height, pageCount, finalSpacing);
+      res.setHeader('Content-Type', 'application/pdf');
+      res.setHeader('Content-Disposition', 'attachment; filename=sticker-layout.pdf');
+      await pdfService.generateMultiSheetPdf(stickerMap, result.sheets, width, height, res);
+      return;
+    }
+
+    const jobScheduler: JobSchedulerService = req.app.locals.jobScheduler;
+    const pageCountPredictor: PageCountPredictor | undefined = req.app.locals.pageCountPredictor;
+    const settings = resolvePackingSettings(rotationPreset);
+    const jobId = uuidv4();
+
+    const io: SocketIOServer | undefined = req.app.locals.io;
+    if (socketId && io) {
+      io.in(socketId).socketsJoin(jobRoom(jobId));
+    }
+
+    // Renderer is created once the job is admitted; sheets can only arrive after that
+    let renderer: SheetPdfRenderer | undefined;
+    const jobData = applySheetTemplates(req.app, {
+      type: 'multi-sheet',
+      stickers: parsedStickers,
+      sheetWidth: width,
+      sheetHeight: height,
+      spacing: finalSpacing,
+      cellsPerInch: settings.cellsPerInch,
+      stepSize: settings.stepSize,
+      rotations: settings.rotations,
+      pageCount,
+      packAllItems,
+      predictorModel: pageCountPredictor?.getModel(),
+      hybrid: req.body.hybrid === 'true',
+      remnants
+    });
+    const baseOptions = createPackingJobOptions(req.app, jobId, jobData);
+
+    const admission = jobScheduler.submit(
+      jobId,
+      jobData,
+      {
+        ...baseOptions,
+        onSheet: (sheet) => {
+          baseOptions.onSheet?.(sheet);
+          renderer?.addSheet(sheet);
+        },
+        onComplete: (result) => {
+          baseOptions.onComplete?.(result);
+          if (res.destroyed) return;
+          renderer?.finish()
+            .then(() => console.log(`[PackAndRender] Job ${jobId}: ${renderer?.getPageCount()} pages streamed`))
+            .catch(error => {
+              console.error(`[PackAndRender] Rendering failed for job ${jobId}:`, error);
+              res.destroy(error);
+            });
+        },
+        onError: (error) => {
+          baseOptions.onError?.(error);
+          // Headers and early pages are already sent; abort so the client sees a truncated download
+          res.destroy(new Error(error));
+        }
+      }
+    );
+
+    if (!admission.accepted) {
+      res.setHeader('Retry-After', String(admission.retryAfterSeconds));
+      return res.status(429).json({
+        error: 'Packing queue is full',
+        message: `Server is busy. Retry in ~${admission.retryAfterSeconds}s.`,
+        retryAfter: admission.retryAfterSeconds,
+        queue: admission.queue
+      });
+    }
+
+    const jobStore: JobStore = req.app.locals.jobStore;
+    jobStore.update(jobId, { status: admission.position ? 'queued' : 'running', socketId });
+
+    console.log(`[PackAndRender] Job ${jobId}: ${parsedStickers.length} items, streaming pages as sheets finalize`);
+    res.setHeader('Content-Type', 'application/pdf');
+    res.setHeader('Content-Disposition', 'attachment; filename=sticker-layout.pdf');
+    res.setHeader('X-Job-Id', jobId);
+    renderer = pdfService.createSheetRenderer(stickerMap, width, height, res);
+
+    // Client went away mid-download: stop drawing pages nobody will receive
+    // (the scheduler has no cancellation, so the packing job itself runs to completion)
+    res.on('close', () => {
+      if (res.writableFinished) return;
+      console.log(`[PackAndRender] Job ${jobId}: client disconnected, rendering stopped`);
+      renderer?.abort();
+    });
+  } catch (error: any) {
+    console.error('Error in pack-and-render:', error);
+    if (!res.headersSent) {
+      res.status(500).json({ error: error.message });
+    } else {
+      res.destroy(error);
+    }
+  }
+});
+
 export const pdfRouter = router;
@@ -0,0 +1,214 @@
+/**
+ * Cluster Service
+ * Multi-process mode: N server processes behind the primary, no external broker
+ *
+ * - The primary owns the listening port and hands each TCP connection to a
+ *   worker chosen by client address, so Socket.IO polling and upgrade requests
+ *   from one client always reach the same process (sticky sessions)
+ * - The primary hosts the shared job registry (see job-store.service)
+ * - The primary owns the page-count model: workers forward completed jobs and
+ *   get the updated model back, so one process writes the model file
+ * - Socket.IO events for a socket owned by another process are relayed
+ *   through the primary to every worker (progress fan-out)
+ *
+ * Stickiness is by remote address: behind a reverse proxy that hides client
+ * IPs, all traffic lands on one process, so enable this on a direct-facing port.
+ */
+import cluster, { Worker as ClusterWorker } from 'cluster';
+import net from 'net';
+import { Server as HttpServer } from 'http';
+import { Server as SocketIOServer } from 'socket.io';
+import {
+  MemoryJobStore,
+  JobStoreUpdateMessage,
+  JobStoreGetMessage,
+  JobStoreReplyMessage,
+} from './job-store.service';
+import {
+  PageCountPredictor,
+  PredictorObserveMessage,
+  PredictorSyncMessage,
+  PredictorModelMessage,
+} from './page-count-predictor.service';
+
+export interface StickyConnectionMessage {
+  type: 'sticky:connection';
+}
+
+export interface FanoutEmitMessage {
+  type: 'fanout:emit';
+  target: string; // Socket ID or room
+  event: string;
+  payload: any;
+}
+
+type PrimaryInboundMessage =
+  | JobStoreUpdateMessage
+  | JobStoreGetMessage
+  | FanoutEmitMessage
+  | PredictorObserveMessage
+  | PredictorSyncMessage;
+
+/**
+ * Pick a worker slot for a client address (FNV-1a hash)
+ */
+export function pickWorkerIndex(address: string, workerCount: number): number {
+  let hash = 0x811c9dc5;
+  for (let i = 0; i < address.length; i++) {
+    hash ^= address.charCodeAt(i);
+    hash = Math.imul(hash, 0x01000193);
+  }
+  return (hash >>> 0) % workerCount;
+}
+
+/**
+ * Run the cluster primary: fork workers, route connections, host the job registry
+ * and the page-count model
+ */
+export function startClusterPrimary(
+  port: number | string,
+  workerCount: number,
+  predictor: PageCountPredictor
+): void {
+  const workers: ClusterWorker[] = [];
+  const jobStore = new MemoryJobStore();
+  let shuttingDown = false;
+
+  const fork = (index: number) => {
+    const worker = cluster.fork();
+    workers[index] = worker;
+
+    worker.on('message', (message: PrimaryInboundMessage) => {
+      if (message.type === 'jobs:update') {
+        jobStore.update(message.jobId, message.patch);
+      } else if (message.type === 'jobs:get') {
+        const reply: JobStoreReplyMessage = {
+          type: 'jobs:reply',
+          requestId: message.requestId,
+          record: jobStore.getSync(message.jobId),
+        };
+        worker.send(reply);
+      } else if (message.type === 'predictor:observe') {
+        // Observe (and persist) here only, then hand every worker the new model
+        predictor.recordCompletedJob(message.sample);
+        const update: PredictorModelMessage = { type: 'predictor:model', model: predictor.getModel() };
+        workers.forEach(other => {
+          if (other.isConnected()) {
+            other.send(update);
+          }
+        });
+      } else if (message.type === 'predictor:sync') {
+        const reply: PredictorModelMessage = { type: 'predictor:model', model: predictor.getModel() };
+        worker.send(reply);
+      } else if (message.type === 'fanout:emit') {
+        // Relay to every other worker; the one holding the socket emits it
+        workers.forEach(other => {
+          if (other !== worker && other.isConnected()) {
+            other.send(message);
+          }
+        });
+      }
+    });
+
+    worker.on('exit', (code, signal) => {
+      if (shuttingDown) return;
+      console.warn(`⚠️  Cluster worker ${worker.process.pid} exited (${signal || code}), restarting...`);
+      fork(index);
+    });
+  };
+
+  for (let i = 0; i < workerCount; i++) {
+    fork(i);
+  }
+
+  // Connections are paused until the worker takes them over
+  const server = net.createServer({ pauseOnConnect: true }, (connection) => {
+    const preferred = pickWorkerIndex(connection.remoteAddress || '', workerCount);
+
+    // Fall back to the next live worker if the preferred one is restarting
+    for (let offset = 0; offset < workerCount; offset++) {
+      const worker = workers[(preferred + offset) % workerCount];
+      if (worker?.isConnected()) {
+        const message: StickyConnectionMessage = { type: 'sticky:connection' };
+        worker.send(message, connection);
+        return;
+      }
+    }
+    connection.destroy();
+  });
+
+  const shutdown = (signal: string) => {
+    console.log(`${signal} received, stopping cluster workers...`);
+    shuttingDown = true;
+    server.close();
+    workers.forEach(worker => worker.kill('SIGTERM'));
+    process.exit(0);
+  };
+  process.on('SIGTERM', () => shutdown('SIGTERM'));
+  process.on('SIGINT', () => shutdown('SIGINT'));
+
+  server.listen(port, () => {
+    console.log(`⚡️ Cluster primary listening on port ${port} with ${workerCount} workers`);
+    console.warn(
+      '⚠️  Cluster connections are pinned to workers by client address; behind a reverse proxy ' +
+      '(e.g. nginx-proxy-manager) every connection shares the proxy\'s address and lands on one worker'
+    );
+  });
+}
+
+/**
+ * In a cluster worker, serve connections handed over by the primary
+ * The worker's HTTP server never listens on its own, which would bypass stickiness
+ */
+export function attachStickyConnections(httpServer: HttpServer): void {
+  process.on('message', (message: any, handle: unknown) => {
+    if (message?.type !== 'sticky:connection' || !handle) return;
+    const connection = handle as net.Socket;
+    httpServer.emit('connection', connection);
+    connection.resume();
+  });
+}
+
+/**
+ * Emits Socket.IO events to a socket or room that may live in another process
+ */
+export class ProgressFanout {
+  constructor(
+    private readonly io: SocketIOServer,
+    private readonly clustered: boolean = cluster.isWorker
+  ) {
+    if (this.clustered) {
+      process.on('message', (message: any) => {
+        if (message?.type !== 'fanout:emit') return;
+        const relayed = message as FanoutEmitMessage;
+        if (this.hasLocal(relayed.target)) {
+          this.io.to(relayed.target).emit(relayed.event, relayed.payload);
+        }
+      });
+    }
+  }
+
+  /**
+   * Emit to a socket ID or room name
+   */
+  emitTo(target: string, event: string, payload: any): void {
+    if (!this.clustered) {
+      this.io.to(target).emit(event, payload);
+      return;
+    }
+
+    if (this.hasLocal(target)) {
+      this.io.to(target).emit(event, payload);
+    }
+
+    // A socket lives in exactly one process; room members may be spread across several
+    if (!this.io.sockets.sockets.has(target)) {
+      const message: FanoutEmitMessage = { type: 'fanout:emit', target, event, payload };
+      process.send?.(message);
+    }
+  }
+
+  private hasLocal(target: string): boolean {
+    return this.io.sockets.sockets.has(target) || this.io.sockets.adapter.rooms.has(target);
+  }
+}
@@ -0,0 +1,363 @@
+/**
+ * Gang Run Service
+ * Collects small orders over a time window and packs them jointly onto shared sheets
+ *
+ * - Orders with the same sheet and packing settings join one open batch
+ * - A batch closes when its window expires or it reaches its item cap, and is packed
+ *   as a single multi-sheet job (one packing call instead of one per order)
+ * - Item IDs are namespaced by order inside the batch (`${orderId}:${itemId}`) so every
+ *   placement keeps its owner; the result is split back into per-order cut data and a
+ *   per-sheet sort list (which order's items to pull from each printed sheet)
+ *
+ * Batches live in this process only: in cluster mode each server process gangs the
+ * orders it receives. On shutdown the open batches are flushed, and their packing jobs
+ * are checkpointed like other multi-sheet jobs together with the batch's snapshot (orders
+ * and item owners), so the process resuming the job rebuilds the batch and its orders
+ * still get their cut data. Every batch's job ID is fixed when the batch opens and
+ * returned with each order.
+ */
+import { v4 as uuidv4 } from 'uuid';
+import { MultiSheetResult, Placement, SheetPlacement } from './nesting.service';
+import { PackableSticker } from './polygon-packing.service';
+import { PackingWorkerData } from '../workers/packing.worker';
+
+export interface GangRunOrder {
+  orderId?: string; // Generated when absent
+  stickers: PackableSticker[];
+  sheetWidth: number;  // mm
+  sheetHeight: number; // mm
+  spacing: number;     // mm
+  cellsPerInch: number;
+  stepSize: number;
+  rotations: number[];
+}
+
+export interface GangRunOptions {
+  windowMs: number;      // How long a batch collects orders after its first one
+  maxOrderItems: number; // Larger orders are packed on their own sheets (regular /nest)
+  maxBatchItems: number; // A batch closes early once it holds this many items
+}
+
+export type GangRunStatus = 'collecting' | 'packing' | 'complete' | 'error';
+
+/**
+ * One order's share of a packed batch: its placements per shared sheet, original IDs (mm)
+ */
+export interface GangRunOrderSheet {
+  sheetIndex: number;
+  placements: Placement[];
+}
+
+export interface GangRunOrderState {
+  orderId: string;
+  batchId: string;
+  status: GangRunStatus;
+  itemCount: number;
+  jobId?: string;
+  sheets?: GangRunOrderSheet[]; // Cut data, once the batch is packed
+  error?: string;
+}
+
+/**
+ * Items to sort into each order's bin after cutting one sheet
+ */
+export interface GangRunSortEntry {
+  sheetIndex: number;
+  orders: Array<{ orderId: string; itemIds: string[] }>;
+}
+
+export interface GangRunBatchState {
+  batchId: string;
+  status: GangRunStatus;
+  orderIds: string[];
+  itemCount: number;
+  closesAt: number;
+  jobId?: string;
+  sheets?: SheetPlacement[];  // Shared sheets, namespaced item IDs
+  sort?: GangRunSortEntry[];
+  totalUtilization?: number;
+  error?: string;
+}
+
+/**
+ * What a batch needs to be rebuilt after a restart: stored with its packing job's checkpoint
+ */
+export interface GangRunSnapshot {
+  batchId: string;
+  orderIds: string[];
+  owners: Array<{ id: string; orderId: string; itemId: string }>; // Namespaced item ID → owner
+}
+
+/**
+ * Packs a closed batch; resolves with the multi-sheet result (see JobSchedulerService)
+ */
+export type GangRunDispatcher = (
+  jobId: string,
+  data: PackingWorkerData,
+  snapshot: GangRunSnapshot
+) => Promise<MultiSheetResult>;
+
+interface Batch {
+  state: GangRunBatchState;
+  settings?: Omit<GangRunOrder, 'orderId' | 'stickers'>; // Unset for batches resumed after a restart
+  stickers: PackableSticker[];
+  owners: Map<string, { orderId: string; itemId: string }>; // Namespaced item ID → owner
+  timer?: NodeJS.Timeout;
+}
+
+const DEFAULT_OPTIONS: GangRunOptions = {
+  windowMs: 5 * 60 * 1000,
+  maxOrderItems: 50,
+  maxBatchItems: 1000,
+};
+
+// Finished orders and batches are kept this long for clients to collect
+const RESULT_RETENTION_MS = 24 * 60 * 60 * 1000;
+
+export class GangRunService {
+  private readonly options: GangRunOptions;
+  private readonly openBatches = new Map<string, Batch>(); // Settings key → collecting batch
+  private readonly batches = new Map<string, Batch>();
+  private readonly orders = new Map<string, GangRunOrderState>();
+
+  constructor(
+    private readonly dispatch: GangRunDispatcher,
+    options: Partial<GangRunOptions> = {}
+  ) {
+    this.options = {
+      windowMs: options.windowMs ?? DEFAULT_OPTIONS.windowMs,
+      maxOrderItems: options.maxOrderItems ?? DEFAULT_OPTIONS.maxOrderItems,
+      maxBatchItems: options.maxBatchItems ?? DEFAULT_OPTIONS.maxBatchItems,
+    };
+  }
+
+  /**
+   * Whether an order is small enough to be ganged with others
+   */
+  accepts(order: GangRunOrder): boolean {
+    return order.stickers.length > 0 && order.stickers.length <= this.options.maxOrderItems;
+  }
+
+  /**
+   * Add an order to the open batch for its settings (opening one if needed)
+   */
+  submit(order: GangRunOrder): GangRunOrderState {
+    if (!this.accepts(order)) {
+      throw new Error(`Gang runs take orders of 1-${this.options.maxOrderItems} items (got ${order.stickers.length})`);
+    }
+    const orderId = order.orderId || uuidv4();
+    if (this.orders.has(orderId)) {
+      throw new Error(`Order ${orderId} was already submitted`);
+    }
+    const itemIds = new Set(order.stickers.map(sticker => sticker.id));
+    if (itemIds.size !== order.stickers.length) {
+      throw new Error(`Order ${orderId} lists an item ID more than once`);
+    }
+
+    const { stickers, sheetWidth, sheetHeight, spacing, cellsPerInch, stepSize, rotations } = order;
+    const settings = { sheetWidth, sheetHeight, spacing, cellsPerInch, stepSize, rotations };
+    const key = settingsKey(settings);
+    let batch = this.openBatches.get(key);
+    if (!batch) {
+      batch = this.openBatch(key, settings);
+    }
+
+    for (const sticker of stickers) {
+      const id = `${orderId}:${sticker.id}`;
+      batch.owners.set(id, { orderId, itemId: sticker.id });
+      batch.stickers.push({ ...sticker, id });
+    }
+    batch.state.orderIds.push(orderId);
+    batch.state.itemCount += stickers.length;
+
+    const state: GangRunOrderState = {
+      orderId,
+      batchId: batch.state.batchId,
+      status: 'collecting',
+      itemCount: stickers.length,
+      jobId: batch.state.jobId
+    };
+    this.orders.set(orderId, state);
+    console.log(`[GangRun] Order ${orderId} (${stickers.length} items) joined batch ${batch.state.batchId} (${batch.state.itemCount} items)`);
+
+    if (batch.state.itemCount >= this.options.maxBatchItems) {
+      this.close(key);
+    }
+    return { ...state };
+  }
+
+  getOrder(orderId: string): GangRunOrderState | undefined {
+    const state = this.orders.get(orderId);
+    return state && { ...state };
+  }
+
+  getBatch(batchId: string): GangRunBatchState | undefined {
+    const batch = this.batches.get(batchId);
+    return batch && { ...batch.state };
+  }
+
+  /**
+   * Close every collecting batch now (on shutdown, or for an operator's "print now")
+   */
+  flush(): void {
+    [...this.openBatches.keys()].forEach(key => this.close(key));
+  }
+
+  /**
+   * Rebuild a batch whose packing job was checkpointed before a restart and is being resumed
+   */
+  resume(jobId: string, snapshot: GangRunSnapshot, packing: Promise<MultiSheetResult>): void {
+    const owners = new Map(snapshot.owners.map(({ id, orderId, itemId }) => [id, { orderId, itemId }]));
+    const batch: Batch = {
+      state: {
+        batchId: snapshot.batchId,
+        status: 'packing',
+        orderIds: [...snapshot.orderIds],
+        itemCount: owners.size,
+        closesAt: Date.now(),
+        jobId
+      },
+      stickers: [],
+      owners,
+    };
+    this.batches.set(snapshot.batchId, batch);
+    for (const orderId of snapshot.orderIds) {
+      const itemCount = snapshot.owners.filter(owner => owner.orderId === orderId).length;
+      this.orders.set(orderId, { orderId, batchId: snapshot.batchId, status: 'packing', itemCount, jobId });
+    }
+    console.log(`[GangRun] Resumed batch ${snapshot.batchId}: ${snapshot.orderIds.length} orders (job ${jobId})`);
+    this.track(batch, packing);
+  }
+
+  private openBatch(key: string, settings: Batch['settings']): Batch {
+    const batchId = uuidv4();
+    const batch: Batch = {
+      state: {
+        batchId,
+        status: 'collecting',
+        orderIds: [],
+        itemCount: 0,
+        closesAt: Date.now() + this.options.windowMs,
+        jobId: uuidv4() // Fixed up front so orders can follow the packing job from the start
+      },
+      settings,
+      stickers: [],
+      owners: new Map(),
+    };
+    batch.timer = setTimeout(() => this.close(key), this.options.windowMs);
+    batch.timer.unref?.();
+    this.openBatches.set(key, batch);
+    this.batches.set(batchId, batch);
+    return batch;
+  }
+
+  private close(key: string): void {
+    const batch = this.openBatches.get(key);
+    if (!batch) return;
+    this.openBatches.delete(key);
+    clearTimeout(batch.timer);
+
+    const jobId = batch.state.jobId!;
+    this.setStatus(batch, 'packing');
+    console.log(`[GangRun] Packing batch ${batch.state.batchId}: ${batch.state.orderIds.length} orders, ${batch.state.itemCount} items (job ${jobId})`);
+
+    const snapshot: GangRunSnapshot = {
+      batchId: batch.state.batchId,
+      orderIds: batch.state.orderIds,
+      owners: [...batch.owners].map(([id, owner]) => ({ id, ...owner })),
+    };
+    this.track(batch, this.dispatch(jobId, {
+      type: 'multi-sheet',
+      stickers: batch.stickers,
+      ...batch.settings!,
+      pageCount: 1,
+      packAllItems: true,
+    }, snapshot));
+  }
+
+  private track(batch: Batch, packing: Promise<MultiSheetResult>): void {
+    packing
+      .then(result => this.complete(batch, result))
+      .catch(error => {
+        batch.state.error = error?.message || String(error);
+        this.setStatus(batch, 'error');
+      })
+      .finally(() => {
+        batch.stickers = []; // Outlines aren't needed once the batch is packed
+        const expiry = setTimeout(() => this.forget(batch), RESULT_RETENTION_MS);
+        expiry.unref?.();
+      });
+  }
+
+  private complete(batch: Batch, result: MultiSheetResult): void {
+    const { sort, orderSheets } = splitByOrder(result.sheets, batch.owners);
+    Object.assign(batch.state, { sheets: result.sheets, sort, totalUtilization: result.totalUtilization });
+    for (const orderId of batch.state.orderIds) {
+      this.orders.get(orderId)!.sheets = orderSheets.get(orderId) || [];
+    }
+    this.setStatus(batch, 'complete');
+  }
+
+  private setStatus(batch: Batch, status: GangRunStatus): void {
+    batch.state.status = status;
+    for (const orderId of batch.state.orderIds) {
+      const order = this.orders.get(orderId)!;
+      Object.assign(order, { status, jobId: batch.state.jobId, error: batch.state.error });
+    }
+  }
+
+  private forget(batch: Batch): void {
+    batch.state.orderIds.forEach(orderId => this.orders.delete(orderId));
+    this.batches.delete(batch.state.batchId);
+  }
+}
+
+/**
+ * Orders only share sheets when they're packed with identical settings
+ */
+function settingsKey(settings: Omit<GangRunOrder, 'orderId' | 'stickers'>): string {
+  return [
+    settings.sheetWidth,
+    settings.sheetHeight,
+    settings.spacing,
+    settings.cellsPerInch,
+    settings.stepSize,
+    [...settings.rotations].sort((a, b) => a - b).join('/'),
+  ].join('|');
+}
+
+/**
+ * Split a batch's sheets into per-order cut data (original item IDs) and a per-sheet sort list
+ */
+export function splitByOrder(
+  sheets: SheetPlacement[],
+  owners: Map<string, { orderId: string; itemId: string }>
+): { sort: GangRunSortEntry[]; orderSheets: Map<string, GangRunOrderSheet[]> } {
+  const orderSheets = new Map<string, GangRunOrderSheet[]>();
+  const sort: GangRunSortEntry[] = [];
+
+  for (const sheet of sheets) {
+    const bins = new Map<string, Placement[]>();
+    for (const placement of sheet.placements) {
+      const owner = owners.get(placement.id);
+      if (!owner) continue;
+      const bin = bins.get(owner.orderId);
+      const placed = { ...placement, id: owner.itemId };
+      if (bin) bin.push(placed);
+      else bins.set(owner.orderId, [placed]);
+    }
+
+    sort.push({
+      sheetIndex: sheet.sheetIndex,
+      orders: [...bins].map(([orderId, placements]) => ({ orderId, itemIds: placements.map(p => p.id) })),
+    });
+    for (const [orderId, placements] of bins) {
+      const list = orderSheets.get(orderId);
+      const entry = { sheetIndex: sheet.sheetIndex, placements };
+      if (list) list.push(entry);
+      else orderSheets.set(orderId, [entry]);
+    }
+  }
+
+  return { sort, orderSheets };
+}
@@ -2,6 +2,18 @@ import simplify from 'simplify-js';
 import * as ClipperLib from 'clipper-lib';
 import { Point } from './image.service';
 
+/**
+ * Exact shape descriptors for a traced outline
+ * Computed once per design and carried through packing so sorting and
+ * space estimation don't fall back to bounding-box area
+ */
+export interface ShapeDescriptors {
+  area: number;      // Exact polygon area (shoelace)
+  hullArea: number;  // Area of the convex hull
+  perimeter: number; // Outline length
+  solidity: number;  // area / hullArea (1.0 = convex, lower = more concave)
+}
+
 export class GeometryService {
   private readonly CLIPPER_SCALE = 1000;
 
@@ -68,6 +80,34 @@ export class GeometryService {
     }
   }
 
+  /**
+   * Shrink a polygon inward (e.g. a hole losing its margin to the surrounding material)
+   * Returns every piece that survives; empty when the polygon vanishes
+   */
+  insetPolygon(points: Point[], insetDistance: number): Point[][] {
+    if (points.length < 3) return [];
+
+    try {
+      const co = new ClipperLib.ClipperOffset();
+      co.AddPath(
+        points.map(p => ({ X: Math.round(p.x * this.CLIPPER_SCALE), Y: Math.round(p.y * this.CLIPPER_SCALE) })),
+        ClipperLib.JoinType.jtRound,
+        ClipperLib.EndType.etClosedPolygon
+      );
+
+      const insetPaths: ClipperLib.Paths = [];
+      co.Execute(insetPaths, -insetDistance * this.CLIPPER_SCALE);
+
+      return insetPaths.map(path => path.map(p => ({
+        x: p.X / this.CLIPPER_SCALE,
+        y: p.Y / this.CLIPPER_SCALE
+      })));
+    } catch (error) {
+      console.error('Error insetting polygon:', error);
+      return [];
+    }
+  }
+
   /**
    * Rotate points around a center
    */
@@ -140,4 +180,98 @@ export class GeometryService {
       height: maxY - minY
     };
   }
+
+  /**
+   * Calculate exact polygon area using shoelace formula
+   */
+  calculateArea(points: Point[]): number {
+    if (points.length < 3) return 0;
+
+    let area = 0;
+    const n = points.length;
+
+    for (let i = 0; i < n; i++) {
+      const j = (i + 1) % n;
+      area += points[i].x * points[j].y;
+      area -= points[j].x * points[i].y;
+    }
+
+    return Math.abs(area / 2);
+  }
+
+  /**
+   * Calculate perimeter of a closed polygon
+   */
+  calculatePerimeter(points: Point[]): number {
+    if (points.length < 2) return 0;
+
+    let perimeter = 0;
+    const n = points.length;
+
+    for (let i = 0; i < n; i++) {
+      const j = (i + 1) % n;
+      perimeter += Math.hypot(points[j].x - points[i].x, points[j].y - points[i].y);
+    }
+
+    return perimeter;
+  }
+
+  /**
+   * Compute convex hull using Andrew's monotone chain algorithm
+   * Returns hull vertices in counter-clockwise order
+   */
+  getConvexHull(points: Point[]): Point[] {
+    if (points.length < 3) return [...points];
+
+    const sorted = [...points].sort((a, b) => (a.x === b.x ? a.y - b.y : a.x - b.x));
+    const cross = (o: Point, a: Point, b: Point) =>
+      (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+
+    const lower: Point[] = [];
+    for (const p of sorted) {
+      while (lower.length >= 2 && cross(lower[lower.length - 2], lower[lower.length - 1], p) <= 0) {
+        lower.pop();
+      }
+      lower.push(p);
+    }
+
+    const upper: Point[] = [];
+    for (let i = sorted.length - 1; i >= 0; i--) {
+      const p = sorted[i];
+      while (upper.length >= 2 && cross(upper[upper.length - 2], upper[upper.length - 1], p) <= 0) {
+        upper.pop();
+      }
+      upper.push(p);
+    }
+
+    // Last point of each half is the first point of the other
+    lower.pop();
+    upper.pop();
+    return lower.concat(upper);
+  }
+
+  /**
+   * Compute exact area, convex hull area, perimeter and solidity for an outline
+   */
+  getShapeDescriptors(points: Point[]): ShapeDescriptors {
+    const area = this.calculateArea(points);
+    const hullArea = this.calculateArea(this.getConvexHull(points));
+    const perimeter = this.calculatePerimeter(points);
+    const solidity = hullArea > 0 ? Math.min(1, area / hullArea) : 1;
+
+    return { area, hullArea, perimeter, solidity };
+  }
+
+  /**
+   * Rescale shape descriptors by a linear factor (e.g., mm -> inches)
+   * Areas scale quadratically, perimeter linearly, solidity is scale-invariant
+   */
+  scaleShapeDescriptors(descriptors: ShapeDescriptors, factor: number): ShapeDescriptors {
+    return {
+      area: descriptors.area * factor * factor,
+      hullArea: descriptors.hullArea * factor * factor,
+      perimeter: descriptors.perimeter * factor,
+      solidity: descriptors.solidity,
+    };
+  }
 }
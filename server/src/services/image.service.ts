@@ -1,17 +1,28 @@
 import ImageTracer from 'imagetracerjs';
 import sharp from 'sharp';
+import { OccupancyMask } from './polygon-packing.service';
 
 export interface Point {
   x: number;
   y: number;
 }
 
+/**
+ * A traced contour and the hole contours nested directly inside it
+ */
+export interface TracedContour {
+  points: Point[];
+  holes: Point[][];
+  isHole: boolean;
+}
+
 export class ImageService {
   /**
-   * Process uploaded image and extract vector path
+   * Process uploaded image and extract vector path (outer contour plus its interior holes)
    */
   async processImage(buffer: Buffer): Promise<{
     path: Point[];
+    holes: Point[][];
     width: number;
     height: number;
   }> {
@@ -48,12 +59,34 @@ export class ImageService {
     const traced = await this.traceImage(maskBuffer, width, height);
 
     return {
-      path: traced,
+      path: traced.points,
+      holes: traced.holes,
       width,
       height
     };
   }
 
+  /**
+   * Decode a remnant sheet mask image (PNG/JPEG/...) into an occupancy bitmap
+   * Dark pixels mark material that is already used; transparent pixels count as free
+   */
+  async decodeOccupancyMask(buffer: Buffer): Promise<OccupancyMask> {
+    const { data, info } = await sharp(buffer)
+      .flatten({ background: '#ffffff' })
+      .greyscale()
+      .threshold(128)
+      .raw()
+      .toBuffer({ resolveWithObject: true });
+
+    // threshold() leaves free pixels at 255 and used ones at 0; invert to one byte per pixel
+    const used = Buffer.alloc(info.width * info.height);
+    for (let i = 0; i < used.length; i++) {
+      used[i] = data[i * info.channels] === 0 ? 1 : 0;
+    }
+
+    return { width: info.width, height: info.height, data: used.toString('base64') };
+  }
+
   /**
    * Trace image buffer to vector path
    */
@@ -61,7 +94,7 @@ export class ImageService {
     buffer: Buffer,
     width: number,
     height: number
-  ): Promise<Point[]> {
+  ): Promise<TracedContour> {
     return new Promise((resolve, reject) => {
       try {
         // Convert buffer to ImageData format
@@ -86,11 +119,9 @@ export class ImageService {
           rightangleenhance: true
         });
 
-        // Extract the largest path
-        const paths = this.extractPathsFromTracedata(traced);
-        const largestPath = this.getLargestPath(paths);
-
-        resolve(largestPath);
+        // Extract the largest outline, keeping its holes
+        const contours = this.extractPathsFromTracedata(traced);
+        resolve(this.getLargestPath(contours));
       } catch (error) {
         reject(error);
       }
@@ -99,19 +130,21 @@ export class ImageService {
 
   /**
    * Extract paths from ImageTracer result
+   * ImageTracer flags hole contours (isholepath) and lists each outer contour's holes by
+   * index within the layer (holechildren)
    */
-  private extractPathsFromTracedata(tracedata: any): Point[][] {
-    const paths: Point[][] = [];
+  private extractPathsFromTracedata(tracedata: any): TracedContour[] {
+    const contours: TracedContour[] = [];
 
     if (!tracedata || !tracedata.layers) {
-      return paths;
+      return contours;
     }
 
     tracedata.layers.forEach((layer: any) => {
       if (!layer) return;
 
-      layer.forEach((pathData: any) => {
-        if (!pathData || !pathData.segments) return;
+      const layerPoints: Array<Point[] | null> = layer.map((pathData: any) => {
+        if (!pathData || !pathData.segments) return null;
 
         const points: Point[] = [];
         pathData.segments.forEach((segment: any) => {
@@ -125,33 +158,40 @@ export class ImageService {
           }
         });
 
-        if (points.length >= 3) {
-          paths.push(points);
-        }
+        return points.length >= 3 ? points : null;
+      });
+
+      layer.forEach((pathData: any, index: number) => {
+        const points = layerPoints[index];
+        if (!points) return;
+
+        const holes = ((pathData.holechildren || []) as number[])
+          .map(child => layerPoints[child])
+          .filter((hole): hole is Point[] => hole !== null && hole !== undefined);
+        contours.push({ points, holes, isHole: !!pathData.isholepath });
       });
     });
 
-    return paths;
+    return contours;
   }
 
   /**
-   * Get the largest path by area
+   * Get the largest outer contour by area, with its holes
    */
-  private getLargestPath(paths: Point[][]): Point[] {
-    if (paths.length === 0) return [];
-
-    let largestPath = paths[0];
-    let largestArea = this.calculateArea(largestPath);
+  private getLargestPath(contours: TracedContour[]): TracedContour {
+    let largest: TracedContour = { points: [], holes: [], isHole: false };
+    let largestArea = -1;
 
-    for (let i = 1; i < paths.length; i++) {
-      const area = this.calculateArea(paths[i]);
+    for (const contour of contours) {
+      if (contour.isHole) continue;
+      const area = this.calculateArea(contour.points);
       if (area > largestArea) {
         largestArea = area;
-        largestPath = paths[i];
+        largest = contour;
       }
     }
 
-    return largestPath;
+    return largest;
   }
 
   /**
@@ -0,0 +1,136 @@
+/**
+ * Job Checkpoint Service
+ * Persists multi-sheet packing jobs to a local directory so they survive a server restart
+ *
+ * Layout: <directory>/<jobId>/job.json         - job input, client socket and gang-run batch
+ *                            /checkpoint.json  - sheets packed so far + remaining items
+ *                            /owner            - process running the job (pid:start time)
+ *                            /claim.<owner>    - created exclusively by the process taking over
+ *                                                from a dead owner (one winner per dead owner)
+ *
+ * Packing is deterministic (no RNG), so completed sheets plus the remaining item
+ * IDs are enough to resume exactly where the job stopped, losing at most one sheet.
+ */
+import fs from 'fs';
+import path from 'path';
+import { PackingWorkerData, PackingCheckpoint } from '../workers/packing.worker';
+import { GangRunSnapshot } from './gang-run.service';
+
+export interface CheckpointedJob {
+  jobId: string;
+  data: PackingWorkerData;
+  socketId?: string | null;
+  checkpoint?: PackingCheckpoint;
+  gangRun?: GangRunSnapshot; // Set when the job packs a gang-run batch
+}
+
+// Identifies this process incarnation; a bare PID can repeat across restarts (e.g. PID 1 in a container)
+const OWNER_TOKEN = `${process.pid}:${Math.round(Date.now() - process.uptime() * 1000)}`;
+
+interface JobFile {
+  data: PackingWorkerData;
+  socketId?: string | null;
+  gangRun?: GangRunSnapshot;
+  createdAt: number;
+}
+
+export class JobCheckpointService {
+  constructor(private readonly directory: string) {
+    fs.mkdirSync(directory, { recursive: true });
+  }
+
+  /**
+   * Record a new job before it starts
+   */
+  createJob(jobId: string, data: PackingWorkerData, socketId?: string | null, gangRun?: GangRunSnapshot): void {
+    const jobDir = this.getJobDir(jobId);
+    fs.mkdirSync(jobDir, { recursive: true });
+    const jobFile: JobFile = { data, socketId, gangRun, createdAt: Date.now() };
+    this.writeAtomic(path.join(jobDir, 'owner'), OWNER_TOKEN);
+    this.writeAtomic(path.join(jobDir, 'job.json'), JSON.stringify(jobFile));
+  }
+
+  /**
+   * Save progress after a sheet completes (atomic replace)
+   */
+  saveCheckpoint(jobId: string, checkpoint: PackingCheckpoint): void {
+    const jobDir = this.getJobDir(jobId);
+    if (!fs.existsSync(jobDir)) return; // Job already finished
+    this.writeAtomic(path.join(jobDir, 'checkpoint.json'), JSON.stringify(checkpoint));
+  }
+
+  /**
+   * Remove a finished (completed or failed) job
+   */
+  completeJob(jobId: string): void {
+    fs.rmSync(this.getJobDir(jobId), { recursive: true, force: true });
+  }
+
+  /**
+   * Claim jobs whose owning process is gone, for this process to resume
+   */
+  claimOrphanedJobs(): CheckpointedJob[] {
+    const claimed: CheckpointedJob[] = [];
+
+    for (const jobId of fs.readdirSync(this.directory)) {
+      const jobDir = this.getJobDir(jobId);
+      if (!fs.existsSync(path.join(jobDir, 'job.json'))) continue; // Still being created
+
+      try {
+        const ownerPath = path.join(jobDir, 'owner');
+        const owner = fs.existsSync(ownerPath) ? fs.readFileSync(ownerPath, 'utf-8') : '';
+        if (isOwnerAlive(owner)) continue;
+
+        // Exclusive create: of all processes that saw the same dead owner, only one succeeds
+        if (!this.tryCreateClaim(jobDir, owner)) continue;
+        this.writeAtomic(ownerPath, OWNER_TOKEN);
+
+        const jobFile = JSON.parse(fs.readFileSync(path.join(jobDir, 'job.json'), 'utf-8')) as JobFile;
+        const checkpointPath = path.join(jobDir, 'checkpoint.json');
+        const checkpoint = fs.existsSync(checkpointPath)
+          ? (JSON.parse(fs.readFileSync(checkpointPath, 'utf-8')) as PackingCheckpoint)
+          : undefined;
+
+        claimed.push({ jobId, data: jobFile.data, socketId: jobFile.socketId, checkpoint, gangRun: jobFile.gangRun });
+      } catch (error) {
+        console.warn(`[JobCheckpoint] Discarding unreadable job ${jobId}:`, error);
+        fs.rmSync(jobDir, { recursive: true, force: true });
+      }
+    }
+
+    return claimed;
+  }
+
+  private tryCreateClaim(jobDir: string, deadOwner: string): boolean {
+    try {
+      fs.closeSync(fs.openSync(path.join(jobDir, `claim.${deadOwner.replace(/[^\w.-]/g, '_')}`), 'wx'));
+      return true;
+    } catch (error: any) {
+      if (error.code === 'EEXIST') return false;
+      throw error;
+    }
+  }
+
+  private getJobDir(jobId: string): string {
+    return path.join(this.directory, path.basename(jobId));
+  }
+
+  private writeAtomic(filePath: string, contents: string): void {
+    const tempPath = `${filePath}.${process.pid}.tmp`;
+    fs.writeFileSync(tempPath, contents);
+    fs.renameSync(tempPath, filePath);
+  }
+}
+
+function isOwnerAlive(owner: string): boolean {
+  if (owner === OWNER_TOKEN) return true;
+  const pid = parseInt(owner.split(':')[0], 10);
+  // Same PID but a different token is an earlier incarnation of this process
+  if (!Number.isFinite(pid) || pid === process.pid) return false;
+  try {
+    process.kill(pid, 0);
+    return true;
+  } catch (error: any) {
+    return error.code === 'EPERM';
+  }
+}
@@ -0,0 +1,42 @@
+/**
+ * Job Events Service
+ * In-process pub/sub of finalized packing output, keyed by job ID
+ * Lets HTTP streaming endpoints follow a job without going through Socket.IO
+ */
+import { EventEmitter } from 'events';
+import { SheetPlacement } from './nesting.service';
+
+export type JobStreamEvent =
+  | { type: 'sheet'; sheet: SheetPlacement }
+  | { type: 'complete'; summary: any }
+  | { type: 'error'; error: string };
+
+export class JobEventsService {
+  private emitter = new EventEmitter();
+
+  constructor() {
+    // One listener per open stream; many clients may follow busy jobs
+    this.emitter.setMaxListeners(0);
+  }
+
+  publish(jobId: string, event: JobStreamEvent): void {
+    this.emitter.emit(jobId, event);
+  }
+
+  /**
+   * Listen for a job's events; returns an unsubscribe function
+   */
+  subscribe(jobId: string, listener: (event: JobStreamEvent) => void): () => void {
+    this.emitter.on(jobId, listener);
+    return () => this.emitter.off(jobId, listener);
+  }
+}
+
+/**
+ * Split a multi-sheet result into its summary (everything but the sheets)
+ */
+export function summarizeResult(result: any): any {
+  if (!result || !Array.isArray(result.sheets)) return result;
+  const { sheets, ...summary } = result;
+  return { ...summary, sheetCount: sheets.length };
+}
@@ -0,0 +1,263 @@
+/**
+ * Job Scheduler Service
+ * Admission control and shortest-expected-job-first scheduling in front of the worker pool
+ *
+ * - Each job's cost is estimated as items × rotations × grid cells, converted to
+ *   seconds by a runtime model that is recalibrated from completed jobs
+ * - Interactive jobs (single-sheet previews, cheap jobs) and batch jobs
+ *   (production runs) queue separately; batch jobs can't take the last slot
+ * - Within a queue the shortest expected job runs first, with aging so long
+ *   jobs can't starve
+ * - New jobs are rejected (HTTP 429) when queued work exceeds a cost budget
+ */
+import os from 'os';
+import { WorkerManagerService, WorkerJobOptions } from './worker-manager.service';
+import { PackingWorkerData } from '../workers/packing.worker';
+
+export type JobQueue = 'interactive' | 'batch';
+
+export interface JobCostEstimate {
+  costUnits: number;       // items × rotations × grid cells
+  expectedSeconds: number; // costUnits × calibrated seconds per unit
+  queue: JobQueue;
+}
+
+export interface AdmissionResult {
+  accepted: boolean;
+  queue: JobQueue;
+  expectedSeconds: number;
+  position?: number;          // Position in its queue (0 = starting now)
+  retryAfterSeconds?: number; // Set when rejected
+}
+
+export interface JobSchedulerOptions {
+  maxConcurrent: number;           // Worker slots
+  queueBudgetSeconds: number;      // Max expected seconds of queued (not running) work
+  interactiveMaxSeconds: number;   // Jobs expected to finish faster than this are interactive
+  agingRate: number;               // Seconds of priority gained per second waited
+}
+
+interface QueuedJob {
+  jobId: string;
+  data: PackingWorkerData;
+  options: WorkerJobOptions;
+  estimate: JobCostEstimate;
+  enqueuedAt: number;
+}
+
+// Baseline from RotationConfigService: ~200ms per item with the 90° preset
+// (4 rotations, 100 cells/inch) on a letter sheet
+const BASELINE_SECONDS_PER_UNIT = 0.2 / (4 * 850 * 1100);
+const RUNTIME_MODEL_SMOOTHING = 0.2; // EWMA weight of each completed job
+const MM_PER_INCH = 25.4;
+
+export class JobSchedulerService {
+  private readonly options: JobSchedulerOptions;
+  private readonly queues: Record<JobQueue, QueuedJob[]> = { interactive: [], batch: [] };
+  private readonly running = new Map<string, { queue: JobQueue; slots: number }>();
+  private secondsPerUnit = BASELINE_SECONDS_PER_UNIT;
+
+  constructor(
+    private readonly workerManager: WorkerManagerService,
+    options: Partial<JobSchedulerOptions> = {}
+  ) {
+    this.options = {
+      maxConcurrent: options.maxConcurrent ?? Math.max(1, os.cpus().length - 1),
+      queueBudgetSeconds: options.queueBudgetSeconds ?? 30 * 60,
+      interactiveMaxSeconds: options.interactiveMaxSeconds ?? 10,
+      agingRate: options.agingRate ?? 1,
+    };
+  }
+
+  /**
+   * Estimate job cost from items × rotations × grid area (cells)
+   */
+  estimateCost(data: PackingWorkerData): JobCostEstimate {
+    const gridCells =
+      Math.ceil((data.sheetWidth / MM_PER_INCH) * data.cellsPerInch) *
+      Math.ceil((data.sheetHeight / MM_PER_INCH) * data.cellsPerInch);
+    // Multi-stock jobs pack every candidate stock for each sheet; beam search extends every kept branch
+    const candidates = Math.max(1, data.stocks?.length ?? 0) * Math.max(1, data.beamWidth ?? 1);
+    const costUnits = data.stickers.length * Math.max(1, data.rotations.length) * gridCells * candidates;
+    const expectedSeconds = costUnits * this.secondsPerUnit;
+
+    const queue: JobQueue =
+      data.type === 'single-sheet' || expectedSeconds <= this.options.interactiveMaxSeconds
+        ? 'interactive'
+        : 'batch';
+
+    return { costUnits, expectedSeconds, queue };
+  }
+
+  /**
+   * Admit a job (or reject it when the queue is over budget) and schedule it
+   * force skips the budget check (e.g. jobs resumed after a restart were already admitted)
+   */
+  submit(
+    jobId: string,
+    data: PackingWorkerData,
+    options: WorkerJobOptions = {},
+    { force = false }: { force?: boolean } = {}
+  ): AdmissionResult {
+    const estimate = this.estimateCost(data);
+    const queuedSeconds = this.getQueuedSeconds();
+
+    // Admission control: only reject when the job would actually have to wait
+    if (!force && !this.hasFreeSlot(estimate.queue) && queuedSeconds + estimate.expectedSeconds > this.options.queueBudgetSeconds) {
+      const retryAfterSeconds = Math.max(1, Math.ceil(queuedSeconds / this.options.maxConcurrent));
+      console.log(`[JobScheduler] Rejected job ${jobId}: queue at ${queuedSeconds.toFixed(0)}s of ${this.options.queueBudgetSeconds}s budget`);
+      return {
+        accepted: false,
+        queue: estimate.queue,
+        expectedSeconds: estimate.expectedSeconds,
+        retryAfterSeconds,
+      };
+    }
+
+    this.queues[estimate.queue].push({ jobId, data, options, estimate, enqueuedAt: Date.now() });
+    console.log(`[JobScheduler] Queued job ${jobId} (${estimate.queue}, ~${estimate.expectedSeconds.toFixed(1)}s expected)`);
+
+    this.dispatch();
+
+    const position = this.queues[estimate.queue].findIndex(job => job.jobId === jobId);
+    if (position >= 0) {
+      options.onProgress?.({
+        type: 'progress',
+        message: `Queued (position ${position + 1} in ${estimate.queue} queue)`,
+        percentComplete: 0,
+      });
+    }
+
+    return {
+      accepted: true,
+      queue: estimate.queue,
+      expectedSeconds: estimate.expectedSeconds,
+      position: position >= 0 ? position + 1 : 0,
+    };
+  }
+
+  /**
+   * Get scheduler statistics
+   */
+  getStats(): {
+    running: number;
+    queuedInteractive: number;
+    queuedBatch: number;
+    queuedSeconds: number;
+    secondsPerUnit: number;
+  } {
+    return {
+      running: this.running.size,
+      queuedInteractive: this.queues.interactive.length,
+      queuedBatch: this.queues.batch.length,
+      queuedSeconds: this.getQueuedSeconds(),
+      secondsPerUnit: this.secondsPerUnit,
+    };
+  }
+
+  /**
+   * Drop all queued (not yet started) jobs
+   */
+  clearQueue(): void {
+    this.queues.interactive = [];
+    this.queues.batch = [];
+  }
+
+  /**
+   * Start queued jobs while slots are free
+   */
+  private dispatch(): void {
+    while (this.usedSlots() < this.options.maxConcurrent) {
+      const next = this.takeNext();
+      if (!next) return;
+      this.start(next);
+    }
+  }
+
+  /**
+   * Pick the next job: interactive first, then batch if it may use a slot
+   * Within a queue, shortest expected job first with aging
+   */
+  private takeNext(): QueuedJob | undefined {
+    for (const queue of ['interactive', 'batch'] as JobQueue[]) {
+      if (this.queues[queue].length === 0 || !this.hasFreeSlot(queue)) continue;
+
+      const now = Date.now();
+      let bestIndex = 0;
+      let bestPriority = Infinity;
+      this.queues[queue].forEach((job, index) => {
+        const waitedSeconds = (now - job.enqueuedAt) / 1000;
+        const priority = job.estimate.expectedSeconds - waitedSeconds * this.options.agingRate;
+        if (priority < bestPriority) {
+          bestPriority = priority;
+          bestIndex = index;
+        }
+      });
+
+      return this.queues[queue].splice(bestIndex, 1)[0];
+    }
+    return undefined;
+  }
+
+  /**
+   * Whether a job from this queue could start right now
+   * Batch jobs leave one slot free for interactive work when there's more than one slot
+   */
+  private hasFreeSlot(queue: JobQueue): boolean {
+    if (this.usedSlots() >= this.options.maxConcurrent) return false;
+    if (queue === 'interactive') return true;
+
+    const batchRunning = Array.from(this.running.values()).filter(job => job.queue === 'batch').length;
+    const batchSlots = this.options.maxConcurrent > 1 ? this.options.maxConcurrent - 1 : 1;
+    return batchRunning < batchSlots;
+  }
+
+  /**
+   * Worker slots held by running jobs (concurrent placement jobs hold one per thread)
+   */
+  private usedSlots(): number {
+    let slots = 0;
+    this.running.forEach(job => (slots += job.slots));
+    return slots;
+  }
+
+  private start(job: QueuedJob): void {
+    const startedAt = Date.now();
+    // Grant concurrent placement only the threads that are free right now
+    const requested = Math.max(1, job.data.placementWorkers ?? 1);
+    const slots = Math.max(1, Math.min(requested, this.options.maxConcurrent - this.usedSlots()));
+    const data = slots === requested ? job.data : { ...job.data, placementWorkers: slots };
+    this.running.set(job.jobId, { queue: job.estimate.queue, slots });
+    console.log(
+      `[JobScheduler] Starting job ${job.jobId} (${job.estimate.queue}, waited ${((startedAt - job.enqueuedAt) / 1000).toFixed(1)}s` +
+      `${slots > 1 ? `, ${slots} threads` : ''})`
+    );
+
+    this.workerManager
+      .executePackingJob(job.jobId, data, job.options)
+      .then(() => this.recordRuntime(job.estimate, (Date.now() - startedAt) / 1000))
+      .catch(error => {
+        console.error(`[JobScheduler] Job ${job.jobId} failed:`, error);
+      })
+      .finally(() => {
+        this.running.delete(job.jobId);
+        this.dispatch();
+      });
+  }
+
+  /**
+   * Recalibrate the runtime model from a completed job (EWMA of seconds per cost unit)
+   */
+  private recordRuntime(estimate: JobCostEstimate, actualSeconds: number): void {
+    if (estimate.costUnits <= 0 || actualSeconds <= 0) return;
+    const observed = actualSeconds / estimate.costUnits;
+    this.secondsPerUnit = (1 - RUNTIME_MODEL_SMOOTHING) * this.secondsPerUnit + RUNTIME_MODEL_SMOOTHING * observed;
+  }
+
+  private getQueuedSeconds(): number {
+    return [...this.queues.interactive, ...this.queues.batch].reduce(
+      (sum, job) => sum + job.estimate.expectedSeconds,
+      0
+    );
+  }
+}
@@ -0,0 +1,130 @@
+/**
+ * Job Store Service
+ * Registry of packing job status that any server process can query
+ *
+ * - MemoryJobStore: in-process map (single-process mode, and the primary in cluster mode)
+ * - ClusterJobStore: forwards updates and lookups to the cluster primary over IPC
+ */
+import { SheetPlacement } from './nesting.service';
+
+export type JobStatus = 'queued' | 'running' | 'complete' | 'error';
+
+export interface JobRecord {
+  jobId: string;
+  status: JobStatus;
+  pid: number;               // Process that owns the job
+  socketId?: string | null;  // Socket.IO client to notify
+  message?: string;          // Latest progress message
+  percentComplete?: number;
+  sheets?: SheetPlacement[]; // Finalized sheets so far (multi-sheet jobs)
+  result?: any;              // Set when complete
+  error?: string;            // Set when failed
+  createdAt: number;
+  updatedAt: number;
+}
+
+export interface JobStore {
+  update(jobId: string, patch: Partial<JobRecord>): void;
+  get(jobId: string): Promise<JobRecord | undefined>;
+}
+
+// IPC messages exchanged with the cluster primary
+export interface JobStoreUpdateMessage {
+  type: 'jobs:update';
+  jobId: string;
+  patch: Partial<JobRecord>;
+}
+
+export interface JobStoreGetMessage {
+  type: 'jobs:get';
+  requestId: number;
+  jobId: string;
+}
+
+export interface JobStoreReplyMessage {
+  type: 'jobs:reply';
+  requestId: number;
+  record?: JobRecord;
+}
+
+const DEFAULT_TTL_MS = 60 * 60 * 1000; // Keep finished jobs for an hour
+const IPC_TIMEOUT_MS = 5000;
+
+export class MemoryJobStore implements JobStore {
+  private records = new Map<string, JobRecord>();
+
+  constructor(private readonly ttlMs: number = DEFAULT_TTL_MS) {}
+
+  update(jobId: string, patch: Partial<JobRecord>): void {
+    const now = Date.now();
+    const existing = this.records.get(jobId);
+    this.records.set(jobId, {
+      status: 'queued',
+      pid: process.pid,
+      createdAt: now,
+      ...existing,
+      ...patch,
+      jobId,
+      updatedAt: now,
+    });
+    this.prune(now);
+  }
+
+  async get(jobId: string): Promise<JobRecord | undefined> {
+    return this.getSync(jobId);
+  }
+
+  getSync(jobId: string): JobRecord | undefined {
+    this.prune(Date.now());
+    return this.records.get(jobId);
+  }
+
+  /**
+   * Drop finished jobs older than the TTL
+   */
+  private prune(now: number): void {
+    for (const [jobId, record] of this.records) {
+      const finished = record.status === 'complete' || record.status === 'error';
+      if (finished && now - record.updatedAt > this.ttlMs) {
+        this.records.delete(jobId);
+      }
+    }
+  }
+}
+
+export class ClusterJobStore implements JobStore {
+  private nextRequestId = 1;
+  private pending = new Map<number, (record: JobRecord | undefined) => void>();
+
+  constructor() {
+    process.on('message', (message: any) => {
+      if (message?.type !== 'jobs:reply') return;
+      const reply = message as JobStoreReplyMessage;
+      this.pending.get(reply.requestId)?.(reply.record);
+      this.pending.delete(reply.requestId);
+    });
+  }
+
+  update(jobId: string, patch: Partial<JobRecord>): void {
+    const message: JobStoreUpdateMessage = { type: 'jobs:update', jobId, patch: { pid: process.pid, ...patch } };
+    process.send?.(message);
+  }
+
+  get(jobId: string): Promise<JobRecord | undefined> {
+    return new Promise(resolve => {
+      const requestId = this.nextRequestId++;
+      const timeout = setTimeout(() => {
+        this.pending.delete(requestId);
+        resolve(undefined);
+      }, IPC_TIMEOUT_MS);
+
+      this.pending.set(requestId, record => {
+        clearTimeout(timeout);
+        resolve(record);
+      });
+
+      const message: JobStoreGetMessage = { type: 'jobs:get', requestId, jobId };
+      process.send?.(message);
+    });
+  }
+}
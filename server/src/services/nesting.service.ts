@@ -5,15 +5,29 @@ import {
   PackablePolygon,
   PolygonPlacement,
   PolygonPackingResult,
+  SheetObstacles,
+  SheetStock,
+  ShapeCache,
   estimateSpaceRequirements,
+  packNextStockSheet,
+  toPackablePolygon,
+  toObstaclesInches,
 } from './polygon-packing.service';
-import { GeometryService } from './geometry.service';
+import { ShapeDescriptors } from './geometry.service';
+import {
+  PageCountPredictor,
+  extractPackingFeatures,
+  efficiencyFromSheets,
+} from './page-count-predictor.service';
+import { designHashOf } from './sheet-template-cache.service';
 
 export interface Sticker {
   id: string;
   points: Point[];
+  holes?: Point[][]; // Interior holes of the outline (mm); polygon packing nests smaller items in them
   width: number;
   height: number;
+  descriptors?: ShapeDescriptors; // Exact area/hull/perimeter/solidity from trace time (mm units)
 }
 
 export interface Placement {
@@ -33,6 +47,16 @@ export interface SheetPlacement {
   sheetIndex: number;
   placements: Placement[];
   utilization: number;
+  stock?: SheetStock; // Sheet size (mm) when the job mixes stock sizes
+  copyOf?: number;    // Repeats the layout of this earlier sheet (same designs, same positions)
+}
+
+/**
+ * A distinct sheet layout and how many sheets of the run print it (itself included)
+ */
+export interface SheetCopies {
+  sheetIndex: number;
+  copies: number;
 }
 
 export interface MultiSheetResult {
@@ -40,9 +64,34 @@ export interface MultiSheetResult {
   totalUtilization: number;
   quantities: { [stickerId: string]: number };
   message?: string; // Optional informational message (e.g., when fewer sheets filled than requested)
+  copies?: SheetCopies[]; // Set when some sheets repeat an earlier layout
+}
+
+/**
+ * Edit applied to a previous single-sheet layout (sticker IDs)
+ * Stickers missing from the previous layout count as added; layout entries missing
+ * from the sticker list count as removed
+ */
+export interface LayoutChanges {
+  added?: string[];
+  removed?: string[];
+  resized?: string[];
+}
+
+export interface IncrementalNestingResult extends NestingResult {
+  kept: string[];         // Placements carried over unchanged
+  repacked: string[];     // Placements found by search
+  unplaced: string[];
+  quality: number;        // New layout density relative to the previous one (1 = as dense)
 }
 
 export class NestingService {
+  /**
+   * @param pageCountPredictor Predictor for auto-expand, refined online from completed jobs
+   *                           (the server passes its shared instance, see app.locals)
+   */
+  constructor(private readonly pageCountPredictor: PageCountPredictor = new PageCountPredictor()) {}
+
   /**
    * Nest stickers across multiple sheets using MaxRects algorithm with Oversubscribe and Sort strategy
    * Generates a balanced candidate pool by cycling through all stickers until reaching 115% of target area
@@ -513,7 +562,8 @@ export class NestingService {
     spacing: number = 0.0625,
     cellsPerInch: number = 100,
     stepSize: number = 0.05,
-    rotations: number[] = [0, 90, 180, 270]
+    rotations: number[] = [0, 90, 180, 270],
+    remnant?: SheetObstacles // Used regions of a partially cut sheet (mm)
   ): Promise<NestingResult> {
     console.log(`Polygon packing (single sheet): ${stickers.length} stickers`);
 
@@ -526,30 +576,14 @@ export class NestingService {
 
     console.log(`Sheet: ${sheetWidth.toFixed(1)}mm × ${sheetHeight.toFixed(1)}mm = ${sheetWidthInches.toFixed(1)}" × ${sheetHeightInches.toFixed(1)}"`);
 
-    // Convert stickers to packable polygons (convert dimensions to inches)
-    const geometryService = new GeometryService();
-    const polygons: PackablePolygon[] = stickers.map(sticker => {
-      const widthInches = sticker.width / MM_PER_INCH;
-      const heightInches = sticker.height / MM_PER_INCH;
-      const area = widthInches * heightInches;
-
-      // Convert polygon points from mm to inches
-      const pointsInches = sticker.points.map(p => ({
-        x: p.x / MM_PER_INCH,
-        y: p.y / MM_PER_INCH,
-      }));
-
-      return {
-        id: sticker.id,
-        points: pointsInches,
-        width: widthInches,
-        height: heightInches,
-        area,
-      };
-    });
+    // Convert stickers to packable polygons (convert dimensions to inches, exact areas)
+    const polygons: PackablePolygon[] = stickers.map(sticker => toPackablePolygon(sticker, MM_PER_INCH));
 
     // Create packer and pack polygons (all dimensions now in inches)
     const packer = new PolygonPacker(sheetWidthInches, sheetHeightInches, spacingInches, cellsPerInch, stepSize, rotations);
+    if (remnant) {
+      packer.addObstacles(toObstaclesInches(remnant, MM_PER_INCH));
+    }
     const result = await packer.pack(polygons);
 
     // Convert polygon placements to standard placements (convert positions back to mm for consistency)
@@ -575,6 +609,68 @@ export class NestingService {
     };
   }
 
+  /**
+   * Re-nest a single sheet after a small edit, reusing the previous polygon layout
+   * Only resized/added stickers and the neighbours they displace are searched for
+   */
+  async renestStickersPolygon(
+    stickers: Sticker[],
+    previous: Placement[],
+    changes: LayoutChanges,
+    sheetWidth: number,
+    sheetHeight: number,
+    spacing: number = 0.0625,
+    cellsPerInch: number = 100,
+    stepSize: number = 0.05,
+    rotations: number[] = [0, 90, 180, 270]
+  ): Promise<IncrementalNestingResult> {
+    const MM_PER_INCH = 25.4;
+    const removed = new Set(changes.removed || []);
+    const changedIds = [...(changes.resized || []), ...(changes.added || [])];
+
+    const polygons: PackablePolygon[] = stickers
+      .filter(sticker => !removed.has(sticker.id))
+      .map(sticker => toPackablePolygon(sticker, MM_PER_INCH));
+
+    const packer = new PolygonPacker(
+      sheetWidth / MM_PER_INCH,
+      sheetHeight / MM_PER_INCH,
+      spacing / MM_PER_INCH,
+      cellsPerInch,
+      stepSize,
+      rotations
+    );
+    const result = await packer.packIncremental(
+      polygons,
+      previous
+        .filter(p => !removed.has(p.id))
+        .map(p => ({ id: p.id, x: p.x / MM_PER_INCH, y: p.y / MM_PER_INCH, rotation: p.rotation })),
+      changedIds
+    );
+
+    const placements: Placement[] = result.placements.map(p => ({
+      id: p.id,
+      x: p.x * MM_PER_INCH,
+      y: p.y * MM_PER_INCH,
+      rotation: p.rotation,
+    }));
+
+    const fitness = result.placements.reduce((sum, p) => {
+      const sticker = stickers.find(s => s.id === p.id);
+      return sum + (sticker ? sticker.width * sticker.height : 0);
+    }, 0);
+
+    return {
+      placements,
+      utilization: result.utilization,
+      fitness,
+      kept: result.keptIds,
+      repacked: result.repackedIds,
+      unplaced: result.unplacedPolygons.map(p => p.id),
+      quality: result.previousDensity > 0 ? result.density / result.previousDensity : 1,
+    };
+  }
+
   /**
    * Nest stickers across multiple sheets using POLYGON packing with Oversubscribe and Sort strategy
    * Uses actual polygon shapes instead of bounding rectangles
@@ -592,7 +688,8 @@ export class NestingService {
     cellsPerInch: number = 100,
     stepSize: number = 0.05,
     rotations: number[] = [0, 90, 180, 270],
-    packAllItems: boolean = true // TRUE = auto-expand (production), FALSE = fixed pages
+    packAllItems: boolean = true, // TRUE = auto-expand (production), FALSE = fixed pages
+    remnants: Array<SheetObstacles | null> = [] // Used regions per sheet (mm); null or past the list = fresh stock
   ): Promise<MultiSheetResult> {
     const mode = packAllItems ? 'PACK ALL ITEMS (auto-expand)' : 'FIXED PAGES';
     console.log(`\n╔══════════════════════════════════════════════════════════════╗`);
@@ -621,27 +718,8 @@ export class NestingService {
 
     console.log(`Sheet: ${sheetWidth.toFixed(1)}mm × ${sheetHeight.toFixed(1)}mm = ${sheetWidthInches.toFixed(1)}" × ${sheetHeightInches.toFixed(1)}"`);
 
-    // Convert stickers to packable polygons (all unique items to be packed)
-    const geometryService = new GeometryService();
-    const polygons: PackablePolygon[] = stickers.map(sticker => {
-      const widthInches = sticker.width / MM_PER_INCH;
-      const heightInches = sticker.height / MM_PER_INCH;
-      const areaInches = widthInches * heightInches;
-
-      // Convert polygon points from mm to inches
-      const pointsInches = sticker.points.map(p => ({
-        x: p.x / MM_PER_INCH,
-        y: p.y / MM_PER_INCH,
-      }));
-
-      return {
-        id: sticker.id,
-        points: pointsInches,
-        width: widthInches,
-        height: heightInches,
-        area: areaInches,
-      };
-    });
+    // Convert stickers to packable polygons (all unique items to be packed, exact areas)
+    const polygons: PackablePolygon[] = stickers.map(sticker => toPackablePolygon(sticker, MM_PER_INCH));
 
     // EARLY SPACE ESTIMATION - Fail fast if fixed mode with insufficient pages
     const estimate = estimateSpaceRequirements(
@@ -656,7 +734,12 @@ export class NestingService {
     console.log(`   Total item area: ${estimate.totalItemArea.toFixed(2)} sq in`);
     console.log(`   Total sheet area: ${estimate.totalSheetArea.toFixed(2)} sq in (${pageCount} pages)`);
     console.log(`   Estimated utilization: ${(estimate.estimatedUtilization * 100).toFixed(1)}%`);
-    console.log(`   Minimum pages needed: ~${estimate.minimumPagesNeeded}\n`);
+    console.log(`   Minimum pages needed: ~${estimate.minimumPagesNeeded}`);
+
+    // Predict page-count distribution from shape/sheet/preset features
+    const features = extractPackingFeatures(polygons, sheetWidthInches, sheetHeightInches, rotations.length);
+    const prediction = this.pageCountPredictor.predict(features);
+    console.log(`   Predicted pages: ${prediction.median} (p10 ${prediction.lowerBound}, p90 ${prediction.upperBound})\n`);
 
     // FAIL FAST for fixed-pages mode
     if (!packAllItems) {
@@ -672,10 +755,12 @@ export class NestingService {
     }
 
     // Determine starting page count
+    // Start at the 90th percentile: unused sheets are never opened, so over-predicting is cheap
+    // while under-predicting costs a full repack attempt
     let currentPageCount = pageCount;
-    if (packAllItems && estimate.minimumPagesNeeded > pageCount) {
-      currentPageCount = estimate.minimumPagesNeeded;
-      console.log(`📈 Auto-expanding from ${pageCount} to ${currentPageCount} pages based on estimate\n`);
+    if (packAllItems && prediction.upperBound > pageCount) {
+      currentPageCount = prediction.upperBound;
+      console.log(`📈 Auto-expanding from ${pageCount} to ${currentPageCount} pages based on prediction\n`);
     }
 
     const MAX_PAGES = 100; // Safety limit for auto-expand
@@ -684,26 +769,56 @@ export class NestingService {
     let finalQuantities: { [stickerId: string]: number } = {};
     let attempts = 0;
 
-    // PACKING LOOP - For pack-all mode, retry with more pages if needed
+    // Sheets persist across attempts: each sheet is packed deterministically from the
+    // items left by earlier sheets, so expanding the page budget resumes after the last
+    // packed sheet instead of repacking identical ones (minimal page count in one pass)
+    const sheets: SheetPlacement[] = [];
+    let remainingPolygons = [...polygons];
+    let stalled = false; // A fresh sheet placed nothing - remaining items can never fit
+    const shapeCache = new ShapeCache(); // Outlines are shared by every sheet's packer
+    const designKeys = designKeysOf(stickers);
+    const templates: SheetTemplate[] = []; // Fresh-stock sheets that later sheets may repeat
+
+    // PACKING LOOP - For pack-all mode, extend with more pages if needed
     while (!allItemsPlaced && currentPageCount <= MAX_PAGES) {
       attempts++;
       console.log(`\n${'='.repeat(60)}`);
       console.log(`Packing attempt #${attempts} with ${currentPageCount} pages...`);
       console.log(`${'='.repeat(60)}\n`);
 
-      const sheets: SheetPlacement[] = [];
-      let remainingPolygons = [...polygons];
-
-      // Pack each sheet
-      for (let sheetIndex = 0; sheetIndex < currentPageCount && remainingPolygons.length > 0; sheetIndex++) {
+      // Pack each sheet (resuming after sheets packed by earlier attempts)
+      for (let sheetIndex = sheets.length; sheetIndex < currentPageCount && remainingPolygons.length > 0; sheetIndex++) {
         console.log(`\n📄 Sheet ${sheetIndex + 1}/${currentPageCount}:`);
+        const remnant = remnants[sheetIndex];
+
+        // Remaining items that still hold an earlier sheet's design mix repeat its layout
+        const repeat = remnant ? null : repeatPackedSheet(templates, remainingPolygons.map(p => p.id), designKeys);
+        if (repeat) {
+          sheets.push({
+            sheetIndex,
+            placements: repeat.placements,
+            utilization: repeat.template.utilization,
+            copyOf: repeat.template.sheetIndex,
+          });
+          console.log(`   ✓ Repeated sheet ${repeat.template.sheetIndex + 1} (${repeat.placements.length} items)`);
+          const placedIds = new Set(repeat.placements.map(p => p.id));
+          remainingPolygons = remainingPolygons.filter(p => !placedIds.has(p.id));
+          continue;
+        }
 
         // Create packer for this sheet
-        const packer = new PolygonPacker(sheetWidthInches, sheetHeightInches, spacingInches, cellsPerInch, stepSize, rotations);
+        const packer = new PolygonPacker(
+          sheetWidthInches, sheetHeightInches, spacingInches, cellsPerInch, stepSize, rotations, undefined, shapeCache
+        );
+        if (remnant) {
+          packer.addObstacles(toObstaclesInches(remnant, MM_PER_INCH));
+        }
         const result = await packer.pack(remainingPolygons);
 
-        if (result.placements.length === 0) {
+        // A remnant with too little left keeps its (empty) slot and packing moves on to the next sheet
+        if (result.placements.length === 0 && !remnant) {
           console.log(`   No items placed on this sheet (all remaining items too large or no space)`);
+          stalled = true;
           break; // No point continuing to more sheets
         }
 
@@ -728,6 +843,9 @@ export class NestingService {
           placements,
           utilization,
         });
+        if (!remnant) {
+          templates.push({ sheet: sheets[sheets.length - 1], designs: new Set(remainingPolygons.map(p => designKeys.get(p.id)!)) });
+        }
 
         console.log(`   ✓ Placed ${placements.length} items (${utilization.toFixed(1)}% utilization)`);
 
@@ -754,6 +872,10 @@ export class NestingService {
         console.log(`\n⚠️  ${remainingPolygons.length} items remaining unpacked`);
 
         if (packAllItems) {
+          if (stalled) {
+            throw new Error(`Failed to pack all items: ${remainingPolygons.length} items don't fit on an empty sheet. Items may be too large or incompatible shapes.`);
+          }
+
           // AUTO-EXPAND: Add another page
           currentPageCount++;
           console.log(`📈 Auto-expanding to ${currentPageCount} pages for remaining items...\n`);
@@ -789,21 +911,232 @@ export class NestingService {
     console.log(`Total utilization: ${totalUtilization.toFixed(1)}%`);
     console.log(`${'='.repeat(60)}\n`);
 
+    // Online training: feed achieved efficiency back into the predictor
+    // Remnant jobs don't say how full a fresh sheet gets, so they don't train the predictor
+    const efficiency = efficiencyFromSheets(finalSheets.map(s => s.utilization), allItemsPlaced);
+    if (efficiency !== null && remnants.length === 0) {
+      this.pageCountPredictor.recordCompletedJob({ features, efficiency });
+    }
+
     // Generate message
     let message: string | undefined;
     const totalItemsPlaced = Object.values(finalQuantities).reduce((a, b) => a + b, 0);
-    if (packAllItems && currentPageCount > pageCount) {
-      message = `Auto-expanded from ${pageCount} to ${currentPageCount} pages to fit all ${stickers.length} items`;
+    if (packAllItems && finalSheets.length > pageCount) {
+      message = `Auto-expanded from ${pageCount} to ${finalSheets.length} pages to fit all ${stickers.length} items`;
     } else if (!packAllItems && totalItemsPlaced < stickers.length) {
       const unplaced = stickers.length - totalItemsPlaced;
       message = `${totalItemsPlaced}/${stickers.length} items packed. ${unplaced} items did not fit. Increase page count.`;
     }
 
+    const copies = groupSheetCopies(finalSheets);
+    if (copies) {
+      const summary = `Print run: ${describeSheetCopies(copies)}`;
+      message = message ? `${message}. ${summary}` : summary;
+    }
+
     return {
       sheets: finalSheets,
       totalUtilization,
       quantities: finalQuantities,
       message,
+      copies,
     };
   }
+
+  /**
+   * Nest stickers across a mix of stock sizes using POLYGON packing
+   * Each sheet opens whichever stock packs the remaining items with the least waste
+   * (see packNextStockSheet); all items are packed, shape outlines are shared across stocks
+   */
+  async nestStickersMultiStockPolygon(
+    stickers: Sticker[],
+    stocks: SheetStock[],
+    spacing: number = 0.0625,
+    cellsPerInch: number = 100,
+    stepSize: number = 0.05,
+    rotations: number[] = [0, 90, 180, 270]
+  ): Promise<MultiSheetResult> {
+    const MM_PER_INCH = 25.4;
+    const stocksInches = stocks.map(stock => ({ ...stock, width: stock.width / MM_PER_INCH, height: stock.height / MM_PER_INCH }));
+    const polygons: PackablePolygon[] = stickers.map(sticker => toPackablePolygon(sticker, MM_PER_INCH));
+    const shapeCache = new ShapeCache();
+
+    console.log(`Polygon packing (multi-stock): ${stickers.length} stickers, stocks ${stocks.map(s => s.id).join(', ')}`);
+
+    const sheets: SheetPlacement[] = [];
+    let remainingPolygons = polygons;
+    while (remainingPolygons.length > 0) {
+      const next = await packNextStockSheet(
+        remainingPolygons, stocksInches, spacing / MM_PER_INCH, cellsPerInch, stepSize, rotations, shapeCache
+      );
+      if (!next) {
+        throw new Error(`Failed to pack all items: ${remainingPolygons.length} items don't fit on any stock size`);
+      }
+
+      const stock = stocks.find(s => s.id === next.stock.id)!;
+      const placedIds = new Set(next.result.placements.map(p => p.id));
+      const usedArea = remainingPolygons.filter(p => placedIds.has(p.id)).reduce((sum, p) => sum + p.area, 0);
+      sheets.push({
+        sheetIndex: sheets.length,
+        placements: next.result.placements.map(p => ({
+          id: p.id,
+          x: p.x * MM_PER_INCH,
+          y: p.y * MM_PER_INCH,
+          rotation: p.rotation,
+        })),
+        utilization: (usedArea / (next.stock.width * next.stock.height)) * 100,
+        stock,
+      });
+      console.log(`   ✓ Sheet ${sheets.length} on ${stock.id}: ${placedIds.size} items`);
+
+      remainingPolygons = next.result.unplacedPolygons;
+    }
+
+    return summarizeStockSheets(sheets, polygons);
+  }
+}
+
+/**
+ * Quantities and area-weighted utilization for sheets of mixed stock sizes
+ */
+export function summarizeStockSheets(sheets: SheetPlacement[], polygons: PackablePolygon[]): MultiSheetResult {
+  const MM_PER_INCH = 25.4;
+  const quantities: { [stickerId: string]: number } = {};
+  let usedArea = 0;
+  let stockArea = 0;
+
+  for (const sheet of sheets) {
+    for (const placement of sheet.placements) {
+      quantities[placement.id] = (quantities[placement.id] || 0) + 1;
+      usedArea += polygons.find(p => p.id === placement.id)?.area ?? 0;
+    }
+    if (sheet.stock) {
+      stockArea += (sheet.stock.width / MM_PER_INCH) * (sheet.stock.height / MM_PER_INCH);
+    }
+  }
+
+  const stockCounts = new Map<string, number>();
+  sheets.forEach(sheet => sheet.stock && stockCounts.set(sheet.stock.id, (stockCounts.get(sheet.stock.id) || 0) + 1));
+
+  return {
+    sheets,
+    totalUtilization: stockArea > 0 ? (usedArea / stockArea) * 100 : 0,
+    quantities,
+    message: `Used ${[...stockCounts].map(([id, count]) => `${count}× ${id}`).join(', ')}`,
+  };
+}
+
+/**
+ * Design an item belongs to: instances of one design share its outline and artwork
+ * - Artwork: the ID the PDF resolves the image by (instance IDs are `${designId}_${n}`)
+ * - Outline: content hash of the points and holes (designHashOf), so items whose IDs merely
+ *   look alike never share a key unless their shapes are identical too
+ */
+export function designKeyOf(sticker: Pick<Sticker, 'id' | 'width' | 'height' | 'points' | 'holes'>): string {
+  const artworkId = sticker.id.replace(/_\d+$/, '');
+  return `${artworkId}|${designHashOf(sticker)}`;
+}
+
+/**
+ * A packed sheet that later sheets may repeat, with the designs that were left to choose
+ * from when it was packed
+ */
+export interface SheetTemplate {
+  sheet: SheetPlacement;
+  designs: Set<string>;
+}
+
+/**
+ * Design keys of a set of items, looked up by item ID
+ */
+export function designKeysOf(stickers: Array<Pick<Sticker, 'id' | 'width' | 'height' | 'points' | 'holes'>>): Map<string, string> {
+  return new Map(stickers.map(sticker => [sticker.id, designKeyOf(sticker)]));
+}
+
+/**
+ * Templates of sheets packed earlier in the run (resumed runs rebuild them from the checkpoint)
+ * Sheets are packed in order, so the designs on offer for a sheet are those on it, on every
+ * later sheet and still remaining
+ */
+export function sheetTemplatesOf(
+  sheets: SheetPlacement[],
+  remainingIds: string[],
+  designKeys: Map<string, string>,
+  isFreshStock: (sheetIndex: number) => boolean
+): SheetTemplate[] {
+  const designs = new Set(remainingIds.map(id => designKeys.get(id)!));
+  const templates: SheetTemplate[] = [];
+  for (let i = sheets.length - 1; i >= 0; i--) {
+    sheets[i].placements.forEach(p => designs.add(designKeys.get(p.id)!));
+    if (sheets[i].copyOf === undefined && isFreshStock(sheets[i].sheetIndex)) {
+      templates.unshift({ sheet: sheets[i], designs: new Set(designs) });
+    }
+  }
+  return templates;
+}
+
+/**
+ * Repeat an already-packed sheet when the remaining items still contain its design mix
+ * A template only qualifies when every remaining design was also on offer when it was
+ * packed, so the packer already preferred this layout over anything the remaining items
+ * could build. Templates are tried fullest first; the winner's layout is re-assigned to
+ * remaining instances of the same designs. Returns null when nothing can be repeated
+ */
+export function repeatPackedSheet(
+  templates: SheetTemplate[],
+  remainingIds: string[],
+  designKeys: Map<string, string>
+): { template: SheetPlacement; placements: Placement[] } | null {
+  const available = new Map<string, string[]>();
+  for (const id of remainingIds) {
+    const key = designKeys.get(id)!;
+    const ids = available.get(key);
+    if (ids) ids.push(id);
+    else available.set(key, [id]);
+  }
+
+  const candidates = templates
+    .filter(template => [...available.keys()].every(key => template.designs.has(key)))
+    .sort((a, b) => b.sheet.utilization - a.sheet.utilization);
+
+  for (const { sheet } of candidates) {
+    const needed = new Map<string, number>();
+    for (const placement of sheet.placements) {
+      const key = designKeys.get(placement.id)!;
+      needed.set(key, (needed.get(key) || 0) + 1);
+    }
+    if (![...needed].every(([key, count]) => (available.get(key)?.length ?? 0) >= count)) continue;
+
+    const taken = new Map<string, number>();
+    const placements = sheet.placements.map(placement => {
+      const key = designKeys.get(placement.id)!;
+      const index = taken.get(key) || 0;
+      taken.set(key, index + 1);
+      return { ...placement, id: available.get(key)![index] };
+    });
+    return { template: sheet, placements };
+  }
+  return null;
+}
+
+/**
+ * Distinct layouts of a run with their copy counts, or undefined when no sheet repeats another
+ */
+export function groupSheetCopies(sheets: SheetPlacement[]): SheetCopies[] | undefined {
+  if (!sheets.some(sheet => sheet.copyOf !== undefined)) return undefined;
+  const copies = new Map<number, number>();
+  for (const sheet of sheets) {
+    const layout = sheet.copyOf ?? sheet.sheetIndex;
+    copies.set(layout, (copies.get(layout) || 0) + 1);
+  }
+  return [...copies].map(([sheetIndex, count]) => ({ sheetIndex, copies: count }));
+}
+
+/**
+ * "Sheet 1 × 12 copies, sheet 13 × 1" summary of a run with repeated layouts
+ */
+export function describeSheetCopies(copies: SheetCopies[]): string {
+  return copies
+    .map(c => `sheet ${c.sheetIndex + 1} × ${c.copies} ${c.copies === 1 ? 'copy' : 'copies'}`)
+    .join(', ');
 }
@@ -0,0 +1,443 @@
+/**
+ * Page Count Predictor Service
+ * Predicts how many sheets a polygon packing job will need, as a distribution
+ *
+ * Model: packing efficiency (exact item area / sheet area on full sheets) is
+ * a Bayesian linear function of cheap job features. The prior is seeded to
+ * match the old fixed 60% constant; it is refined offline from a benchmark
+ * corpus and online from completed jobs. Page counts follow from
+ * pages = ceil(totalItemArea / (sheetArea * efficiency)).
+ */
+import fs from 'fs';
+import { PackablePolygon } from './polygon-packing.service';
+
+/**
+ * Job features used by the predictor
+ */
+export interface PackingFeatures {
+  meanSolidity: number;      // Area-weighted solidity (1.0 = all convex)
+  sizeDispersion: number;    // Coefficient of variation of item areas
+  rotationCount: number;     // Number of rotation angles tried (preset)
+  sheetAspect: number;       // Long side / short side (>= 1)
+  relativeItemSize: number;  // Mean item hull area / sheet area
+  totalItemArea: number;     // Sum of exact item areas (sq in)
+  sheetArea: number;         // Single sheet area (sq in)
+}
+
+/**
+ * Observed outcome of a completed job, used for training
+ */
+export interface PackingSample {
+  features: PackingFeatures;
+  efficiency: number; // Achieved exact-area efficiency on full sheets (0-1)
+}
+
+/**
+ * Predicted page-count distribution
+ */
+export interface PageCountPrediction {
+  expectedEfficiency: number;
+  efficiencyStdDev: number;
+  hardLowerBound: number; // ceil(total area / sheet area) - can't do better than 100%
+  lowerBound: number;     // Optimistic page count (10th percentile)
+  median: number;         // 50th percentile
+  upperBound: number;     // Pessimistic page count (90th percentile)
+  distribution: { pages: number; probability: number }[];
+}
+
+/**
+ * Serializable model state (posterior of a Bayesian linear regression)
+ */
+export interface PageCountModel {
+  precision: number[][]; // A = lambda*I + sum(x x^T)
+  moment: number[];      // b = lambda*w0 + sum(x y)
+  sse: number;           // Sum of squared residuals (plus prior pseudo-residuals)
+  observations: number;  // Number of observed samples (plus prior pseudo-count)
+}
+
+const FEATURE_COUNT = 6;
+
+// Prior weights: [intercept, solidity, sizeDispersion, log2(rotations), aspect - 1, relativeItemSize]
+// Seeded so typical orders (solidity ~0.8, 4-24 rotations, small items) land near 60%
+const PRIOR_WEIGHTS = [0.2, 0.45, 0.05, 0.02, -0.01, -0.3];
+const PRIOR_STRENGTH = 5;        // Pseudo-observations backing the prior weights
+const PRIOR_STD_DEV = 0.08;      // Prior residual std dev of efficiency
+const MIN_EFFICIENCY = 0.05;
+const MAX_EFFICIENCY = 1.0;
+
+/**
+ * Extract predictor features from packable polygons and sheet geometry (inches)
+ */
+export function extractPackingFeatures(
+  polygons: PackablePolygon[],
+  sheetWidth: number,
+  sheetHeight: number,
+  rotationCount: number
+): PackingFeatures {
+  const sheetArea = sheetWidth * sheetHeight;
+  const totalItemArea = polygons.reduce((sum, p) => sum + p.area, 0);
+  const n = polygons.length;
+
+  if (n === 0 || totalItemArea <= 0) {
+    return {
+      meanSolidity: 1,
+      sizeDispersion: 0,
+      rotationCount,
+      sheetAspect: Math.max(sheetWidth, sheetHeight) / Math.max(Math.min(sheetWidth, sheetHeight), 1e-9),
+      relativeItemSize: 0,
+      totalItemArea: 0,
+      sheetArea,
+    };
+  }
+
+  const meanArea = totalItemArea / n;
+  const variance = polygons.reduce((sum, p) => sum + (p.area - meanArea) ** 2, 0) / n;
+  const meanSolidity = polygons.reduce((sum, p) => sum + (p.solidity ?? 1) * p.area, 0) / totalItemArea;
+  const meanHullArea = polygons.reduce((sum, p) => sum + (p.hullArea ?? p.area), 0) / n;
+
+  return {
+    meanSolidity,
+    sizeDispersion: Math.sqrt(variance) / meanArea,
+    rotationCount,
+    sheetAspect: Math.max(sheetWidth, sheetHeight) / Math.min(sheetWidth, sheetHeight),
+    relativeItemSize: meanHullArea / sheetArea,
+    totalItemArea,
+    sheetArea,
+  };
+}
+
+/**
+ * Derive the training target from a finished multi-sheet layout
+ * The last sheet is only partially filled, so it says nothing about capacity;
+ * when every item was placed we average the full sheets only
+ *
+ * @param sheetUtilizations Per-sheet exact-area utilization in percent
+ * @param allItemsPlaced Whether the job placed every item (last sheet partial)
+ * @returns Efficiency (0-1), or null when the layout doesn't bound capacity
+ */
+export function efficiencyFromSheets(sheetUtilizations: number[], allItemsPlaced: boolean): number | null {
+  const fullSheets = allItemsPlaced ? sheetUtilizations.slice(0, -1) : sheetUtilizations;
+  if (fullSheets.length === 0) {
+    return null; // Single partial sheet - capacity is censored
+  }
+  return fullSheets.reduce((a, b) => a + b, 0) / fullSheets.length / 100;
+}
+
+export class PageCountPredictor {
+  private precision: number[][];
+  private moment: number[];
+  private sse: number;
+  private observations: number;
+  private persistPath?: string;
+
+  constructor(model?: PageCountModel) {
+    if (model) {
+      this.precision = [];
+      this.moment = [];
+      this.sse = 0;
+      this.observations = 0;
+      this.setModel(model);
+    } else {
+      this.precision = Array.from({ length: FEATURE_COUNT }, (_, i) =>
+        Array.from({ length: FEATURE_COUNT }, (_, j) => (i === j ? PRIOR_STRENGTH : 0))
+      );
+      this.moment = PRIOR_WEIGHTS.map(w => w * PRIOR_STRENGTH);
+      this.sse = PRIOR_STD_DEV * PRIOR_STD_DEV * PRIOR_STRENGTH;
+      this.observations = PRIOR_STRENGTH;
+    }
+  }
+
+  /**
+   * Load model state from a JSON file, falling back to the prior if missing or invalid
+   */
+  static loadFromFile(filePath: string): PageCountPredictor {
+    let predictor = new PageCountPredictor();
+    try {
+      if (fs.existsSync(filePath)) {
+        const model = JSON.parse(fs.readFileSync(filePath, 'utf-8')) as PageCountModel;
+        predictor = new PageCountPredictor(model);
+      }
+    } catch (error) {
+      console.warn(`[PageCountPredictor] Failed to load model from ${filePath}, using prior:`, error);
+    }
+    predictor.persistPath = filePath;
+    return predictor;
+  }
+
+  /**
+   * Persist model state to a JSON file
+   */
+  saveToFile(filePath: string): void {
+    fs.writeFileSync(filePath, JSON.stringify(this.getModel()));
+  }
+
+  /**
+   * Get serializable model state (e.g., to pass into a worker thread)
+   */
+  getModel(): PageCountModel {
+    return {
+      precision: this.precision.map(row => [...row]),
+      moment: [...this.moment],
+      sse: this.sse,
+      observations: this.observations,
+    };
+  }
+
+  /**
+   * Replace the model state (e.g., with the cluster primary's latest model)
+   */
+  setModel(model: PageCountModel): void {
+    this.precision = model.precision.map(row => [...row]);
+    this.moment = [...model.moment];
+    this.sse = model.sse;
+    this.observations = model.observations;
+  }
+
+  /**
+   * Train offline from a benchmark corpus (batch of samples)
+   */
+  trainOffline(samples: PackingSample[]): void {
+    samples.forEach(sample => this.observe(sample));
+    console.log(`[PageCountPredictor] Trained on ${samples.length} samples (${this.observations - PRIOR_STRENGTH} total observations)`);
+  }
+
+  /**
+   * Record a completed job: online update, then persist if the model is file-backed
+   */
+  recordCompletedJob(sample: PackingSample): void {
+    this.observe(sample);
+    if (this.persistPath) {
+      try {
+        this.saveToFile(this.persistPath);
+      } catch (error) {
+        console.warn(`[PageCountPredictor] Failed to persist model to ${this.persistPath}:`, error);
+      }
+    }
+  }
+
+  /**
+   * Online update from a single observed sample
+   */
+  observe(sample: PackingSample): void {
+    if (!(sample.efficiency > 0 && sample.efficiency <= MAX_EFFICIENCY)) {
+      return;
+    }
+
+    const x = this.featureVector(sample.features);
+
+    // Residual against the current posterior mean (before the update)
+    const residual = sample.efficiency - this.dot(this.getWeights(), x);
+
+    for (let i = 0; i < FEATURE_COUNT; i++) {
+      for (let j = 0; j < FEATURE_COUNT; j++) {
+        this.precision[i][j] += x[i] * x[j];
+      }
+      this.moment[i] += x[i] * sample.efficiency;
+    }
+
+    this.sse += residual * residual;
+    this.observations++;
+  }
+
+  /**
+   * Predict the page-count distribution for a job
+   */
+  predict(features: PackingFeatures): PageCountPrediction {
+    const { mean, stdDev } = this.predictEfficiency(features);
+    const hardLowerBound = Math.max(1, Math.ceil(features.totalItemArea / features.sheetArea));
+
+    const lowerBound = this.pagesAtQuantile(features, 0.1, mean, stdDev);
+    const median = this.pagesAtQuantile(features, 0.5, mean, stdDev);
+    const upperBound = this.pagesAtQuantile(features, 0.9, mean, stdDev);
+
+    // P(pages <= k) = P(efficiency >= totalArea / (k * sheetArea))
+    const distribution: { pages: number; probability: number }[] = [];
+    const maxPages = this.pagesAtQuantile(features, 0.99, mean, stdDev);
+    let previousCdf = 0;
+    for (let pages = hardLowerBound; pages <= maxPages; pages++) {
+      const requiredEfficiency = features.totalItemArea / (pages * features.sheetArea);
+      const cdf = pages === maxPages ? 1 : 1 - normalCdf((requiredEfficiency - mean) / stdDev);
+      distribution.push({ pages, probability: Math.max(0, cdf - previousCdf) });
+      previousCdf = cdf;
+    }
+
+    return {
+      expectedEfficiency: mean,
+      efficiencyStdDev: stdDev,
+      hardLowerBound,
+      lowerBound,
+      median,
+      upperBound,
+      distribution,
+    };
+  }
+
+  /**
+   * Page count at a given quantile of the predicted distribution
+   * A high quantile (e.g., 0.9) is a pessimistic count that rarely needs expanding
+   */
+  pagesAtQuantile(features: PackingFeatures, quantile: number, mean?: number, stdDev?: number): number {
+    const predicted = mean !== undefined && stdDev !== undefined
+      ? { mean, stdDev }
+      : this.predictEfficiency(features);
+
+    // High page quantile <=> low efficiency quantile
+    const efficiency = clamp(
+      predicted.mean + predicted.stdDev * inverseNormalCdf(1 - quantile),
+      MIN_EFFICIENCY,
+      MAX_EFFICIENCY
+    );
+    const pages = Math.ceil(features.totalItemArea / (features.sheetArea * efficiency));
+    return Math.max(1, Math.ceil(features.totalItemArea / features.sheetArea), pages);
+  }
+
+  /**
+   * Predictive mean and standard deviation of packing efficiency
+   */
+  predictEfficiency(features: PackingFeatures): { mean: number; stdDev: number } {
+    const x = this.featureVector(features);
+    const mean = clamp(this.dot(this.getWeights(), x), MIN_EFFICIENCY, MAX_EFFICIENCY);
+
+    // Predictive variance: sigma^2 * (1 + x^T A^-1 x)
+    const noiseVariance = this.sse / this.observations;
+    const leverage = this.dot(x, solveLinearSystem(this.precision, x));
+    const stdDev = Math.sqrt(noiseVariance * (1 + leverage));
+
+    return { mean, stdDev: Math.max(stdDev, 1e-3) };
+  }
+
+  /**
+   * Posterior mean weights: solve A w = b
+   */
+  private getWeights(): number[] {
+    return solveLinearSystem(this.precision, this.moment);
+  }
+
+  private featureVector(features: PackingFeatures): number[] {
+    return [
+      1,
+      features.meanSolidity,
+      features.sizeDispersion,
+      Math.log2(Math.max(1, features.rotationCount)),
+      Math.max(0, features.sheetAspect - 1),
+      features.relativeItemSize,
+    ];
+  }
+
+  private dot(a: number[], b: number[]): number {
+    let sum = 0;
+    for (let i = 0; i < a.length; i++) sum += a[i] * b[i];
+    return sum;
+  }
+}
+
+function clamp(value: number, min: number, max: number): number {
+  return Math.max(min, Math.min(max, value));
+}
+
+/**
+ * Solve A x = b for a small symmetric positive-definite matrix (Gaussian elimination with pivoting)
+ */
+function solveLinearSystem(matrix: number[][], rhs: number[]): number[] {
+  const n = rhs.length;
+  const a = matrix.map((row, i) => [...row, rhs[i]]);
+
+  for (let col = 0; col < n; col++) {
+    let pivot = col;
+    for (let row = col + 1; row < n; row++) {
+      if (Math.abs(a[row][col]) > Math.abs(a[pivot][col])) pivot = row;
+    }
+    [a[col], a[pivot]] = [a[pivot], a[col]];
+
+    for (let row = col + 1; row < n; row++) {
+      const factor = a[row][col] / a[col][col];
+      for (let k = col; k <= n; k++) {
+        a[row][k] -= factor * a[col][k];
+      }
+    }
+  }
+
+  const x = new Array(n).fill(0);
+  for (let row = n - 1; row >= 0; row--) {
+    let sum = a[row][n];
+    for (let k = row + 1; k < n; k++) sum -= a[row][k] * x[k];
+    x[row] = sum / a[row][row];
+  }
+  return x;
+}
+
+/**
+ * Standard normal CDF (Abramowitz & Stegun 7.1.26 erf approximation)
+ */
+function normalCdf(z: number): number {
+  const t = 1 / (1 + 0.3275911 * Math.abs(z) / Math.SQRT2);
+  const poly = t * (0.254829592 + t * (-0.284496736 + t * (1.421413741 + t * (-1.453152027 + t * 1.061405429))));
+  const erf = 1 - poly * Math.exp(-(z * z) / 2);
+  return z >= 0 ? (1 + erf) / 2 : (1 - erf) / 2;
+}
+
+/**
+ * Inverse standard normal CDF (Acklam's rational approximation)
+ */
+function inverseNormalCdf(p: number): number {
+  const a = [-3.969683028665376e1, 2.209460984245205e2, -2.759285104469687e2, 1.38357751867269e2, -3.066479806614716e1, 2.506628277459239];
+  const b = [-5.447609879822406e1, 1.615858368580409e2, -1.556989798598866e2, 6.680131188771972e1, -1.328068155288572e1];
+  const c = [-7.784894002430293e-3, -3.223964580411365e-1, -2.400758277161838, -2.549732539343734, 4.374664141464968, 2.938163982698783];
+  const d = [7.784695709041462e-3, 3.224671290700398e-1, 2.445134137142996, 3.754408661907416];
+
+  p = clamp(p, 1e-9, 1 - 1e-9);
+  const pLow = 0.02425;
+
+  if (p < pLow) {
+    const q = Math.sqrt(-2 * Math.log(p));
+    return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+      ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+  }
+  if (p > 1 - pLow) {
+    const q = Math.sqrt(-2 * Math.log(1 - p));
+    return -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+      ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+  }
+
+  const q = p - 0.5;
+  const r = q * q;
+  return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+    (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+}
+
+// IPC messages exchanged with the cluster primary, which owns the model in cluster mode
+export interface PredictorObserveMessage {
+  type: 'predictor:observe';
+  sample: PackingSample;
+}
+
+export interface PredictorSyncMessage {
+  type: 'predictor:sync';
+}
+
+export interface PredictorModelMessage {
+  type: 'predictor:model';
+  model: PageCountModel;
+}
+
+/**
+ * A cluster worker's replica of the primary's model
+ * Predicts locally, forwards completed jobs to the primary (the only process that observes
+ * and writes the model file) and takes every updated model the primary broadcasts
+ */
+export class ClusterPageCountPredictor extends PageCountPredictor {
+  constructor() {
+    super();
+    process.on('message', (message: any) => {
+      if (message?.type !== 'predictor:model') return;
+      this.setModel((message as PredictorModelMessage).model);
+    });
+    const sync: PredictorSyncMessage = { type: 'predictor:sync' };
+    process.send?.(sync);
+  }
+
+  recordCompletedJob(sample: PackingSample): void {
+    const message: PredictorObserveMessage = { type: 'predictor:observe', sample };
+    process.send?.(message);
+  }
+}
@@ -2,12 +2,24 @@ import PDFDocument from 'pdfkit';
 import { Writable } from 'stream';
 import sharp from 'sharp';
 import { Placement, Sticker, SheetPlacement } from './nesting.service';
+import { SvgArtwork, SvgService } from './svg.service';
+
+export interface SheetPdfRenderer {
+  addSheet(sheet: SheetPlacement): void; // Queue a finalized sheet as the next page
+  finish(): Promise<void>;               // End the document; resolves when fully written
+  abort(): void;                         // Stop drawing and detach from the output (client went away)
+  getPageCount(): number;                // Pages drawn so far
+}
+
+// What gets drawn for a sticker: an optimized raster, or parsed SVG shapes drawn as vectors
+type StickerArtwork = Buffer | SvgArtwork;
 
 export class PdfService {
   // Conversion constant: millimeters to PDF points
   // 1 inch = 25.4 mm = 72 points
   // Therefore: 1 mm = 72/25.4 points = 2.834645669291339 points
   private readonly MM_TO_POINTS = 72 / 25.4;
+  private readonly svgService = new SvgService();
 
   /**
    * Optimize image buffer for PDF embedding to reduce RAM usage
@@ -43,6 +55,20 @@ export class PdfService {
     }
   }
 
+  /**
+   * Prepare a sticker's artwork once per document
+   * SVG uploads are drawn as vector shapes; ones the SVG reader can't reproduce are
+   * rasterized at print resolution instead
+   */
+  private async prepareArtwork(imageBuffer: Buffer): Promise<StickerArtwork> {
+    if (this.svgService.isSvg(imageBuffer)) {
+      const artwork = this.svgService.parse(imageBuffer);
+      if (artwork) return artwork;
+      return this.optimizeImageBuffer(await sharp(imageBuffer, { density: 300 }).png().toBuffer());
+    }
+    return this.optimizeImageBuffer(imageBuffer);
+  }
+
   /**
    * Generate PDF with sticker layout (streaming version for memory efficiency)
    * Instead of buffering entire PDF in memory, streams directly to output
@@ -77,10 +103,9 @@ export class PdfService {
         doc.on('error', reject);
 
         // Optimize all images before drawing (lossless PNG compression, reduces memory by ~30-50%)
-        const optimizedImages = new Map<string, Buffer>();
+        const optimizedImages = new Map<string, StickerArtwork>();
         for (const [id, sticker] of stickers) {
-          const optimized = await this.optimizeImageBuffer(sticker.imageBuffer);
-          optimizedImages.set(id, optimized);
+          optimizedImages.set(id, await this.prepareArtwork(sticker.imageBuffer));
         }
 
         // Draw each placement
@@ -88,117 +113,10 @@ export class PdfService {
           const sticker = stickers.get(placement.id);
           if (!sticker) return;
 
-          const optimizedBuffer = optimizedImages.get(placement.id);
-          if (!optimizedBuffer) return;
-
-          // Convert from millimeters to PDF points
-          const xPoints = placement.x * this.MM_TO_POINTS;
-          const yPoints = placement.y * this.MM_TO_POINTS;
-          const wPoints = sticker.width * this.MM_TO_POINTS;
-          const hPoints = sticker.height * this.MM_TO_POINTS;
-
-          // Draw image with rotation support
-          try {
-            // STRICT STATE ISOLATION: Save state before any transformations
-            doc.save();
-
-            // Step 1: Translate to placement position (absolute from packer)
-            doc.translate(xPoints, yPoints);
-
-            // Step 2: Handle rotation with center-based pivot
-            if (placement.rotation && placement.rotation !== 0) {
-              const is90DegRotation = Math.abs(Math.abs(placement.rotation) - 90) < 0.1;
-
-              if (is90DegRotation) {
-                // For 90-degree rotations: rotate around center of ROTATED bounding box
-                // Rotated box dimensions are swapped: hPoints × wPoints
-                // Center of rotated box is at (hPoints/2, wPoints/2) from placement origin
-                doc.translate(hPoints / 2, wPoints / 2);
-                doc.rotate(placement.rotation, { origin: [0, 0] });
-
-                // Draw image centered using ORIGINAL dimensions
-                doc.image(optimizedBuffer, -wPoints / 2, -hPoints / 2, {
-                  width: wPoints,
-                  height: hPoints
-                });
-
-                // Draw cut line (red)
-                if (sticker.points && sticker.points.length > 0) {
-                  doc.strokeColor('red');
-                  doc.lineWidth(0.5);
-
-                  const scaledPoints = sticker.points.map(p => ({
-                    x: (p.x / sticker.width) * wPoints - wPoints / 2,
-                    y: (p.y / sticker.height) * hPoints - hPoints / 2
-                  }));
-
-                  doc.moveTo(scaledPoints[0].x, scaledPoints[0].y);
-                  for (let i = 1; i < scaledPoints.length; i++) {
-                    doc.lineTo(scaledPoints[i].x, scaledPoints[i].y);
-                  }
-                  doc.closePath();
-                  doc.stroke();
-                }
-              } else {
-                // For arbitrary angles: rotate around center normally
-                doc.translate(wPoints / 2, hPoints / 2);
-                doc.rotate(placement.rotation, { origin: [0, 0] });
-
-                // Draw image offset by negative half dimensions (no swap for non-90° rotations)
-                doc.image(optimizedBuffer, -wPoints / 2, -hPoints / 2, {
-                  width: wPoints,
-                  height: hPoints
-                });
-
-                // Draw cut line (red)
-                if (sticker.points && sticker.points.length > 0) {
-                  doc.strokeColor('red');
-                  doc.lineWidth(0.5);
-
-                  const scaledPoints = sticker.points.map(p => ({
-                    x: (p.x / sticker.width) * wPoints - wPoints / 2,
-                    y: (p.y / sticker.height) * hPoints - hPoints / 2
-                  }));
-
-                  doc.moveTo(scaledPoints[0].x, scaledPoints[0].y);
-                  for (let i = 1; i < scaledPoints.length; i++) {
-                    doc.lineTo(scaledPoints[i].x, scaledPoints[i].y);
-                  }
-                  doc.closePath();
-                  doc.stroke();
-                }
-              }
-            } else {
-              // No rotation: Draw at origin (0, 0)
-              doc.image(optimizedBuffer, 0, 0, {
-                width: wPoints,
-                height: hPoints
-              });
-
-              // Draw cut line (red)
-              if (sticker.points && sticker.points.length > 0) {
-                doc.strokeColor('red');
-                doc.lineWidth(0.5);
-
-                const scaledPoints = sticker.points.map(p => ({
-                  x: (p.x / sticker.width) * wPoints,
-                  y: (p.y / sticker.height) * hPoints
-                }));
-
-                doc.moveTo(scaledPoints[0].x, scaledPoints[0].y);
-                for (let i = 1; i < scaledPoints.length; i++) {
-                  doc.lineTo(scaledPoints[i].x, scaledPoints[i].y);
-                }
-                doc.closePath();
-                doc.stroke();
-              }
-            }
-
-            // STRICT STATE ISOLATION: Restore state after rendering this sticker
-            doc.restore();
-          } catch (err) {
-            console.error('Error drawing sticker:', err);
-          }
+          const artwork = optimizedImages.get(placement.id);
+          if (!artwork) return;
+
+          this.drawPlacement(doc, placement, sticker, artwork);
         });
 
         doc.end();
@@ -225,174 +143,284 @@ export class PdfService {
     sheetHeight: number,
     outputStream: Writable
   ): Promise<void> {
-    return new Promise(async (resolve, reject) => {
-      try {
-        console.log(`Generating multi-sheet PDF: ${sheets.length} pages (memory-optimized streaming mode)`);
+    console.log(`Generating multi-sheet PDF: ${sheets.length} pages (memory-optimized streaming mode)`);
 
-        // Convert from millimeters to PDF points
-        const widthPoints = sheetWidth * this.MM_TO_POINTS;
-        const heightPoints = sheetHeight * this.MM_TO_POINTS;
+    const renderer = this.createSheetRenderer(stickers, sheetWidth, sheetHeight, outputStream);
+    sheets.forEach(sheet => renderer.addSheet(sheet));
+    return renderer.finish();
+  }
 
-        const doc = new PDFDocument({
-          size: [widthPoints, heightPoints],
-          margin: 0
+  /**
+   * Create an incremental multi-page renderer: each sheet becomes a page as soon as it's added
+   * PDFKit flushes a page to the output stream when the next one starts, so pages stream
+   * out while later sheets are still being packed (pack-and-render pipeline)
+   *
+   * Image optimization starts immediately and overlaps with packing;
+   * pages are drawn in arrival order, and re-sent sheets (same sheetIndex) are ignored.
+   * A sheet that repeats an already-drawn layout (copyOf) gets no page of its own: it is
+   * counted against that layout's page, and a closing print-run page lists the copies
+   */
+  createSheetRenderer(
+    stickers: Map<string, Sticker & { imageBuffer: Buffer }>,
+    sheetWidth: number,
+    sheetHeight: number,
+    outputStream: Writable
+  ): SheetPdfRenderer {
+    // Convert from millimeters to PDF points
+    const widthPoints = sheetWidth * this.MM_TO_POINTS;
+    const heightPoints = sheetHeight * this.MM_TO_POINTS;
+
+    const doc = new PDFDocument({
+      size: [widthPoints, heightPoints],
+      margin: 0,
+      autoFirstPage: false
+    });
+
+    // CRITICAL: Stream directly to output instead of buffering in memory
+    doc.pipe(outputStream);
+    const ended = new Promise<void>((resolve, reject) => {
+      doc.on('end', () => resolve());
+      doc.on('error', reject);
+    });
+
+    // Optimize all unique images ONCE (lossless PNG, reduces memory by ~30-50%)
+    const imagesReady = (async () => {
+      console.log(`Optimizing ${stickers.size} unique images with lossless compression...`);
+      const optimizedImages = new Map<string, StickerArtwork>();
+      for (const [id, sticker] of stickers) {
+        optimizedImages.set(id, await this.prepareArtwork(sticker.imageBuffer));
+      }
+      return optimizedImages;
+    })();
+
+    const renderedSheets = new Set<number>();
+    const layoutPages = new Map<number, number>(); // sheetIndex of a drawn layout → its page number
+    const layoutCopies = new Map<number, number>(); // sheetIndex of a drawn layout → sheets printing it
+    let pageCount = 0;
+    let aborted = false;
+    let pipeline: Promise<void> = imagesReady.then(() => undefined);
+
+    return {
+      addSheet: (sheet: SheetPlacement) => {
+        if (aborted || renderedSheets.has(sheet.sheetIndex)) return;
+        renderedSheets.add(sheet.sheetIndex);
+
+        if (sheet.copyOf !== undefined && layoutPages.has(sheet.copyOf)) {
+          layoutCopies.set(sheet.copyOf, layoutCopies.get(sheet.copyOf)! + 1);
+          return;
+        }
+        layoutPages.set(sheet.sheetIndex, layoutPages.size + 1);
+        layoutCopies.set(sheet.sheetIndex, 1);
+
+        pipeline = pipeline.then(async () => {
+          const optimizedImages = await imagesReady;
+          if (aborted) return;
+          // Multi-stock jobs size each page to the stock its sheet was packed on
+          doc.addPage(sheet.stock
+            ? { size: [sheet.stock.width * this.MM_TO_POINTS, sheet.stock.height * this.MM_TO_POINTS], margin: 0 }
+            : undefined);
+          pageCount++;
+          this.drawSheet(doc, sheet, stickers, optimizedImages);
+        });
+      },
+      finish: () => {
+        if (aborted) return pipeline;
+        pipeline = pipeline.then(() => {
+          if (pageCount === 0) {
+            doc.addPage(); // A PDF needs at least one page
+          }
+          if ([...layoutCopies.values()].some(copies => copies > 1)) {
+            this.drawPrintRun(doc, layoutPages, layoutCopies);
+          }
+          doc.end();
+        });
+        return pipeline.then(() => ended);
+      },
+      abort: () => {
+        if (aborted) return;
+        aborted = true;
+        // Drain whatever PDFKit still produces instead of writing to a closed stream
+        doc.unpipe(outputStream);
+        doc.resume();
+        pipeline = pipeline.then(() => {
+          doc.end();
         });
+      },
+      getPageCount: () => pageCount
+    };
+  }
 
-        // CRITICAL: Stream directly to output instead of buffering in memory
-        doc.pipe(outputStream);
-        doc.on('end', () => resolve());
-        doc.on('error', reject);
+  /**
+   * Append a page listing how many copies of each layout page to print
+   */
+  private drawPrintRun(
+    doc: PDFKit.PDFDocument,
+    layoutPages: Map<number, number>,
+    layoutCopies: Map<number, number>
+  ): void {
+    doc.addPage();
+    doc.fontSize(14).text('Print run', 18, 18);
+    doc.fontSize(10);
+    for (const [sheetIndex, page] of layoutPages) {
+      const copies = layoutCopies.get(sheetIndex)!;
+      doc.text(`Page ${page}: ${copies} ${copies === 1 ? 'copy' : 'copies'}`);
+    }
+  }
 
-        // Optimize all unique images ONCE before drawing (lossless PNG, reduces memory by ~30-50%)
-        console.log(`Optimizing ${stickers.size} unique images with lossless compression...`);
-        const optimizedImages = new Map<string, Buffer>();
-        for (const [id, sticker] of stickers) {
-          const optimized = await this.optimizeImageBuffer(sticker.imageBuffer);
-          optimizedImages.set(id, optimized);
+  /**
+   * Draw all placements of one sheet onto the current page
+   */
+  private drawSheet(
+    doc: PDFKit.PDFDocument,
+    sheet: SheetPlacement,
+    stickers: Map<string, Sticker & { imageBuffer: Buffer }>,
+    optimizedImages: Map<string, StickerArtwork>
+  ): void {
+    // Draw placements on this sheet
+    if (!sheet.placements || sheet.placements.length === 0) {
+      console.warn(`Sheet ${sheet.sheetIndex} has no placements`);
+      return;
+    }
+
+    sheet.placements.forEach(placement => {
+      // Extract original sticker ID (remove instance suffix _0, _1, etc.)
+      const originalId = placement.id.replace(/_\d+$/, '');
+      const sticker = stickers.get(originalId);
+      if (!sticker) {
+        console.warn(`Sticker not found for placement ID: ${placement.id}, tried: ${originalId}`);
+        return;
+      }
+
+      const artwork = optimizedImages.get(originalId);
+      if (!artwork) {
+        console.warn(`Optimized image not found for: ${originalId}`);
+        return;
+      }
+
+      this.drawPlacement(doc, placement, sticker, artwork);
+    });
+  }
+
+  /**
+   * Draw one sticker (image + red cut lines) at its placement
+   */
+  private drawPlacement(
+    doc: PDFKit.PDFDocument,
+    placement: Placement,
+    sticker: Sticker,
+    artwork: StickerArtwork
+  ): void {
+    // Convert from millimeters to PDF points
+    const xPoints = placement.x * this.MM_TO_POINTS;
+    const yPoints = placement.y * this.MM_TO_POINTS;
+    const wPoints = sticker.width * this.MM_TO_POINTS;
+    const hPoints = sticker.height * this.MM_TO_POINTS;
+
+    // Draw image with rotation support
+    try {
+      // STRICT STATE ISOLATION: Save state before any transformations
+      doc.save();
+
+      // Step 1: Translate to placement position (absolute from packer)
+      doc.translate(xPoints, yPoints);
+
+      // Step 2: Handle rotation with center-based pivot
+      let offsetX = 0;
+      let offsetY = 0;
+      if (placement.rotation && placement.rotation !== 0) {
+        const is90DegRotation = Math.abs(Math.abs(placement.rotation) - 90) < 0.1;
+
+        if (is90DegRotation) {
+          // For 90-degree rotations: rotate around center of ROTATED bounding box
+          // Rotated box dimensions are swapped: hPoints × wPoints
+          // Center of rotated box is at (hPoints/2, wPoints/2) from placement origin
+          doc.translate(hPoints / 2, wPoints / 2);
+        } else {
+          // For arbitrary angles: rotate around center normally
+          doc.translate(wPoints / 2, hPoints / 2);
         }
+        doc.rotate(placement.rotation, { origin: [0, 0] });
 
-        // Draw each sheet as a separate page
-        sheets.forEach((sheet, sheetIndex) => {
-          if (sheetIndex > 0) {
-            doc.addPage();
-          }
+        // Draw centered using ORIGINAL dimensions
+        offsetX = -wPoints / 2;
+        offsetY = -hPoints / 2;
+      }
+
+      if (Buffer.isBuffer(artwork)) {
+        doc.image(artwork, offsetX, offsetY, {
+          width: wPoints,
+          height: hPoints
+        });
+      } else {
+        this.drawVector(doc, artwork, offsetX, offsetY, wPoints, hPoints);
+      }
 
-          // Draw placements on this sheet
-          if (!sheet.placements || sheet.placements.length === 0) {
-            console.warn(`Sheet ${sheetIndex} has no placements`);
-            return;
+      // Draw cut lines (red): the outline plus every interior hole, which is cut out too so
+      // stickers nested inside it can be peeled
+      if (sticker.points && sticker.points.length > 0) {
+        doc.strokeColor('red');
+        doc.lineWidth(0.5);
+
+        for (const ring of [sticker.points, ...(sticker.holes || [])]) {
+          if (ring.length < 3) continue;
+          const scaledPoints = ring.map(p => ({
+            x: (p.x / sticker.width) * wPoints + offsetX,
+            y: (p.y / sticker.height) * hPoints + offsetY
+          }));
+
+          doc.moveTo(scaledPoints[0].x, scaledPoints[0].y);
+          for (let i = 1; i < scaledPoints.length; i++) {
+            doc.lineTo(scaledPoints[i].x, scaledPoints[i].y);
           }
+          doc.closePath();
+        }
+        doc.stroke();
+      }
 
-          sheet.placements.forEach(placement => {
-            // Extract original sticker ID (remove instance suffix _0, _1, etc.)
-            const originalId = placement.id.replace(/_\d+$/, '');
-            const sticker = stickers.get(originalId);
-            if (!sticker) {
-              console.warn(`Sticker not found for placement ID: ${placement.id}, tried: ${originalId}`);
-              return;
-            }
-
-            const optimizedBuffer = optimizedImages.get(originalId);
-            if (!optimizedBuffer) {
-              console.warn(`Optimized image not found for: ${originalId}`);
-              return;
-            }
-
-            // Convert from millimeters to PDF points
-            const xPoints = placement.x * this.MM_TO_POINTS;
-            const yPoints = placement.y * this.MM_TO_POINTS;
-            const wPoints = sticker.width * this.MM_TO_POINTS;
-            const hPoints = sticker.height * this.MM_TO_POINTS;
-
-            // Draw image with rotation support
-            try {
-              // STRICT STATE ISOLATION: Save state before any transformations
-              doc.save();
-
-              // Step 1: Translate to placement position (absolute from packer)
-              doc.translate(xPoints, yPoints);
-
-              // Step 2: Handle rotation with center-based pivot
-              if (placement.rotation && placement.rotation !== 0) {
-                const is90DegRotation = Math.abs(Math.abs(placement.rotation) - 90) < 0.1;
-
-                if (is90DegRotation) {
-                  // For 90-degree rotations: rotate around center of ROTATED bounding box
-                  // Rotated box dimensions are swapped: hPoints × wPoints
-                  // Center of rotated box is at (hPoints/2, wPoints/2) from placement origin
-                  doc.translate(hPoints / 2, wPoints / 2);
-                  doc.rotate(placement.rotation, { origin: [0, 0] });
-
-                  // Draw image centered using ORIGINAL dimensions
-                  doc.image(optimizedBuffer, -wPoints / 2, -hPoints / 2, {
-                    width: wPoints,
-                    height: hPoints
-                  });
-
-                  // Draw cut line (red)
-                  if (sticker.points && sticker.points.length > 0) {
-                    doc.strokeColor('red');
-                    doc.lineWidth(0.5);
-
-                    const scaledPoints = sticker.points.map(p => ({
-                      x: (p.x / sticker.width) * wPoints - wPoints / 2,
-                      y: (p.y / sticker.height) * hPoints - hPoints / 2
-                    }));
-
-                    doc.moveTo(scaledPoints[0].x, scaledPoints[0].y);
-                    for (let i = 1; i < scaledPoints.length; i++) {
-                      doc.lineTo(scaledPoints[i].x, scaledPoints[i].y);
-                    }
-                    doc.closePath();
-                    doc.stroke();
-                  }
-                } else {
-                  // For arbitrary angles: rotate around center normally
-                  doc.translate(wPoints / 2, hPoints / 2);
-                  doc.rotate(placement.rotation, { origin: [0, 0] });
-
-                  // Draw image offset by negative half dimensions (no swap for non-90° rotations)
-                  doc.image(optimizedBuffer, -wPoints / 2, -hPoints / 2, {
-                    width: wPoints,
-                    height: hPoints
-                  });
-
-                  // Draw cut line (red)
-                  if (sticker.points && sticker.points.length > 0) {
-                    doc.strokeColor('red');
-                    doc.lineWidth(0.5);
-
-                    const scaledPoints = sticker.points.map(p => ({
-                      x: (p.x / sticker.width) * wPoints - wPoints / 2,
-                      y: (p.y / sticker.height) * hPoints - hPoints / 2
-                    }));
-
-                    doc.moveTo(scaledPoints[0].x, scaledPoints[0].y);
-                    for (let i = 1; i < scaledPoints.length; i++) {
-                      doc.lineTo(scaledPoints[i].x, scaledPoints[i].y);
-                    }
-                    doc.closePath();
-                    doc.stroke();
-                  }
-                }
-              } else {
-                // No rotation: Draw at origin (0, 0)
-                doc.image(optimizedBuffer, 0, 0, {
-                  width: wPoints,
-                  height: hPoints
-                });
-
-                // Draw cut line (red)
-                if (sticker.points && sticker.points.length > 0) {
-                  doc.strokeColor('red');
-                  doc.lineWidth(0.5);
-
-                  const scaledPoints = sticker.points.map(p => ({
-                    x: (p.x / sticker.width) * wPoints,
-                    y: (p.y / sticker.height) * hPoints
-                  }));
-
-                  doc.moveTo(scaledPoints[0].x, scaledPoints[0].y);
-                  for (let i = 1; i < scaledPoints.length; i++) {
-                    doc.lineTo(scaledPoints[i].x, scaledPoints[i].y);
-                  }
-                  doc.closePath();
-                  doc.stroke();
-                }
-              }
-
-              // STRICT STATE ISOLATION: Restore state after rendering this sticker
-              doc.restore();
-            } catch (err) {
-              console.error('Error drawing sticker:', err);
-            }
-          });
-        });
+      // STRICT STATE ISOLATION: Restore state after rendering this sticker
+      doc.restore();
+    } catch (err) {
+      console.error('Error drawing sticker:', err);
+    }
+  }
 
-        doc.end();
-      } catch (error) {
-        reject(error);
+  /**
+   * Draw parsed SVG shapes so the outline's bounds fill the given box
+   */
+  private drawVector(
+    doc: PDFKit.PDFDocument,
+    artwork: SvgArtwork,
+    x: number,
+    y: number,
+    width: number,
+    height: number
+  ): void {
+    const { bounds } = artwork;
+    doc.save();
+    doc.translate(x, y);
+    doc.scale(width / bounds.width, height / bounds.height);
+    doc.translate(-bounds.minX, -bounds.minY);
+
+    for (const shape of artwork.shapes) {
+      doc.save();
+      doc.transform(...shape.matrix);
+      doc.path(shape.d);
+      if (shape.fill !== null) doc.fillColor(shape.fill, shape.fillOpacity);
+      if (shape.stroke !== null) {
+        doc.lineWidth(shape.strokeWidth).strokeColor(shape.stroke, shape.strokeOpacity);
+        doc.lineCap(shape.lineCap).lineJoin(shape.lineJoin).miterLimit(shape.miterLimit);
       }
-    });
+
+      if (shape.fill !== null && shape.stroke !== null) {
+        doc.fillAndStroke(shape.fill, shape.stroke, shape.fillRule);
+      } else if (shape.fill !== null) {
+        doc.fill(shape.fill, shape.fillRule);
+      } else {
+        doc.stroke();
+      }
+      doc.restore();
+    }
+
+    doc.restore();
   }
 }
@@ -1,11 +1,108 @@
+import { MaxRectsPacker, IRectangle } from 'maxrects-packer';
 import { Point } from './image.service';
-import { GeometryService } from './geometry.service';
+import { GeometryService, ShapeDescriptors } from './geometry.service';
+
+const NEIGHBOUR_DX = [1, -1, 0, 0];
+const NEIGHBOUR_DY = [0, 0, 1, -1];
+
+// Cells of rounding slack when pruning candidates against the height map
+const HEIGHT_MAP_SLACK = 1;
+const EMPTY_COLUMN = 0x3fffffff;
+
+/**
+ * Rasterized footprint summary used to prune candidates against the height map
+ * (cells; column tops and widest row relative to the footprint's own corner)
+ */
+interface FootprintProfile {
+  originX: number; // Footprint corner when placed at (0, 0)
+  originY: number;
+  columnTops: Int32Array; // Topmost footprint row per column (EMPTY_COLUMN if none)
+  highestTop: number;
+  widestRow: number; // Row holding the longest contiguous span
+  widestRun: number;
+  centerX: number; // Inscribed-circle centre, relative to the corner
+  centerY: number;
+  inscribedRadius: number; // Chamfer units
+}
+
+// Chamfer 3-4 distance steps: a good integer approximation of Euclidean distance
+const CHAMFER_STRAIGHT = 3;
+const CHAMFER_DIAGONAL = 4;
+
+// Share of the grid that may be marked before the clearance map is rebuilt
+const CLEARANCE_REFRESH_SHARE = 0.02;
+
+/**
+ * Chamfer distance transform: distance from each cell to the nearest blocked (non-zero) cell,
+ * with everything outside the grid counted as blocked. Two raster passes over flat arrays
+ */
+export function chamferTransform(blocked: Uint8Array, width: number, height: number): Uint16Array {
+  const dist = new Uint16Array(width * height);
+  const at = (x: number, y: number) => (x < 0 || y < 0 || x >= width || y >= height ? 0 : dist[y * width + x]);
+
+  for (let y = 0; y < height; y++) {
+    for (let x = 0; x < width; x++) {
+      const i = y * width + x;
+      if (blocked[i]) continue;
+      dist[i] = Math.min(
+        0xffff,
+        at(x - 1, y) + CHAMFER_STRAIGHT,
+        at(x, y - 1) + CHAMFER_STRAIGHT,
+        at(x - 1, y - 1) + CHAMFER_DIAGONAL,
+        at(x + 1, y - 1) + CHAMFER_DIAGONAL
+      );
+    }
+  }
+  for (let y = height - 1; y >= 0; y--) {
+    for (let x = width - 1; x >= 0; x--) {
+      const i = y * width + x;
+      if (blocked[i]) continue;
+      dist[i] = Math.min(
+        dist[i],
+        at(x + 1, y) + CHAMFER_STRAIGHT,
+        at(x, y + 1) + CHAMFER_STRAIGHT,
+        at(x + 1, y + 1) + CHAMFER_DIAGONAL,
+        at(x - 1, y + 1) + CHAMFER_DIAGONAL
+      );
+    }
+  }
+  return dist;
+}
+
+/**
+ * Inclusive cell-index bounding box
+ */
+export interface CellBounds {
+  minX: number;
+  minY: number;
+  maxX: number;
+  maxY: number;
+}
+
+/**
+ * Neighbourhood of a candidate footprint (see RasterGrid.measureFootprint)
+ */
+export interface FootprintMetrics {
+  perimeter: number;
+  contact: number;
+  slivers: number;
+}
+
+/**
+ * Cell storage of a grid shared between worker threads (see RasterGrid.createShared)
+ */
+export interface SharedGridState {
+  cells: SharedArrayBuffer; // One byte per cell
+  lock: SharedArrayBuffer;  // Int32 commit lock (0 = free)
+}
 
 /**
- * RasterGrid: 2D boolean grid representing occupied space on the sheet
+ * RasterGrid: occupancy grid of the sheet, one byte per cell (row-major, 1 = occupied)
+ * Flat typed storage keeps clone() a single copy for search strategies that branch, and lets
+ * cells live in a SharedArrayBuffer so several threads can place onto one sheet
  */
 export class RasterGrid {
-  private grid: boolean[][];
+  private grid: Uint8Array;
   private readonly cellsPerInch: number;
   private readonly width: number; // in inches
   private readonly height: number; // in inches
@@ -18,17 +115,42 @@ export class RasterGrid {
   private readonly blocksHigh: number;
   private blockOccupancy: number[][]; // Percentage occupied (0-100) per block
 
-  constructor(widthInches: number, heightInches: number, cellsPerInch: number = 100) {
+  // Height map for candidate pruning: first free row of each column (gridHeight = column full)
+  // and the longest run of free cells in each row
+  private skyline: Int32Array;
+  private rowFreeRun: Int32Array;
+
+  // Bounding box of occupied cells; recomputed lazily after cells are freed
+  private usedBounds: CellBounds | null = null;
+  private usedBoundsStale = false;
+
+  // Chamfer distance from each cell to the nearest occupied cell or sheet edge, rebuilt lazily.
+  // Cells marked since the last build only lower true clearance, so a slightly stale map
+  // never rejects a feasible position; freeing cells discards it
+  private clearance: Uint16Array | null = null;
+  private cellsSinceClearance = 0;
+
+  // Set when cells live in shared memory: other threads may occupy cells at any time, which
+  // leaves the indexes above conservative (they only ever under-report occupancy)
+  private shared: SharedGridState | null = null;
+  private lock: Int32Array | null = null;
+
+  constructor(widthInches: number, heightInches: number, cellsPerInch: number = 100, shared?: SharedGridState) {
     this.width = widthInches;
     this.height = heightInches;
     this.cellsPerInch = cellsPerInch;
     this.gridWidth = Math.ceil(widthInches * cellsPerInch);
     this.gridHeight = Math.ceil(heightInches * cellsPerInch);
 
-    // Initialize grid with all cells free (false)
-    this.grid = Array(this.gridHeight)
-      .fill(null)
-      .map(() => Array(this.gridWidth).fill(false));
+    // Initialize grid with all cells free (0), or attach to shared cells
+    this.grid = shared ? new Uint8Array(shared.cells) : new Uint8Array(this.gridWidth * this.gridHeight);
+    if (shared) {
+      this.shared = shared;
+      this.lock = new Int32Array(shared.lock);
+    }
+
+    this.skyline = new Int32Array(this.gridWidth);
+    this.rowFreeRun = new Int32Array(this.gridHeight).fill(this.gridWidth);
 
     // Initialize spatial index
     this.blocksWide = Math.ceil(widthInches / this.blockSize);
@@ -36,6 +158,75 @@ export class RasterGrid {
     this.blockOccupancy = Array(this.blocksHigh)
       .fill(null)
       .map(() => Array(this.blocksWide).fill(0));
+
+    if (shared) {
+      this.refreshIndexes();
+    }
+  }
+
+  /**
+   * Grid whose cells live in shared memory; pass getSharedState() to worker threads and
+   * attach there with new RasterGrid(width, height, cellsPerInch, state)
+   */
+  static createShared(widthInches: number, heightInches: number, cellsPerInch: number = 100): RasterGrid {
+    const cells = Math.ceil(widthInches * cellsPerInch) * Math.ceil(heightInches * cellsPerInch);
+    return new RasterGrid(widthInches, heightInches, cellsPerInch, {
+      cells: new SharedArrayBuffer(cells),
+      lock: new SharedArrayBuffer(Int32Array.BYTES_PER_ELEMENT),
+    });
+  }
+
+  getSharedState(): SharedGridState | null {
+    return this.shared;
+  }
+
+  /**
+   * Rebuild every index from the cells (after other threads have written to a shared grid)
+   */
+  refreshIndexes(): void {
+    for (let blockY = 0; blockY < this.blocksHigh; blockY++) {
+      for (let blockX = 0; blockX < this.blocksWide; blockX++) {
+        this.updateBlockOccupancy(blockX, blockY);
+      }
+    }
+    this.updateHeightMap(0, this.gridWidth - 1, 0, this.gridHeight - 1, true);
+    this.usedBoundsStale = true;
+    this.clearance = null;
+  }
+
+  /**
+   * Validate-then-mark: occupy the cells only if they are all still free
+   * On a shared grid the check and the write happen under a cross-thread lock, so two
+   * threads can never commit overlapping placements. Indexes are updated after the lock
+   * is released
+   */
+  tryCommit(cells: GridCell[]): boolean {
+    this.acquireLock();
+    try {
+      if (this.checkCollision(cells)) {
+        return false;
+      }
+      for (const cell of cells) {
+        this.grid[cell.y * this.gridWidth + cell.x] = 1;
+      }
+    } finally {
+      this.releaseLock();
+    }
+    this.markOccupied(cells);
+    return true;
+  }
+
+  private acquireLock(): void {
+    if (!this.lock) return;
+    while (Atomics.compareExchange(this.lock, 0, 0, 1) !== 0) {
+      Atomics.wait(this.lock, 0, 1, 1);
+    }
+  }
+
+  private releaseLock(): void {
+    if (!this.lock) return;
+    Atomics.store(this.lock, 0, 0);
+    Atomics.notify(this.lock, 0, 1);
   }
 
   /**
@@ -62,22 +253,87 @@ export class RasterGrid {
         return true; // Out of bounds = collision
       }
       // Check if occupied
-      if (this.grid[cell.y][cell.x]) {
+      if (this.grid[cell.y * this.gridWidth + cell.x]) {
         return true;
       }
     }
     return false;
   }
 
+  /**
+   * Mark the used pixels of a remnant mask as occupied
+   * The mask is stretched over the whole sheet; every cell a used pixel touches is blocked
+   */
+  markMask(mask: OccupancyMask): void {
+    const pixels = Buffer.from(mask.data, 'base64');
+    const scaleX = this.gridWidth / mask.width;
+    const scaleY = this.gridHeight / mask.height;
+    const cells: GridCell[] = [];
+
+    for (let py = 0; py < mask.height; py++) {
+      const y1 = Math.floor(py * scaleY);
+      const y2 = Math.min(Math.ceil((py + 1) * scaleY), this.gridHeight);
+      for (let px = 0; px < mask.width; px++) {
+        if (!pixels[py * mask.width + px]) continue;
+        const x1 = Math.floor(px * scaleX);
+        const x2 = Math.min(Math.ceil((px + 1) * scaleX), this.gridWidth);
+        for (let y = y1; y < y2; y++) {
+          for (let x = x1; x < x2; x++) {
+            cells.push({ x, y });
+          }
+        }
+      }
+    }
+
+    this.markOccupied(cells);
+  }
+
+  /**
+   * Check that every cell lies on the sheet
+   */
+  isWithinBounds(cells: GridCell[]): boolean {
+    return cells.every(cell => cell.x >= 0 && cell.x < this.gridWidth && cell.y >= 0 && cell.y < this.gridHeight);
+  }
+
   /**
    * Mark cells as occupied and update spatial index
    */
   markOccupied(cells: GridCell[]): void {
+    this.setCells(cells, true);
+  }
+
+  /**
+   * Release cells held by a removed placement and update spatial index
+   */
+  markFree(cells: GridCell[]): void {
+    this.setCells(cells, false);
+  }
+
+  private setCells(cells: GridCell[], occupied: boolean): void {
     const affectedBlocks = new Set<string>();
+    if (occupied && cells.length > 0 && !this.usedBoundsStale) {
+      this.usedBounds = this.extendBounds(this.usedBounds, cells);
+    } else if (!occupied) {
+      this.usedBoundsStale = true;
+    }
+    if (occupied) {
+      this.cellsSinceClearance += cells.length;
+    } else {
+      this.clearance = null;
+    }
+
+    let minX = this.gridWidth;
+    let maxX = -1;
+    let minY = this.gridHeight;
+    let maxY = -1;
 
     for (const cell of cells) {
       if (cell.x >= 0 && cell.x < this.gridWidth && cell.y >= 0 && cell.y < this.gridHeight) {
-        this.grid[cell.y][cell.x] = true;
+        this.grid[cell.y * this.gridWidth + cell.x] = occupied ? 1 : 0;
+        if (cell.x < minX) minX = cell.x;
+        if (cell.x > maxX) maxX = cell.x;
+        if (cell.y < minY) minY = cell.y;
+        if (cell.y > maxY) maxY = cell.y;
 
         // Track which blocks are affected
         const blockX = Math.floor((cell.x / this.cellsPerInch) / this.blockSize);
@@ -91,6 +347,49 @@ export class RasterGrid {
       const [blockX, blockY] = blockKey.split(',').map(Number);
       this.updateBlockOccupancy(blockX, blockY);
     }
+
+    if (maxX >= 0) {
+      this.updateHeightMap(minX, maxX, minY, maxY, occupied);
+    }
+  }
+
+  /**
+   * Refresh skyline columns and row free runs over the changed cell range
+   */
+  private updateHeightMap(minX: number, maxX: number, minY: number, maxY: number, occupied: boolean): void {
+    const width = this.gridWidth;
+    for (let x = minX; x <= maxX; x++) {
+      // Freed cells can only lower the skyline to the top of the changed range
+      let row = occupied ? this.skyline[x] : Math.min(this.skyline[x], minY);
+      while (row < this.gridHeight && this.grid[row * width + x]) row++;
+      this.skyline[x] = row;
+    }
+
+    for (let y = minY; y <= maxY; y++) {
+      const offset = y * width;
+      let longest = 0;
+      let run = 0;
+      for (let x = 0; x < width; x++) {
+        run = this.grid[offset + x] ? 0 : run + 1;
+        if (run > longest) longest = run;
+      }
+      this.rowFreeRun[y] = longest;
+    }
+  }
+
+  /**
+   * First free row of each column (gridHeight where the column is full)
+   * Every cell above it is occupied, so no footprint cell in that column can sit higher
+   */
+  getSkyline(): Readonly<Int32Array> {
+    return this.skyline;
+  }
+
+  /**
+   * Longest run of free cells in a row (0 outside the sheet)
+   */
+  getRowFreeRun(y: number): number {
+    return y >= 0 && y < this.gridHeight ? this.rowFreeRun[y] : 0;
   }
 
   /**
@@ -112,7 +411,7 @@ export class RasterGrid {
     for (let y = cellStartY; y < cellEndY; y++) {
       for (let x = cellStartX; x < cellEndX; x++) {
         total++;
-        if (this.grid[y][x]) occupied++;
+        if (this.grid[y * this.gridWidth + x]) occupied++;
       }
     }
 
@@ -153,6 +452,146 @@ export class RasterGrid {
     };
   }
 
+  private extendBounds(bounds: CellBounds | null, cells: GridCell[]): CellBounds | null {
+    let { minX, minY, maxX, maxY } = bounds || { minX: Infinity, minY: Infinity, maxX: -Infinity, maxY: -Infinity };
+    for (const cell of cells) {
+      if (cell.x < 0 || cell.x >= this.gridWidth || cell.y < 0 || cell.y >= this.gridHeight) continue;
+      if (cell.x < minX) minX = cell.x;
+      if (cell.x > maxX) maxX = cell.x;
+      if (cell.y < minY) minY = cell.y;
+      if (cell.y > maxY) maxY = cell.y;
+    }
+    return minX <= maxX ? { minX, minY, maxX, maxY } : bounds;
+  }
+
+  /**
+   * Bounding box of all occupied cells (null while the sheet is empty)
+   */
+  getUsedBounds(): CellBounds | null {
+    if (this.usedBoundsStale) {
+      let bounds: CellBounds | null = null;
+      for (let y = 0; y < this.gridHeight; y++) {
+        const row = y * this.gridWidth;
+        for (let x = 0; x < this.gridWidth; x++) {
+          if (!this.grid[row + x]) continue;
+          if (!bounds) {
+            bounds = { minX: x, minY: y, maxX: x, maxY: y };
+          } else {
+            if (x < bounds.minX) bounds.minX = x;
+            if (x > bounds.maxX) bounds.maxX = x;
+            bounds.maxY = y;
+          }
+        }
+      }
+      this.usedBounds = bounds;
+      this.usedBoundsStale = false;
+    }
+    return this.usedBounds;
+  }
+
+  /**
+   * Measure how a candidate footprint sits among its neighbours, in one pass over the flat grid
+   * - perimeter: footprint cell edges facing outside the footprint
+   * - contact: those edges touching an occupied cell or the sheet border
+   * - slivers: free cells trapped in gaps narrower than gapCells between the footprint
+   *   and the next obstacle (space few designs can use)
+   * Read-only: the footprint is tracked in a local set, never written to the grid, so the
+   * call is safe on a grid shared with threads committing placements concurrently
+   */
+  measureFootprint(cells: GridCell[], gapCells: number): FootprintMetrics {
+    const grid = this.grid;
+    const width = this.gridWidth;
+    const height = this.gridHeight;
+    let perimeter = 0;
+    let contact = 0;
+    let slivers = 0;
+
+    const footprint = new Set<number>();
+    for (const cell of cells) footprint.add(cell.y * width + cell.x);
+
+    for (const cell of cells) {
+      for (let d = 0; d < 4; d++) {
+        const dx = NEIGHBOUR_DX[d];
+        const dy = NEIGHBOUR_DY[d];
+        let x = cell.x + dx;
+        let y = cell.y + dy;
+        if (x < 0 || y < 0 || x >= width || y >= height) {
+          perimeter++;
+          contact++;
+          continue;
+        }
+        const index = y * width + x;
+        if (footprint.has(index)) continue;
+        perimeter++;
+        if (grid[index]) {
+          contact++;
+          continue;
+        }
+        // Free neighbour: walk outward until the gap is wide enough to be usable
+        for (let step = 1; step <= gapCells; step++) {
+          x += dx;
+          y += dy;
+          if (x < 0 || y < 0 || x >= width || y >= height) {
+            slivers += step;
+            break;
+          }
+          const next = y * width + x;
+          if (footprint.has(next)) break;
+          if (grid[next]) {
+            slivers += step;
+            break;
+          }
+        }
+      }
+    }
+
+    return { perimeter, contact, slivers };
+  }
+
+  /**
+   * Clearance of a cell in chamfer units (CHAMFER_STRAIGHT per cell step); 0 outside the sheet
+   * The map is rebuilt once enough cells have been marked since the last build
+   */
+  getClearance(x: number, y: number): number {
+    if (x < 0 || x >= this.gridWidth || y < 0 || y >= this.gridHeight) return 0;
+    if (!this.clearance || this.cellsSinceClearance > this.grid.length * CLEARANCE_REFRESH_SHARE) {
+      this.clearance = chamferTransform(this.grid, this.gridWidth, this.gridHeight);
+      this.cellsSinceClearance = 0;
+    }
+    return this.clearance[y * this.gridWidth + x];
+  }
+
+  /**
+   * Independent copy of the grid and its spatial index
+   */
+  clone(): RasterGrid {
+    const copy = Object.create(RasterGrid.prototype) as RasterGrid;
+    Object.assign(copy, this);
+    copy.grid = this.grid.slice();
+    copy.skyline = this.skyline.slice();
+    copy.rowFreeRun = this.rowFreeRun.slice();
+    copy.blockOccupancy = this.blockOccupancy.map(row => [...row]);
+    copy.shared = null;
+    copy.lock = null;
+    return copy;
+  }
+
+  /**
+   * Share of touched spatial-index blocks that are only partly filled (0-1)
+   * Partly filled blocks hold slivers of free space that few designs can use
+   */
+  getFragmentation(): number {
+    let touched = 0;
+    let partial = 0;
+    for (const row of this.blockOccupancy) {
+      for (const occupancy of row) {
+        if (occupancy > 0) touched++;
+        if (occupancy > 0 && occupancy < 100) partial++;
+      }
+    }
+    return touched > 0 ? partial / touched : 0;
+  }
+
   /**
    * Get utilization percentage
    */
@@ -160,7 +599,7 @@ export class RasterGrid {
     let occupied = 0;
     for (let y = 0; y < this.gridHeight; y++) {
       for (let x = 0; x < this.gridWidth; x++) {
-        if (this.grid[y][x]) occupied++;
+        if (this.grid[y * this.gridWidth + x]) occupied++;
       }
     }
     return (occupied / (this.gridWidth * this.gridHeight)) * 100;
@@ -175,62 +614,132 @@ export interface GridCell {
   y: number; // cell y coordinate
 }
 
+/**
+ * ShapeCache: rotated, spacing-offset outlines normalized to their bounding-box corner
+ * Offsetting dominates the cost of trying a position, and the outline only depends on
+ * shape, rotation and spacing, so one cache can serve every position, sheet and stock size
+ */
+export class ShapeCache {
+  private outlines = new WeakMap<Point[], Map<string, unknown>>();
+
+  get<T>(points: Point[], rotation: number, spacing: number, build: () => T): T {
+    let byTransform = this.outlines.get(points);
+    if (!byTransform) {
+      byTransform = new Map();
+      this.outlines.set(points, byTransform);
+    }
+    const key = `${rotation}:${spacing}`;
+    let outline = byTransform.get(key) as T | undefined;
+    if (!outline) {
+      outline = build();
+      byTransform.set(key, outline);
+    }
+    return outline;
+  }
+}
+
 /**
  * PolygonRasterizer: Convert polygon vertices to grid cells
  */
 export class PolygonRasterizer {
   private readonly cellsPerInch: number;
   private readonly geometryService: GeometryService;
+  private readonly shapeCache: ShapeCache;
 
-  constructor(cellsPerInch: number = 100) {
+  constructor(cellsPerInch: number = 100, shapeCache: ShapeCache = new ShapeCache()) {
     this.cellsPerInch = cellsPerInch;
     this.geometryService = new GeometryService();
+    this.shapeCache = shapeCache;
   }
 
   /**
    * Rasterize a polygon at a specific position and rotation
-   * Returns the set of grid cells occupied by the polygon
+   * Returns the set of grid cells occupied by the polygon (interior holes stay free)
    */
   rasterizePolygon(
     points: Point[],
     posX: number, // position in inches
     posY: number, // position in inches
     rotation: number = 0, // rotation in degrees
-    spacing: number = 0 // spacing/margin in inches
+    spacing: number = 0, // spacing/margin in inches
+    holes?: Point[][] // interior holes, same frame as points
   ): GridCell[] {
-    // Step 1: Apply rotation if needed
-    let transformedPoints = points;
+    // Steps 1-2: Rotated + offset rings at the origin (cached per shape/rotation/spacing)
+    const rings = this.shapeCache.get(points, rotation, spacing, () => this.normalizeRings(points, holes, rotation, spacing));
+
+    // Step 3: Translate to position
+    const positionedRings = rings.map(ring => ring.map(p => ({
+      x: p.x + posX,
+      y: p.y + posY,
+    })));
+
+    // Step 4: Rasterize using scan-line algorithm
+    return this.scanlineRasterize(positionedRings);
+  }
+
+  /**
+   * Interior holes of a placed polygon, as sheet regions (inches) other items may use
+   * Holes are shrunk by the spacing; ones too small to keep it vanish
+   */
+  holeRegions(
+    points: Point[],
+    holes: Point[][] | undefined,
+    posX: number,
+    posY: number,
+    rotation: number = 0,
+    spacing: number = 0
+  ): Array<{ minX: number; minY: number; maxX: number; maxY: number; area: number }> {
+    if (!holes || holes.length === 0) return [];
+    const rings = this.shapeCache.get(points, rotation, spacing, () => this.normalizeRings(points, holes, rotation, spacing));
+    return rings.slice(1).map(ring => {
+      const bbox = this.geometryService.getBoundingBox(ring);
+      return {
+        minX: bbox.minX + posX,
+        minY: bbox.minY + posY,
+        maxX: bbox.maxX + posX,
+        maxY: bbox.maxY + posY,
+        area: this.geometryService.calculateArea(ring),
+      };
+    });
+  }
+
+  /**
+   * Rotate, apply spacing, and move the bounding-box corner to (0, 0)
+   * Ring 0 is the outline grown by the spacing; the rest are its holes shrunk by it
+   */
+  private normalizeRings(points: Point[], holes: Point[][] | undefined, rotation: number, spacing: number): Point[][] {
+    // Step 1: Apply rotation if needed (holes turn about the outline's centroid)
+    let outline = points;
+    let holeRings = holes || [];
     if (rotation !== 0) {
-      transformedPoints = this.geometryService.rotatePoints(points, rotation);
+      const center = this.geometryService.calculateCentroid(points);
+      outline = this.geometryService.rotatePoints(points, rotation, center);
+      holeRings = holeRings.map(hole => this.geometryService.rotatePoints(hole, rotation, center));
     }
 
     // Step 2: Apply spacing/margin using offset
     if (spacing > 0) {
-      transformedPoints = this.geometryService.offsetPolygon(transformedPoints, spacing);
+      outline = this.geometryService.offsetPolygon(outline, spacing);
+      holeRings = holeRings.flatMap(hole => this.geometryService.insetPolygon(hole, spacing));
     }
 
-    // Step 3: Translate to position
-    const bbox = this.geometryService.getBoundingBox(transformedPoints);
-    const offsetX = posX - bbox.minX;
-    const offsetY = posY - bbox.minY;
-    const positionedPoints = transformedPoints.map(p => ({
-      x: p.x + offsetX,
-      y: p.y + offsetY,
-    }));
-
-    // Step 4: Rasterize using scan-line algorithm
-    return this.scanlineRasterize(positionedPoints);
+    const bbox = this.geometryService.getBoundingBox(outline);
+    return [outline, ...holeRings.filter(hole => hole.length >= 3)].map(ring => ring.map(p => ({
+      x: p.x - bbox.minX,
+      y: p.y - bbox.minY,
+    })));
   }
 
   /**
    * Scan-line rasterization algorithm
-   * Fills the interior of a polygon by scanning horizontal lines
+   * Fills the interior of a polygon by scanning horizontal lines; crossings of every ring
+   * count (even-odd), so hole rings cut their interiors out of the outline
    */
-  private scanlineRasterize(points: Point[]): GridCell[] {
-    if (points.length < 3) return [];
+  private scanlineRasterize(rings: Point[][]): GridCell[] {
+    if (rings.length === 0 || rings[0].length < 3) return [];
 
     const cells: GridCell[] = [];
-    const bbox = this.geometryService.getBoundingBox(points);
+    const bbox = this.geometryService.getBoundingBox(rings[0]);
 
     // Convert bounds to grid cells
     const minY = Math.floor(bbox.minY * this.cellsPerInch);
@@ -245,16 +754,18 @@ export class PolygonRasterizer {
       // Find intersections of scan line with polygon edges
       const intersections: number[] = [];
 
-      for (let i = 0; i < points.length; i++) {
-        const p1 = points[i];
-        const p2 = points[(i + 1) % points.length];
-
-        // Check if edge crosses scan line
-        if ((p1.y <= scanY && p2.y > scanY) || (p2.y <= scanY && p1.y > scanY)) {
-          // Calculate x coordinate of intersection
-          const t = (scanY - p1.y) / (p2.y - p1.y);
-          const intersectX = p1.x + t * (p2.x - p1.x);
-          intersections.push(intersectX);
+      for (const points of rings) {
+        for (let i = 0; i < points.length; i++) {
+          const p1 = points[i];
+          const p2 = points[(i + 1) % points.length];
+
+          // Check if edge crosses scan line
+          if ((p1.y <= scanY && p2.y > scanY) || (p2.y <= scanY && p1.y > scanY)) {
+            // Calculate x coordinate of intersection
+            const t = (scanY - p1.y) / (p2.y - p1.y);
+            const intersectX = p1.x + t * (p2.x - p1.x);
+            intersections.push(intersectX);
+          }
         }
       }
 
@@ -295,15 +806,188 @@ export class PolygonRasterizer {
   }
 }
 
+/**
+ * Bitmap of the used part of a remnant sheet, stretched over the whole sheet
+ */
+export interface OccupancyMask {
+  width: number;  // pixels
+  height: number; // pixels
+  data: string;   // base64, one byte per pixel, row-major; non-zero = used
+}
+
+/**
+ * Pre-occupied regions of a remnant (partially used) sheet
+ * Polygons are in sheet coordinates: mm at the API, inches inside PolygonPacker
+ */
+export interface SheetObstacles {
+  polygons?: Point[][];
+  mask?: OccupancyMask;
+}
+
+/**
+ * Convert remnant obstacles from mm to inches (masks are resolution-independent)
+ */
+export function toObstaclesInches(obstacles: SheetObstacles, mmPerInch: number = 25.4): SheetObstacles {
+  return {
+    polygons: obstacles.polygons?.map(polygon => polygon.map(p => ({ x: p.x / mmPerInch, y: p.y / mmPerInch }))),
+    mask: obstacles.mask,
+  };
+}
+
 /**
  * Polygon with metadata for packing
  */
 export interface PackablePolygon {
   id: string;
   points: Point[]; // polygon vertices in inches
+  holes?: Point[][]; // interior holes in inches (same frame as points); other items may nest in them
   width: number; // bounding box width
   height: number; // bounding box height
-  area: number; // approximate area
+  area: number; // exact polygon area (shoelace, holes excluded) in sq in
+  hullArea?: number; // convex hull area in sq in
+  perimeter?: number; // outline length in inches
+  solidity?: number; // area / hullArea (1.0 = convex)
+}
+
+/**
+ * Sticker input as received by the packing entry points (all dimensions in mm)
+ */
+export interface PackableSticker {
+  id: string;
+  points: Point[];
+  holes?: Point[][]; // Interior holes traced inside the outline (mm)
+  width: number;
+  height: number;
+  descriptors?: ShapeDescriptors; // Computed at trace time (mm units)
+}
+
+/**
+ * Convert a sticker (mm) into a PackablePolygon (inches)
+ * Reuses shape descriptors computed at trace time when present; otherwise
+ * derives them from the outline so area is never the bounding-box approximation
+ */
+export function toPackablePolygon(sticker: PackableSticker, mmPerInch: number = 25.4): PackablePolygon {
+  const geometryService = new GeometryService();
+  const scale = 1 / mmPerInch;
+
+  const pointsInches = sticker.points.map(p => ({
+    x: p.x * scale,
+    y: p.y * scale,
+  }));
+
+  const descriptors = sticker.descriptors
+    ? geometryService.scaleShapeDescriptors(sticker.descriptors, scale)
+    : geometryService.getShapeDescriptors(pointsInches);
+
+  const widthInches = sticker.width * scale;
+  const heightInches = sticker.height * scale;
+  const holes = sticker.holes
+    ?.filter(hole => hole.length >= 3)
+    .map(hole => hole.map(p => ({ x: p.x * scale, y: p.y * scale })));
+  const holeArea = (holes || []).reduce((sum, hole) => sum + geometryService.calculateArea(hole), 0);
+
+  // Outlines with fewer than 3 points have no area - fall back to the bounding box
+  const outlineArea = descriptors.area > 0 ? descriptors.area : widthInches * heightInches;
+  const area = Math.max(outlineArea - holeArea, 0);
+  const hullArea = descriptors.hullArea > 0 ? descriptors.hullArea : outlineArea;
+
+  return {
+    id: sticker.id,
+    points: pointsInches,
+    ...(holes && holes.length > 0 ? { holes } : {}),
+    width: widthInches,
+    height: heightInches,
+    area,
+    hullArea,
+    perimeter: descriptors.perimeter,
+    solidity: holeArea > 0 ? Math.min(1, area / hullArea) : descriptors.solidity,
+  };
+}
+
+/**
+ * Designs filling at least this share of their bounding box are packed as rectangles
+ * in hybrid mode (extent, not solidity: a circle is convex but wastes ~21% of its box)
+ */
+export const HYBRID_MIN_RECTANGULARITY = 0.9;
+
+/**
+ * What a placement scorer sees for one feasible candidate
+ * (FootprintMetrics and areas in cells, position in inches)
+ */
+export interface PlacementCandidateMetrics extends FootprintMetrics {
+  x: number;
+  y: number;
+  rotation: number;
+  area: number;       // Footprint cells
+  hullGrowth: number; // Cells the candidate adds to the bounding box of the occupied region
+  gapCells: number;   // Widest gap counted as a sliver
+}
+
+/**
+ * Ranks feasible placement candidates; lower is better
+ */
+export type PlacementScorer = (candidate: PlacementCandidateMetrics) => number;
+
+export interface PlacementScoringWeights {
+  contact: number;       // Reward for touching neighbours and sheet edges
+  hullGrowth: number;    // Penalty for enlarging the occupied region
+  fragmentation: number; // Penalty for leaving slivers of free space
+}
+
+export const DEFAULT_SCORING_WEIGHTS: PlacementScoringWeights = {
+  contact: 1,
+  hullGrowth: 1,
+  fragmentation: 0.5,
+};
+
+// Gaps narrower than this between a placement and the next obstacle count as slivers
+const SLIVER_GAP_INCHES = 0.25;
+
+// Feasible candidates ranked per rotation by scored placement
+const SCORED_CANDIDATES_PER_ROTATION = 24;
+
+/**
+ * Weighted sum of normalized terms: contact share of the perimeter, hull growth relative
+ * to the footprint, and sliver cells relative to the perimeter
+ */
+export function createWeightedScorer(weights: Partial<PlacementScoringWeights> = {}): PlacementScorer {
+  const w = { ...DEFAULT_SCORING_WEIGHTS, ...weights };
+  return candidate => {
+    const perimeter = Math.max(1, candidate.perimeter);
+    return (
+      w.hullGrowth * (candidate.hullGrowth / Math.max(1, candidate.area)) -
+      w.contact * (candidate.contact / perimeter) +
+      w.fragmentation * (candidate.slivers / (perimeter * candidate.gapCells))
+    );
+  };
+}
+
+/**
+ * Partial layouts kept per step by beam-search packing
+ */
+export const DEFAULT_BEAM_WIDTH = 3;
+
+/**
+ * Share of the bounding box (at 0°) covered by the polygon
+ */
+export function getRectangularity(polygon: PackablePolygon): number {
+  const bbox = new GeometryService().getBoundingBox(polygon.points);
+  const boxArea = bbox.width * bbox.height;
+  return boxArea > 0 ? Math.min(1, polygon.area / boxArea) : 0;
+}
+
+/**
+ * Identity of a placed footprint (its set of cells, in any order), for spotting duplicate candidates
+ */
+function footprintKey(cells: GridCell[]): string {
+  let sum = 0;
+  let mixed = 0;
+  for (const cell of cells) {
+    const hash = Math.imul(Math.imul(cell.x, 0x9e3779b1) ^ Math.imul(cell.y, 0x85ebca6b), 0x01000193);
+    sum = (sum + hash) | 0;
+    mixed ^= hash;
+  }
+  return `${cells.length}:${sum >>> 0}:${mixed >>> 0}`;
 }
 
 /**
@@ -327,6 +1011,45 @@ export interface PolygonPackingResult {
   performance?: PackingPerformanceMetrics;
 }
 
+/**
+ * One thread's share of a concurrent packing run (see PolygonPacker.packShared)
+ */
+export interface SharedPackingResult extends PolygonPackingResult {
+  conflicts: number; // Commits lost to another thread and searched again
+}
+
+// Searches per item in concurrent placement before it is given up as unplaced
+const MAX_COMMIT_RETRIES = 16;
+
+/**
+ * Claim function for packShared over a shared Int32 counter of the next unclaimed item
+ */
+export function claimFrom(counter: SharedArrayBuffer): () => number {
+  const view = new Int32Array(counter);
+  return () => Atomics.add(view, 0, 1);
+}
+
+/**
+ * Placement from an earlier layout (inches), the starting point for incremental packing
+ */
+export interface PreviousPlacement {
+  id: string;
+  x: number;
+  y: number;
+  rotation: number;
+}
+
+/**
+ * Incremental packing result
+ * keptIds were restored untouched; repackedIds were placed by search
+ */
+export interface IncrementalPackingResult extends PolygonPackingResult {
+  keptIds: string[];
+  repackedIds: string[];
+  density: number;         // Placed area / (sheet width × used length) of the new layout
+  previousDensity: number; // Same measure for the previous layout's surviving items
+}
+
 /**
  * Performance metrics for packing operations
  */
@@ -394,6 +1117,7 @@ export class PolygonPacker {
   private readonly stepSize: number; // position search step size in inches
   private readonly rotations: number[]; // rotation angles to try
   private progressCallback?: ProgressCallback;
+  private placementScorer: PlacementScorer | null = null; // null = first feasible position
 
   constructor(
     widthInches: number,
@@ -402,16 +1126,43 @@ export class PolygonPacker {
     cellsPerInch: number = 100,
     stepSize: number = 0.05,
     rotations: number[] = [0, 90, 180, 270],
-    progressCallback?: ProgressCallback
+    progressCallback?: ProgressCallback,
+    shapeCache?: ShapeCache, // Share across packers (sheets, stock sizes) to reuse outlines
+    grid?: RasterGrid // Pack onto an existing grid, e.g. one shared between threads
   ) {
-    this.grid = new RasterGrid(widthInches, heightInches, cellsPerInch);
-    this.rasterizer = new PolygonRasterizer(cellsPerInch);
+    this.grid = grid ?? new RasterGrid(widthInches, heightInches, cellsPerInch);
+    this.rasterizer = new PolygonRasterizer(cellsPerInch, shapeCache);
     this.spacing = spacing;
     this.stepSize = stepSize;
     this.rotations = rotations;
     this.progressCallback = progressCallback;
   }
 
+  /**
+   * Rank all feasible candidates with a scorer instead of taking the first feasible position
+   * (see createWeightedScorer); null restores first-fit
+   */
+  setPlacementScorer(scorer: PlacementScorer | null): void {
+    this.placementScorer = scorer;
+  }
+
+  /**
+   * Block out the used parts of a remnant sheet before packing (inches)
+   * Blocked cells feed the spatial index, so the search skips used areas cheaply
+   */
+  addObstacles(obstacles: SheetObstacles): void {
+    for (const polygon of obstacles.polygons || []) {
+      if (polygon.length < 3) continue;
+      // Rasterize in place: position is the polygon's own bounding-box corner
+      const xs = polygon.map(p => p.x);
+      const ys = polygon.map(p => p.y);
+      this.grid.markOccupied(this.rasterizer.rasterizePolygon(polygon, Math.min(...xs), Math.min(...ys)));
+    }
+    if (obstacles.mask) {
+      this.grid.markMask(obstacles.mask);
+    }
+  }
+
   /**
    * Pack polygons onto the sheet using rasterization overlay algorithm
    */
@@ -422,7 +1173,7 @@ export class PolygonPacker {
     console.log(`Step size: ${this.stepSize}"`);
     console.log(`Grid resolution: ${this.grid.getDimensions().cellsPerInch} cells/inch`);
 
-    // Sort by area descending (Big Rocks First)
+    // Sort by exact area descending (Big Rocks First)
     const sorted = [...polygons].sort((a, b) => b.area - a.area);
 
     const placements: PolygonPlacement[] = [];
@@ -436,9 +1187,13 @@ export class PolygonPacker {
     let totalPositionsTried = 0;
     let totalRotationsTried = 0;
 
+    // Items already nested inside an earlier design's holes (see fillHoles)
+    const nested = new Set<string>();
+
     // Try to place each polygon
     for (let i = 0; i < sorted.length; i++) {
       const polygon = sorted[i];
+      if (nested.has(polygon.id)) continue;
       const itemStartTime = Date.now();
 
       // Report progress - what we're ABOUT to try
@@ -452,7 +1207,7 @@ export class PolygonPacker {
         });
       }
 
-      console.log(`\n[${i + 1}/${sorted.length}] Placing ${polygon.id} (${(polygon.width * polygon.height).toFixed(2)} sq in)...`);
+      console.log(`\n[${i + 1}/${sorted.length}] Placing ${polygon.id} (${polygon.area.toFixed(2)} sq in)...`);
 
       // Yield to event loop to allow messages to be sent
       await new Promise(resolve => setImmediate(resolve));
@@ -488,6 +1243,23 @@ export class PolygonPacker {
 
         // Yield to event loop after placing to send the placement message
         await new Promise(resolve => setImmediate(resolve));
+
+        // Fast path: the holes this design leaves go to the smallest remaining items first
+        if (polygon.holes) {
+          const remaining = sorted.slice(i + 1).filter(p => !nested.has(p.id));
+          for (const placement of this.fillHoles(polygon, result.placement, remaining)) {
+            nested.add(placement.id);
+            placements.push(placement);
+            this.progressCallback?.({
+              current: i + 1,
+              total: sorted.length,
+              itemId: placement.id,
+              status: 'placed',
+              message: `Placed ${placement.id} inside ${polygon.id}`,
+              placement,
+            });
+          }
+        }
       } else {
         unplaced.push(polygon);
         failures.push(result.failure!);
@@ -555,6 +1327,396 @@ export class PolygonPacker {
     };
   }
 
+  /**
+   * Hybrid packing: near-rectangular designs are laid out by MaxRects free-rectangle
+   * packing (no raster search) and registered in the grid; irregular designs, and any
+   * rectangle MaxRects could not fit, then go through the raster search into what is left
+   */
+  async packHybrid(
+    polygons: PackablePolygon[],
+    trackPerformance: boolean = false,
+    minRectangularity: number = HYBRID_MIN_RECTANGULARITY
+  ): Promise<PolygonPackingResult> {
+    interface RectItem extends IRectangle {
+      polygon: PackablePolygon;
+    }
+
+    const geometryService = new GeometryService();
+    const gridDims = this.grid.getDimensions();
+    const rectangular = this.rotations.includes(0)
+      ? polygons.filter(p => getRectangularity(p) >= minRectangularity)
+      : [];
+    const remaining = polygons.filter(p => !rectangular.includes(p));
+
+    // Slots hold the spacing offset on both sides, plus two cells for outward rounding
+    // in rasterization so neighbouring slots never share a cell
+    const margin = 2 * this.spacing + 2 / gridDims.cellsPerInch;
+    const quarterTurn = this.rotations.find(r => r === 90 || r === 270);
+
+    const maxRects = new MaxRectsPacker<RectItem>(gridDims.width, gridDims.height, 0, {
+      smart: true,
+      pot: false,
+      square: false,
+      allowRotation: quarterTurn !== undefined,
+      border: 0,
+    });
+    for (const polygon of rectangular) {
+      const bbox = geometryService.getBoundingBox(polygon.points);
+      maxRects.add({ x: 0, y: 0, width: bbox.width + margin, height: bbox.height + margin, polygon } as RectItem);
+    }
+
+    const rectPlacements: PolygonPlacement[] = [];
+    const firstBin = maxRects.bins[0];
+    const placedRects = new Set<PackablePolygon>();
+    for (const rect of (firstBin?.rects || []) as RectItem[]) {
+      const rotation = rect.rot ? quarterTurn! : 0;
+      const cells = this.rasterizer.rasterizePolygon(rect.polygon.points, rect.x, rect.y, rotation, this.spacing, rect.polygon.holes);
+      if (this.grid.checkCollision(cells)) continue; // Raster search will find it a spot
+
+      this.grid.markOccupied(cells);
+      const placement = { id: rect.polygon.id, x: rect.x, y: rect.y, rotation, cells };
+      rectPlacements.push(placement);
+      placedRects.add(rect.polygon);
+
+      this.progressCallback?.({
+        current: rectPlacements.length,
+        total: polygons.length,
+        itemId: placement.id,
+        status: 'placed',
+        message: `Placed ${placement.id} at (${placement.x.toFixed(2)}, ${placement.y.toFixed(2)})`,
+        placement,
+      });
+    }
+    remaining.push(...rectangular.filter(p => !placedRects.has(p)));
+
+    console.log(
+      `[Hybrid] ${rectPlacements.length}/${rectangular.length} near-rectangular designs placed by MaxRects, ` +
+      `${remaining.length} left for raster search`
+    );
+
+    const result: PolygonPackingResult = remaining.length > 0
+      ? await this.pack(remaining, trackPerformance)
+      : { placements: [], utilization: 0, unplacedPolygons: [] };
+    return {
+      ...result,
+      placements: [...rectPlacements, ...result.placements],
+      utilization: this.grid.getUtilization(),
+    };
+  }
+
+  /**
+   * Beam-search packing: instead of committing greedily to the first spot for each item,
+   * keep the beamWidth best partial layouts and extend each with the next item at its
+   * first feasible spot per distinct footprint (rotations that land on the same cells
+   * count once). Candidates are ranked by unplaced area, then by used sheet length (skyline
+   * height) inflated by their branch's block fragmentation, so a branch that leaves slivers
+   * of unusable space loses to one that packs tight; only the beamWidth survivors copy the
+   * grid. Costs roughly beamWidth × rotations greedy packs; beamWidth 1 is a greedy pack
+   * that picks the best-scoring rotation rather than the first that fits
+   */
+  async packBeam(
+    polygons: PackablePolygon[],
+    beamWidth: number = DEFAULT_BEAM_WIDTH,
+    trackPerformance: boolean = false
+  ): Promise<PolygonPackingResult> {
+    interface BeamState {
+      grid: RasterGrid;
+      placements: PolygonPlacement[];
+      unplaced: PackablePolygon[];
+      unplacedArea: number;
+      usedCells: number; // Furthest occupied row (skyline height, in cells)
+      score: number;
+    }
+    // A branch extended by one placement (null = item left out), ranked before its grid is copied
+    interface BeamCandidate {
+      parent: BeamState;
+      placement: PolygonPlacement | null;
+      unplacedArea: number;
+      usedCells: number;
+      score: number;
+    }
+
+    const sorted = [...polygons].sort((a, b) => b.area - a.area);
+    const gridDims = this.grid.getDimensions();
+    const startTime = Date.now();
+    let totalPositionsTried = 0;
+    let totalRotationsTried = 0;
+
+    let beam: BeamState[] = [{
+      grid: this.grid, placements: [], unplaced: [], unplacedArea: 0, usedCells: 0, score: 0,
+    }];
+
+    for (let i = 0; i < sorted.length; i++) {
+      const polygon = sorted[i];
+      const candidates: BeamCandidate[] = [];
+
+      for (const state of beam) {
+        // Used length inflated by the branch's fragmentation (known before the item goes in)
+        const fragmentation = 1 + state.grid.getFragmentation();
+        // Symmetric designs give the same footprint for several rotations: keep one of each
+        const footprints = new Set<string>();
+        for (const rotation of this.rotations) {
+          const result = this.findPlacement(polygon, gridDims, state.grid, [rotation]);
+          totalPositionsTried += result.positionsTried;
+          totalRotationsTried++;
+          if (!result.placement) continue;
+
+          const key = footprintKey(result.placement.cells);
+          if (footprints.has(key)) continue;
+          footprints.add(key);
+
+          const lowestRow = result.placement.cells.reduce((max, c) => Math.max(max, c.y + 1), 0);
+          const usedCells = Math.max(state.usedCells, lowestRow);
+          candidates.push({
+            parent: state,
+            placement: result.placement,
+            unplacedArea: state.unplacedArea,
+            usedCells,
+            score: usedCells * fragmentation,
+          });
+        }
+
+        if (footprints.size === 0) {
+          // No rotation fits in this branch - carry it forward without the item
+          candidates.push({
+            parent: state,
+            placement: null,
+            unplacedArea: state.unplacedArea + polygon.area,
+            usedCells: state.usedCells,
+            score: state.score,
+          });
+        }
+      }
+
+      // Only the survivors get a grid of their own
+      candidates.sort((a, b) => a.unplacedArea - b.unplacedArea || a.score - b.score);
+      beam = candidates.slice(0, Math.max(1, beamWidth)).map(({ parent, placement, unplacedArea, usedCells, score }) => {
+        if (!placement) {
+          return { ...parent, unplaced: [...parent.unplaced, polygon], unplacedArea };
+        }
+        const grid = parent.grid.clone();
+        grid.markOccupied(placement.cells);
+        return { grid, placements: [...parent.placements, placement], unplaced: parent.unplaced, unplacedArea, usedCells, score };
+      });
+
+      this.progressCallback?.({
+        current: i + 1,
+        total: sorted.length,
+        itemId: polygon.id,
+        status: 'trying',
+        message: `Beam search: ${i + 1}/${sorted.length} items, ${beam.length} branches kept`,
+      });
+
+      // Yield to event loop to allow messages to be sent
+      await new Promise(resolve => setImmediate(resolve));
+    }
+
+    const best = beam[0];
+    for (const placement of best.placements) {
+      this.grid.markOccupied(placement.cells);
+      this.progressCallback?.({
+        current: sorted.length,
+        total: sorted.length,
+        itemId: placement.id,
+        status: 'placed',
+        message: `Placed ${placement.id} at (${placement.x.toFixed(2)}, ${placement.y.toFixed(2)})`,
+        placement,
+      });
+    }
+
+    const totalTime = Date.now() - startTime;
+    console.log(
+      `[Beam] width ${beamWidth}: placed ${best.placements.length}/${polygons.length}, ` +
+      `used length ${(best.usedCells / gridDims.cellsPerInch).toFixed(2)}", ${totalTime}ms`
+    );
+
+    return {
+      placements: best.placements,
+      utilization: this.grid.getUtilization(),
+      unplacedPolygons: best.unplaced,
+      performance: trackPerformance ? {
+        totalTimeMs: totalTime,
+        totalTimeSec: totalTime / 1000,
+        itemCount: polygons.length,
+        avgTimePerItemMs: polygons.length > 0 ? totalTime / polygons.length : 0,
+        totalPositionsTried,
+        totalRotationsTried,
+        successfulPlacements: best.placements.length,
+        failedPlacements: best.unplaced.length,
+        rotationCount: this.rotations.length,
+        stepSize: this.stepSize,
+        cellsPerInch: gridDims.cellsPerInch,
+        gridWidth: gridDims.width,
+        gridHeight: gridDims.height,
+      } : undefined,
+    };
+  }
+
+  /**
+   * Optimistic concurrent placement onto a grid shared between threads (RasterGrid.createShared)
+   * Each thread runs its own packer over the same sorted item list and claims the next item
+   * index through `claim` (a shared atomic counter). Searches run against the live grid without
+   * holding any lock; a placement is kept only if tryCommit finds its cells still free. On a
+   * conflict another thread got there first, so the indexes are rebuilt from the grid and the
+   * item is searched again. Commit order varies between runs, so layouts are not deterministic
+   */
+  async packShared(sorted: PackablePolygon[], claim: () => number): Promise<SharedPackingResult> {
+    const gridDims = this.grid.getDimensions();
+    const placements: PolygonPlacement[] = [];
+    const unplaced: PackablePolygon[] = [];
+    let conflicts = 0;
+
+    for (let index = claim(); index < sorted.length; index = claim()) {
+      const polygon = sorted[index];
+      let placed: PolygonPlacement | null = null;
+
+      for (let attempt = 0; attempt <= MAX_COMMIT_RETRIES; attempt++) {
+        const result = this.findPlacement(polygon, gridDims);
+        if (!result.placement) break;
+        if (this.grid.tryCommit(result.placement.cells)) {
+          placed = result.placement;
+          break;
+        }
+        conflicts++;
+        this.grid.refreshIndexes();
+      }
+
+      if (placed) {
+        placements.push(placed);
+        this.progressCallback?.({
+          current: index + 1,
+          total: sorted.length,
+          itemId: polygon.id,
+          status: 'placed',
+          message: `Placed ${polygon.id} at (${placed.x.toFixed(2)}, ${placed.y.toFixed(2)})`,
+          placement: placed,
+        });
+      } else {
+        unplaced.push(polygon);
+      }
+
+      // Yield to event loop to allow messages to be sent
+      await new Promise(resolve => setImmediate(resolve));
+    }
+
+    return {
+      placements,
+      utilization: this.grid.getUtilization(),
+      unplacedPolygons: unplaced,
+      conflicts,
+    };
+  }
+
+  /**
+   * Re-pack after a small edit, starting from a previous layout
+   * - Placements of unchanged polygons are restored as-is (previous IDs not in `polygons` are dropped)
+   * - Changed polygons stay anchored at their old position when they still fit; otherwise the
+   *   neighbours they now overlap are lifted off the grid and re-placed with the changed polygon
+   * - New polygons and anything lifted are placed by the normal search, largest first
+   * Callers compare density against previousDensity to decide whether a full pack is worth it
+   */
+  async packIncremental(
+    polygons: PackablePolygon[],
+    previous: PreviousPlacement[],
+    changedIds: string[]
+  ): Promise<IncrementalPackingResult> {
+    const polygonsById = new Map(polygons.map(p => [p.id, p]));
+    const changed = new Set(changedIds);
+    const gridDims = this.grid.getDimensions();
+
+    const kept = new Map<string, PolygonPlacement>();
+    const anchors: PreviousPlacement[] = [];
+    const toRepack: PackablePolygon[] = [];
+
+    // Step 1: Restore every unchanged placement
+    for (const prev of previous) {
+      const polygon = polygonsById.get(prev.id);
+      if (!polygon || kept.has(prev.id)) continue;
+      if (changed.has(prev.id)) {
+        anchors.push(prev);
+        continue;
+      }
+      const cells = this.rasterizer.rasterizePolygon(polygon.points, prev.x, prev.y, prev.rotation, this.spacing, polygon.holes);
+      if (this.grid.checkCollision(cells)) {
+        // Layout was made with other settings (sheet size, spacing) - search for it instead
+        toRepack.push(polygon);
+        continue;
+      }
+      this.grid.markOccupied(cells);
+      kept.set(prev.id, { id: prev.id, x: prev.x, y: prev.y, rotation: prev.rotation, cells });
+    }
+
+    // Step 2: Changed polygons keep their spot, evicting the neighbours they grew into
+    const placements: PolygonPlacement[] = [];
+    for (const prev of anchors) {
+      const polygon = polygonsById.get(prev.id)!;
+      const cells = this.rasterizer.rasterizePolygon(polygon.points, prev.x, prev.y, prev.rotation, this.spacing, polygon.holes);
+      if (!this.grid.isWithinBounds(cells)) {
+        // Grew past the sheet edge - it has to move
+        toRepack.push(polygon);
+        continue;
+      }
+
+      if (this.grid.checkCollision(cells)) {
+        const footprint = new Set(cells.map(c => `${c.x},${c.y}`));
+        for (const [id, placement] of kept) {
+          if (placement.cells.some(c => footprint.has(`${c.x},${c.y}`))) {
+            this.grid.markFree(placement.cells);
+            kept.delete(id);
+            toRepack.push(polygonsById.get(id)!);
+          }
+        }
+        if (this.grid.checkCollision(cells)) {
+          // Overlaps another changed polygon anchored before it
+          toRepack.push(polygon);
+          continue;
+        }
+      }
+
+      this.grid.markOccupied(cells);
+      placements.push({ id: prev.id, x: prev.x, y: prev.y, rotation: prev.rotation, cells });
+    }
+
+    // Step 3: New polygons, plus everything invalidated above
+    const placedIds = new Set([...kept.keys(), ...placements.map(p => p.id)]);
+    for (const polygon of polygons) {
+      if (!placedIds.has(polygon.id) && !toRepack.includes(polygon)) {
+        toRepack.push(polygon);
+      }
+    }
+
+    const unplaced: PackablePolygon[] = [];
+    const repackedIds: string[] = [];
+    for (const polygon of [...toRepack].sort((a, b) => b.area - a.area)) {
+      const result = this.findPlacement(polygon, gridDims);
+      if (result.placement) {
+        this.grid.markOccupied(result.placement.cells);
+        placements.push(result.placement);
+        repackedIds.push(polygon.id);
+      } else {
+        unplaced.push(polygon);
+      }
+    }
+
+    const allPlacements = [...kept.values(), ...placements];
+    const survivors = previous.filter(p => polygonsById.has(p.id));
+
+    console.log(
+      `[Incremental] Kept ${kept.size}, re-placed ${repackedIds.length}, unplaced ${unplaced.length} ` +
+      `(${toRepack.length} invalidated of ${polygons.length})`
+    );
+
+    return {
+      placements: allPlacements,
+      utilization: this.grid.getUtilization(),
+      unplacedPolygons: unplaced,
+      keptIds: [...kept.keys()],
+      repackedIds,
+      density: layoutDensity(allPlacements, polygonsById, gridDims.width),
+      previousDensity: layoutDensity(survivors, polygonsById, gridDims.width),
+    };
+  }
+
   /**
    * Find a valid placement for a polygon
    * Tries different positions and rotations using optimized search strategies:
@@ -564,18 +1726,24 @@ export class PolygonPacker {
    */
   private findPlacement(
     polygon: PackablePolygon,
-    gridDims: { width: number; height: number }
+    gridDims: { width: number; height: number },
+    grid: RasterGrid = this.grid,
+    rotations: number[] = this.rotations
   ): {
     placement: PolygonPlacement | null;
     positionsTried: number;
     failure?: PlacementFailure;
   } {
+    if (this.placementScorer) {
+      return this.findScoredPlacement(polygon, gridDims, grid, rotations, this.placementScorer);
+    }
+
     let positionsTried = 0;
     let rotationsTried = 0;
     const geometryService = new GeometryService();
 
     // Try each rotation
-    for (const rotation of this.rotations) {
+    for (const rotation of rotations) {
       rotationsTried++;
 
       // Get rotated bounding box to limit search space
@@ -592,8 +1760,8 @@ export class PolygonPacker {
       const smartPositions = this.getSmartStartingPositions(bbox, gridDims);
       for (const pos of smartPositions) {
         positionsTried++;
-        const cells = this.rasterizer.rasterizePolygon(polygon.points, pos.x, pos.y, rotation, this.spacing);
-        if (!this.grid.checkCollision(cells)) {
+        const cells = this.rasterizer.rasterizePolygon(polygon.points, pos.x, pos.y, rotation, this.spacing, polygon.holes);
+        if (!grid.checkCollision(cells)) {
           return {
             placement: { id: polygon.id, x: pos.x, y: pos.y, rotation, cells },
             positionsTried,
@@ -609,7 +1777,8 @@ export class PolygonPacker {
         bbox,
         gridDims,
         coarseStep,
-        positionsTried
+        positionsTried,
+        grid
       );
 
       if (result.placement) {
@@ -618,8 +1787,24 @@ export class PolygonPacker {
       positionsTried = result.positionsTried;
     }
 
-    // No valid placement found - determine reason
-    const currentUtilization = this.grid.getUtilization();
+    return {
+      placement: null,
+      positionsTried,
+      failure: this.placementFailure(polygon, gridDims, grid, positionsTried, rotationsTried),
+    };
+  }
+
+  /**
+   * Explain why no valid placement was found
+   */
+  private placementFailure(
+    polygon: PackablePolygon,
+    gridDims: { width: number; height: number },
+    grid: RasterGrid,
+    positionsTried: number,
+    rotationsTried: number
+  ): PlacementFailure {
+    const currentUtilization = grid.getUtilization();
     let reason: string;
 
     if (polygon.width > gridDims.width || polygon.height > gridDims.height) {
@@ -633,18 +1818,136 @@ export class PolygonPacker {
     }
 
     return {
-      placement: null,
+      polygonId: polygon.id,
       positionsTried,
-      failure: {
-        polygonId: polygon.id,
-        positionsTried,
-        rotationsTried,
-        gridUtilization: currentUtilization,
-        reason,
-      },
+      rotationsTried,
+      gridUtilization: currentUtilization,
+      reason,
     };
   }
 
+  /**
+   * Scored placement: collect feasible candidates per rotation (smart positions, then the
+   * coarse lattice in scan order, up to SCORED_CANDIDATES_PER_ROTATION), rank them with the
+   * placement scorer, then slide the winner toward the origin while it stays collision-free
+   * and does not score worse. The candidate cap keeps the cost within a small factor of first-fit
+   */
+  private findScoredPlacement(
+    polygon: PackablePolygon,
+    gridDims: { width: number; height: number },
+    grid: RasterGrid,
+    rotations: number[],
+    scorer: PlacementScorer
+  ): {
+    placement: PolygonPlacement | null;
+    positionsTried: number;
+    failure?: PlacementFailure;
+  } {
+    const geometryService = new GeometryService();
+    const gapCells = Math.max(1, Math.round(SLIVER_GAP_INCHES * grid.getDimensions().cellsPerInch));
+    const usedBounds = grid.getUsedBounds();
+    let positionsTried = 0;
+    let rotationsTried = 0;
+    let best: { placement: PolygonPlacement; score: number } | null = null;
+
+    const evaluate = (x: number, y: number, rotation: number, cells: GridCell[]) => {
+      const bounds: CellBounds = { minX: Infinity, minY: Infinity, maxX: -Infinity, maxY: -Infinity };
+      for (const cell of cells) {
+        if (cell.x < bounds.minX) bounds.minX = cell.x;
+        if (cell.x > bounds.maxX) bounds.maxX = cell.x;
+        if (cell.y < bounds.minY) bounds.minY = cell.y;
+        if (cell.y > bounds.maxY) bounds.maxY = cell.y;
+      }
+      const box = (b: CellBounds) => (b.maxX - b.minX + 1) * (b.maxY - b.minY + 1);
+      const hullGrowth = usedBounds
+        ? box({
+            minX: Math.min(usedBounds.minX, bounds.minX),
+            minY: Math.min(usedBounds.minY, bounds.minY),
+            maxX: Math.max(usedBounds.maxX, bounds.maxX),
+            maxY: Math.max(usedBounds.maxY, bounds.maxY),
+          }) - box(usedBounds)
+        : box(bounds);
+      return scorer({
+        ...grid.measureFootprint(cells, gapCells),
+        x,
+        y,
+        rotation,
+        area: cells.length,
+        hullGrowth,
+        gapCells,
+      });
+    };
+
+    for (const rotation of rotations) {
+      rotationsTried++;
+      const rotatedPoints =
+        rotation !== 0 ? geometryService.rotatePoints(polygon.points, rotation) : polygon.points;
+      const bbox = geometryService.getBoundingBox(rotatedPoints);
+      if (bbox.width > gridDims.width || bbox.height > gridDims.height) {
+        continue;
+      }
+
+      const maxX = gridDims.width - bbox.width;
+      const maxY = gridDims.height - bbox.height;
+      const coarseStep = Math.max(this.stepSize * 10, 0.5);
+      const profile = this.footprintProfile(polygon, rotation);
+      const positions = this.getSmartStartingPositions(bbox, gridDims);
+      for (let y = this.firstCandidateRow(grid, profile, coarseStep); y <= maxY; y += coarseStep) {
+        if (!this.rowMayFit(grid, profile, y)) continue;
+        for (let x = 0; x <= maxX; x += coarseStep) {
+          if (this.belowSkyline(grid, profile, x, y) && this.clearanceDeficit(grid, profile, x, y) === 0) {
+            positions.push({ x, y });
+          }
+        }
+      }
+
+      const seen = new Set<string>();
+      let feasible = 0;
+      for (const pos of positions) {
+        if (feasible >= SCORED_CANDIDATES_PER_ROTATION) break;
+        const key = `${pos.x},${pos.y}`;
+        if (seen.has(key) || grid.isRegionMostlyFull(pos.x, pos.y, bbox.width, bbox.height)) continue;
+        seen.add(key);
+
+        positionsTried++;
+        const cells = this.rasterizer.rasterizePolygon(polygon.points, pos.x, pos.y, rotation, this.spacing, polygon.holes);
+        if (grid.checkCollision(cells)) continue;
+
+        feasible++;
+        const score = evaluate(pos.x, pos.y, rotation, cells);
+        if (!best || score < best.score) {
+          best = { placement: { id: polygon.id, x: pos.x, y: pos.y, rotation, cells }, score };
+        }
+      }
+    }
+
+    if (!best) {
+      return {
+        placement: null,
+        positionsTried,
+        failure: this.placementFailure(polygon, gridDims, grid, positionsTried, rotationsTried),
+      };
+    }
+
+    // Lattice positions float a little off their neighbours - slide up, then left
+    for (const [dx, dy] of [[0, -this.stepSize], [-this.stepSize, 0]]) {
+      for (;;) {
+        const { x, y, rotation } = best.placement;
+        const nx = x + dx;
+        const ny = y + dy;
+        if (nx < 0 || ny < 0) break;
+        positionsTried++;
+        const cells = this.rasterizer.rasterizePolygon(polygon.points, nx, ny, rotation, this.spacing, polygon.holes);
+        if (grid.checkCollision(cells)) break;
+        const score = evaluate(nx, ny, rotation, cells);
+        if (score > best.score) break;
+        best = { placement: { id: polygon.id, x: nx, y: ny, rotation, cells }, score };
+      }
+    }
+
+    return { placement: best.placement, positionsTried };
+  }
+
   /**
    * Get smart starting positions to try first
    * Prioritizes corners and edges where shapes often fit well
@@ -700,7 +2003,8 @@ export class PolygonPacker {
     bbox: { width: number; height: number },
     gridDims: { width: number; height: number },
     coarseStep: number,
-    initialPositionsTried: number
+    initialPositionsTried: number,
+    grid: RasterGrid = this.grid
   ): {
     placement: PolygonPlacement | null;
     positionsTried: number;
@@ -708,22 +2012,33 @@ export class PolygonPacker {
     let positionsTried = initialPositionsTried;
     const maxX = gridDims.width - bbox.width;
     const maxY = gridDims.height - bbox.height;
+    const profile = this.footprintProfile(polygon, rotation);
+
+    // Phase 1: Coarse search (0.5" steps) with height-map and spatial index pruning
+    for (let y = this.firstCandidateRow(grid, profile, coarseStep); y <= maxY; y += coarseStep) {
+      // OPTIMIZATION: Skip the whole row if no free run is wide enough for the footprint
+      if (!this.rowMayFit(grid, profile, y)) continue;
 
-    // Phase 1: Coarse search (0.5" steps) with spatial index pruning
-    for (let y = 0; y <= maxY; y += coarseStep) {
       for (let x = 0; x <= maxX; x += coarseStep) {
-        // OPTIMIZATION: Skip this position if spatial index indicates region is mostly full
-        if (this.grid.isRegionMostlyFull(x, y, bbox.width, bbox.height)) {
+        // OPTIMIZATION: Too little clearance for the inscribed circle - jump past the deficit
+        const deficit = this.clearanceDeficit(grid, profile, x, y);
+        if (deficit > 0) {
+          x += (Math.ceil(deficit / coarseStep) - 1) * coarseStep;
+          continue;
+        }
+
+        // OPTIMIZATION: Skip positions above the skyline, then regions that are mostly full
+        if (!this.belowSkyline(grid, profile, x, y) || grid.isRegionMostlyFull(x, y, bbox.width, bbox.height)) {
           continue; // Skip expensive rasterization
         }
 
         positionsTried++;
-        const cells = this.rasterizer.rasterizePolygon(polygon.points, x, y, rotation, this.spacing);
+        const cells = this.rasterizer.rasterizePolygon(polygon.points, x, y, rotation, this.spacing, polygon.holes);
 
-        if (!this.grid.checkCollision(cells)) {
+        if (!grid.checkCollision(cells)) {
           // Found valid position at coarse resolution
           // Try to refine it for better placement
-          const refined = this.refinePosition(polygon, rotation, x, y, this.stepSize, bbox, gridDims);
+          const refined = this.refinePosition(polygon, rotation, x, y, this.stepSize, bbox, gridDims, grid);
           positionsTried += refined.positionsTried;
 
           return {
@@ -743,6 +2058,213 @@ export class PolygonPacker {
     return { placement: null, positionsTried };
   }
 
+  /**
+   * Rasterize the footprint once at the origin and record what height-map pruning needs
+   */
+  private footprintProfile(polygon: PackablePolygon, rotation: number): FootprintProfile {
+    const cells = this.rasterizer.rasterizePolygon(polygon.points, 0, 0, rotation, this.spacing, polygon.holes);
+    let minX = Infinity;
+    let minY = Infinity;
+    let maxX = -Infinity;
+    let maxY = -Infinity;
+    for (const cell of cells) {
+      if (cell.x < minX) minX = cell.x;
+      if (cell.x > maxX) maxX = cell.x;
+      if (cell.y < minY) minY = cell.y;
+      if (cell.y > maxY) maxY = cell.y;
+    }
+    if (cells.length === 0) {
+      return {
+        originX: 0, originY: 0, columnTops: new Int32Array(0), highestTop: 0, widestRow: 0, widestRun: 0,
+        centerX: 0, centerY: 0, inscribedRadius: 0,
+      };
+    }
+
+    const width = maxX - minX + 1;
+    const height = maxY - minY + 1;
+    const mask = new Uint8Array(width * height);
+    const columnTops = new Int32Array(width).fill(EMPTY_COLUMN);
+    for (const cell of cells) {
+      const cx = cell.x - minX;
+      const cy = cell.y - minY;
+      mask[cy * width + cx] = 1;
+      if (cy < columnTops[cx]) columnTops[cx] = cy;
+    }
+
+    let highestTop = 0;
+    for (const top of columnTops) {
+      if (top !== EMPTY_COLUMN && top > highestTop) highestTop = top;
+    }
+
+    let widestRow = 0;
+    let widestRun = 0;
+    for (let y = 0; y < height; y++) {
+      let run = 0;
+      for (let x = 0; x < width; x++) {
+        run = mask[y * width + x] ? run + 1 : 0;
+        if (run > widestRun) {
+          widestRun = run;
+          widestRow = y;
+        }
+      }
+    }
+
+    // Inscribed circle: the footprint cell furthest from anything outside the footprint
+    const outside = new Uint8Array(mask.length);
+    for (let i = 0; i < mask.length; i++) outside[i] = mask[i] ? 0 : 1;
+    const inside = chamferTransform(outside, width, height);
+    let center = 0;
+    for (let i = 1; i < inside.length; i++) {
+      if (inside[i] > inside[center]) center = i;
+    }
+
+    return {
+      originX: minX,
+      originY: minY,
+      columnTops,
+      highestTop,
+      widestRow,
+      widestRun,
+      centerX: center % width,
+      centerY: Math.floor(center / width),
+      inscribedRadius: inside[center],
+    };
+  }
+
+  /**
+   * How far (inches) the anchor must move before the footprint's inscribed circle could clear
+   * nearby obstacles; 0 when the clearance map does not rule the position out.
+   * Clearance changes by at most CHAMFER_STRAIGHT per cell moved along a row
+   */
+  private clearanceDeficit(grid: RasterGrid, profile: FootprintProfile, x: number, y: number): number {
+    // One cell of rounding slack, which may be diagonal
+    const required = profile.inscribedRadius - HEIGHT_MAP_SLACK * CHAMFER_DIAGONAL;
+    if (required <= 0) return 0;
+
+    const cellsPerInch = grid.getDimensions().cellsPerInch;
+    const clearance = grid.getClearance(
+      profile.originX + Math.round(x * cellsPerInch) + profile.centerX,
+      profile.originY + Math.round(y * cellsPerInch) + profile.centerY
+    );
+    if (clearance >= required) return 0;
+
+    const cells = Math.ceil((required - clearance) / CHAMFER_STRAIGHT) - HEIGHT_MAP_SLACK;
+    return Math.max(Number.EPSILON, cells / cellsPerInch);
+  }
+
+  /**
+   * First lattice row worth probing: every column above the lowest skyline is full, so the
+   * footprint cannot start higher than that minus its deepest column top
+   */
+  private firstCandidateRow(grid: RasterGrid, profile: FootprintProfile, step: number): number {
+    const skyline = grid.getSkyline();
+    let lowest = Infinity;
+    for (const row of skyline) {
+      if (row < lowest) lowest = row;
+    }
+    const cellsPerInch = grid.getDimensions().cellsPerInch;
+    const firstCell = lowest - profile.originY - profile.highestTop - HEIGHT_MAP_SLACK;
+    return Math.max(0, Math.floor(firstCell / cellsPerInch / step) * step);
+  }
+
+  /**
+   * False when some row the footprint's widest span would land on has no free run long enough
+   */
+  private rowMayFit(grid: RasterGrid, profile: FootprintProfile, y: number): boolean {
+    const row = profile.originY + Math.round(y * grid.getDimensions().cellsPerInch) + profile.widestRow;
+    const run = Math.max(grid.getRowFreeRun(row - 1), grid.getRowFreeRun(row), grid.getRowFreeRun(row + 1));
+    return run >= profile.widestRun - 2 * HEIGHT_MAP_SLACK;
+  }
+
+  /**
+   * False when some footprint column would start above its sheet column's skyline
+   * (those cells are known to be occupied, so the position cannot be collision-free)
+   */
+  private belowSkyline(grid: RasterGrid, profile: FootprintProfile, x: number, y: number): boolean {
+    const skyline = grid.getSkyline();
+    const cellsPerInch = grid.getDimensions().cellsPerInch;
+    const left = profile.originX + Math.round(x * cellsPerInch);
+    const top = profile.originY + Math.round(y * cellsPerInch);
+    const last = skyline.length - 1;
+
+    for (let c = 0; c < profile.columnTops.length; c++) {
+      if (profile.columnTops[c] === EMPTY_COLUMN) continue;
+      // Neighbouring columns too: rasterization rounds sub-cell offsets either way
+      const col = left + c;
+      const lowest = Math.min(
+        skyline[Math.max(0, Math.min(last, col - 1))],
+        skyline[Math.max(0, Math.min(last, col))],
+        skyline[Math.max(0, Math.min(last, col + 1))]
+      );
+      if (top + profile.columnTops[c] + HEIGHT_MAP_SLACK < lowest) return false;
+    }
+    return true;
+  }
+
+  /**
+   * Offer the holes of a just-placed design to the remaining items, smallest first
+   * Each hole is searched on the step lattice over its (spacing-inset) bounding box only,
+   * which finds interior slots the sheet-wide search would reach late or prune as a
+   * mostly-full region. Placed items are marked on the grid
+   */
+  private fillHoles(host: PackablePolygon, placement: PolygonPlacement, remaining: PackablePolygon[]): PolygonPlacement[] {
+    const regions = this.rasterizer.holeRegions(
+      host.points, host.holes, placement.x, placement.y, placement.rotation, this.spacing
+    );
+    const candidates = [...remaining].sort((a, b) => a.area - b.area);
+    const placed: PolygonPlacement[] = [];
+    const used = new Set<string>();
+
+    for (const region of regions) {
+      let freeArea = region.area;
+      const misfits = new Set<string>(); // Designs that found no slot in this hole
+      for (const candidate of candidates) {
+        if (candidate.area > freeArea) break;
+        const shapeKey = `${candidate.width.toFixed(4)}x${candidate.height.toFixed(4)}:${candidate.area.toFixed(4)}`;
+        if (used.has(candidate.id) || misfits.has(shapeKey)) continue;
+
+        const slot = this.findHolePlacement(candidate, region);
+        if (!slot) {
+          misfits.add(shapeKey);
+          continue;
+        }
+        this.grid.markOccupied(slot.cells);
+        placed.push(slot);
+        used.add(candidate.id);
+        freeArea -= candidate.area;
+      }
+    }
+    return placed;
+  }
+
+  /**
+   * First collision-free lattice position for a polygon inside a hole's bounding box
+   */
+  private findHolePlacement(
+    polygon: PackablePolygon,
+    region: { minX: number; minY: number; maxX: number; maxY: number }
+  ): PolygonPlacement | null {
+    const geometryService = new GeometryService();
+    for (const rotation of this.rotations) {
+      const rotated = rotation !== 0 ? geometryService.rotatePoints(polygon.points, rotation) : polygon.points;
+      const bbox = geometryService.getBoundingBox(rotated);
+      // The rasterized footprint carries the spacing on every side
+      const width = bbox.width + 2 * this.spacing;
+      const height = bbox.height + 2 * this.spacing;
+      if (width > region.maxX - region.minX || height > region.maxY - region.minY) continue;
+
+      for (let y = region.minY; y + height <= region.maxY; y += this.stepSize) {
+        for (let x = region.minX; x + width <= region.maxX; x += this.stepSize) {
+          const cells = this.rasterizer.rasterizePolygon(polygon.points, x, y, rotation, this.spacing, polygon.holes);
+          if (!this.grid.checkCollision(cells)) {
+            return { id: polygon.id, x, y, rotation, cells };
+          }
+        }
+      }
+    }
+    return null;
+  }
+
   /**
    * Refine a coarse position by searching nearby fine positions
    * Try to move the shape closer to the origin or edges for better packing
@@ -754,7 +2276,8 @@ export class PolygonPacker {
     coarseY: number,
     fineStep: number,
     bbox: { width: number; height: number },
-    gridDims: { width: number; height: number }
+    gridDims: { width: number; height: number },
+    grid: RasterGrid = this.grid
   ): {
     placement: PolygonPlacement | null;
     positionsTried: number;
@@ -782,9 +2305,9 @@ export class PolygonPacker {
     // Try refined positions
     for (const pos of refinedPositions) {
       positionsTried++;
-      const cells = this.rasterizer.rasterizePolygon(polygon.points, pos.x, pos.y, rotation, this.spacing);
+      const cells = this.rasterizer.rasterizePolygon(polygon.points, pos.x, pos.y, rotation, this.spacing, polygon.holes);
 
-      if (!this.grid.checkCollision(cells)) {
+      if (!grid.checkCollision(cells)) {
         return {
           placement: {
             id: polygon.id,
@@ -809,6 +2332,82 @@ export class PolygonPacker {
   }
 }
 
+/**
+ * Packing density of a layout: placed polygon area over the sheet strip it uses
+ * (full width × furthest extent down the sheet), so pushing items further down lowers it
+ */
+export function layoutDensity(
+  placements: Array<{ id: string; y: number; rotation: number }>,
+  polygonsById: Map<string, PackablePolygon>,
+  sheetWidth: number
+): number {
+  const geometryService = new GeometryService();
+  let area = 0;
+  let usedLength = 0;
+
+  for (const placement of placements) {
+    const polygon = polygonsById.get(placement.id);
+    if (!polygon) continue;
+    const rotated = placement.rotation !== 0
+      ? geometryService.rotatePoints(polygon.points, placement.rotation)
+      : polygon.points;
+    const bbox = geometryService.getBoundingBox(rotated);
+    area += polygon.area;
+    usedLength = Math.max(usedLength, placement.y + bbox.height);
+  }
+
+  return usedLength > 0 ? area / (sheetWidth * usedLength) : 0;
+}
+
+/**
+ * Stock sheet size a multi-stock job may open (mm at the API, inches inside the packer)
+ */
+export interface SheetStock {
+  id: string;
+  width: number;
+  height: number;
+}
+
+/**
+ * Pack the next sheet of a multi-stock job, choosing which stock to open
+ * Candidates are tried smallest first: the first stock that takes every remaining item
+ * wins outright (nothing larger can use less material); otherwise the stock with the
+ * densest sheet (placed area / stock area) wins. Returns null if nothing fits on any stock
+ * `run` packs one candidate (defaults to the raster search; jobs pass their hybrid/beam/scoring choice)
+ */
+export async function packNextStockSheet(
+  polygons: PackablePolygon[],
+  stocks: SheetStock[],
+  spacing: number,
+  cellsPerInch: number,
+  stepSize: number,
+  rotations: number[],
+  shapeCache: ShapeCache = new ShapeCache(),
+  run: (packer: PolygonPacker, polygons: PackablePolygon[]) => Promise<PolygonPackingResult> = (packer, items) => packer.pack(items)
+): Promise<{ stock: SheetStock; result: PolygonPackingResult } | null> {
+  const candidates = [...stocks].sort((a, b) => a.width * a.height - b.width * b.height);
+  let best: { stock: SheetStock; result: PolygonPackingResult; density: number } | null = null;
+
+  for (const stock of candidates) {
+    const packer = new PolygonPacker(stock.width, stock.height, spacing, cellsPerInch, stepSize, rotations, undefined, shapeCache);
+    const result = await run(packer, polygons);
+    if (result.placements.length === 0) continue;
+
+    if (result.unplacedPolygons.length === 0) {
+      return { stock, result };
+    }
+
+    const placedIds = new Set(result.placements.map(p => p.id));
+    const placedArea = polygons.filter(p => placedIds.has(p.id)).reduce((sum, p) => sum + p.area, 0);
+    const density = placedArea / (stock.width * stock.height);
+    if (!best || density > best.density) {
+      best = { stock, result, density };
+    }
+  }
+
+  return best && { stock: best.stock, result: best.result };
+}
+
 /**
  * Estimate if items can fit in requested pages
  * Uses conservative estimates to fail fast
@@ -820,7 +2419,7 @@ export function estimateSpaceRequirements(
   requestedPages: number,
   spacing: number = 0.0625
 ): SpaceEstimate {
-  // Calculate total area of all items
+  // Calculate total exact area of all items (not bounding-box area)
   const totalItemArea = polygons.reduce((sum, p) => sum + p.area, 0);
 
   // Calculate available sheet area
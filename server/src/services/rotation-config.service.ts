@@ -122,6 +122,20 @@ export class RotationConfigService {
     return this.getAllPresets().find(p => p.name === name);
   }
 
+  /**
+   * Get preset by API key ('90', '45', '15', '10', '5'), as sent in rotationPreset
+   */
+  static getPresetByKey(key: string): RotationPreset | undefined {
+    const presets: { [key: string]: RotationPreset } = {
+      '90': this.PRESET_90_DEGREE,
+      '45': this.PRESET_45_DEGREE,
+      '15': this.PRESET_15_DEGREE,
+      '10': this.PRESET_10_DEGREE,
+      '5': this.PRESET_5_DEGREE,
+    };
+    return presets[key];
+  }
+
   /**
    * Get default/recommended preset
    */
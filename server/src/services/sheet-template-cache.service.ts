@@ -0,0 +1,171 @@
+/**
+ * Sheet Template Cache
+ * Remembers full sheets from finished jobs, keyed by the multiset of designs on them, so a
+ * later job containing the same mix (a repeat order, maybe with a design added) reuses
+ * those layouts and only packs what is left over
+ *
+ * - A design is identified by its outline (size, points, holes), not its ID: a layout only
+ *   depends on geometry, and customers re-upload the same artwork under new names
+ * - A sheet's fingerprint is its packing context (sheet size, spacing, grid resolution,
+ *   step, rotations) plus its sorted design counts
+ * - The last sheet of a job holds the leftovers, so it is never cached
+ * - Entries are evicted least recently used first; the cache is per process
+ */
+import crypto from 'crypto';
+import { Placement, SheetPlacement } from './nesting.service';
+import { PackableSticker } from './polygon-packing.service';
+
+export interface SheetTemplateContext {
+  sheetWidth: number;  // mm
+  sheetHeight: number; // mm
+  spacing: number;     // mm
+  cellsPerInch: number;
+  stepSize: number;
+  rotations: number[];
+}
+
+interface TemplateEntry {
+  fingerprint: string;
+  counts: Map<string, number>; // Design hash → instances on the sheet
+  placements: Array<Omit<Placement, 'id'> & { design: string }>;
+  utilization: number;
+}
+
+export interface TemplateReuse {
+  sheets: SheetPlacement[]; // Cached layouts filled with the job's own item IDs (sheetIndex 0..n-1)
+  remainingIds: string[];   // Items left to pack fresh
+}
+
+const DEFAULT_MAX_ENTRIES = 500;
+
+/**
+ * Content hash of a design's outline (0.01mm resolution)
+ */
+export function designHashOf(sticker: Pick<PackableSticker, 'width' | 'height' | 'points' | 'holes'>): string {
+  const hash = crypto.createHash('sha1');
+  hash.update(`${sticker.width.toFixed(2)}x${sticker.height.toFixed(2)}:`);
+  for (const ring of [sticker.points, ...(sticker.holes || [])]) {
+    for (const point of ring) {
+      hash.update(`${point.x.toFixed(2)},${point.y.toFixed(2)};`);
+    }
+    hash.update('|');
+  }
+  return hash.digest('hex').slice(0, 16);
+}
+
+function contextKey(context: SheetTemplateContext): string {
+  return [
+    context.sheetWidth.toFixed(2),
+    context.sheetHeight.toFixed(2),
+    context.spacing.toFixed(3),
+    context.cellsPerInch,
+    context.stepSize,
+    [...context.rotations].sort((a, b) => a - b).join('/'),
+  ].join('|');
+}
+
+/**
+ * Canonical fingerprint of a sheet's design multiset within a packing context
+ */
+export function multisetFingerprint(context: SheetTemplateContext, counts: Map<string, number>): string {
+  const items = [...counts].sort(([a], [b]) => (a < b ? -1 : a > b ? 1 : 0)).map(([design, n]) => `${design}*${n}`);
+  return `${contextKey(context)}#${items.join(',')}`;
+}
+
+export class SheetTemplateCache {
+  // Context key → fingerprint → entry; lru holds every fingerprint, least recently used first
+  private readonly contexts = new Map<string, Map<string, TemplateEntry>>();
+  private readonly lru = new Map<string, string>(); // fingerprint → context key
+
+  constructor(private readonly maxEntries: number = DEFAULT_MAX_ENTRIES) {}
+
+  get size(): number {
+    return this.lru.size;
+  }
+
+  /**
+   * Fill as many sheets as possible from cached layouts whose multisets the job contains
+   * Greedy: fullest template first, each applied as often as the remaining items allow
+   */
+  reuse(context: SheetTemplateContext, stickers: PackableSticker[]): TemplateReuse {
+    const entries = this.contexts.get(contextKey(context));
+    if (!entries || entries.size === 0) {
+      return { sheets: [], remainingIds: stickers.map(s => s.id) };
+    }
+
+    const available = new Map<string, string[]>(); // Design hash → unused item IDs
+    for (const sticker of stickers) {
+      const design = designHashOf(sticker);
+      const ids = available.get(design);
+      if (ids) ids.push(sticker.id);
+      else available.set(design, [sticker.id]);
+    }
+
+    const sheets: SheetPlacement[] = [];
+    const candidates = [...entries.values()].sort((a, b) => b.utilization - a.utilization);
+    for (const entry of candidates) {
+      while ([...entry.counts].every(([design, n]) => (available.get(design)?.length ?? 0) >= n)) {
+        sheets.push({
+          sheetIndex: sheets.length,
+          placements: entry.placements.map(({ design, ...position }) => ({ id: available.get(design)!.shift()!, ...position })),
+          utilization: entry.utilization,
+        });
+        this.touch(entry.fingerprint);
+      }
+    }
+
+    const used = new Set(sheets.flatMap(sheet => sheet.placements.map(p => p.id)));
+    return { sheets, remainingIds: stickers.filter(s => !used.has(s.id)).map(s => s.id) };
+  }
+
+  /**
+   * Remember the full sheets of a finished job (every sheet but the last)
+   */
+  record(context: SheetTemplateContext, stickers: PackableSticker[], sheets: SheetPlacement[]): void {
+    const designs = new Map(stickers.map(sticker => [sticker.id, designHashOf(sticker)]));
+    const key = contextKey(context);
+
+    for (const sheet of sheets.slice(0, -1)) {
+      if (sheet.placements.length === 0 || sheet.placements.some(p => !designs.has(p.id))) continue;
+
+      const counts = new Map<string, number>();
+      sheet.placements.forEach(p => counts.set(designs.get(p.id)!, (counts.get(designs.get(p.id)!) || 0) + 1));
+      const fingerprint = multisetFingerprint(context, counts);
+      if (this.lru.has(fingerprint)) {
+        this.touch(fingerprint);
+        continue;
+      }
+
+      let entries = this.contexts.get(key);
+      if (!entries) {
+        entries = new Map();
+        this.contexts.set(key, entries);
+      }
+      entries.set(fingerprint, {
+        fingerprint,
+        counts,
+        placements: sheet.placements.map(({ id, ...position }) => ({ design: designs.get(id)!, ...position })),
+        utilization: sheet.utilization,
+      });
+      this.lru.set(fingerprint, key);
+      this.evict();
+    }
+  }
+
+  private touch(fingerprint: string): void {
+    const key = this.lru.get(fingerprint);
+    if (key === undefined) return;
+    this.lru.delete(fingerprint);
+    this.lru.set(fingerprint, key);
+  }
+
+  private evict(): void {
+    while (this.lru.size > this.maxEntries) {
+      const [fingerprint, key] = this.lru.entries().next().value as [string, string];
+      this.lru.delete(fingerprint);
+      const entries = this.contexts.get(key)!;
+      entries.delete(fingerprint);
+      if (entries.size === 0) this.contexts.delete(key);
+    }
+  }
+}
@@ -0,0 +1,758 @@
+import * as ClipperLib from 'clipper-lib';
+import { Point } from './image.service';
+
+/**
+ * SVG Service
+ * Reads vector sticker artwork directly, so SVG uploads skip the raster trace:
+ * - The outline comes from the filled (and stroked) geometry itself, with Béziers and arcs
+ *   flattened to a caller-chosen tolerance (the /process route ties it to the packing grid)
+ * - The same parsed shapes are drawn as vector paths in the PDF
+ *
+ * Supported: path, rect, circle, ellipse, polygon, polyline, line, nested <g> with
+ * transforms, fill/stroke via attributes, style="" and class rules in <style>
+ * Anything whose look or outline this reader can't reproduce (text, embedded images,
+ * <use>, gradients/patterns, clip paths, masks) makes parse() return null, and callers
+ * fall back to rasterizing the SVG with sharp
+ */
+
+export type Matrix = [number, number, number, number, number, number]; // a b c d e f (SVG order)
+
+export type SvgColor = string | [number, number, number]; // PDFKit color: hex / named, or RGB 0-255
+
+export interface SvgShape {
+  d: string;                    // SVG path data in the shape's own coordinates
+  matrix: Matrix;               // Accumulated transform to document user units
+  fill: SvgColor | null;        // null = not filled
+  fillRule: 'nonzero' | 'evenodd';
+  fillOpacity: number;
+  stroke: SvgColor | null;      // null = not stroked
+  strokeWidth: number;          // In the shape's own coordinates
+  strokeOpacity: number;
+  lineCap: 'butt' | 'round' | 'square';
+  lineJoin: 'miter' | 'round' | 'bevel';
+  miterLimit: number;           // Miter length / stroke width beyond which a miter join is cut off
+}
+
+export interface SvgArtwork {
+  shapes: SvgShape[];
+  // Bounding box (user units) of the sticker outline; the sticker's width/height map to it
+  bounds: { minX: number; minY: number; maxX: number; maxY: number; width: number; height: number };
+}
+
+export type Segment =
+  | { type: 'L'; to: Point }
+  | { type: 'C'; c1: Point; c2: Point; to: Point };
+
+export interface Subpath {
+  start: Point;
+  segments: Segment[];
+  closed: boolean;
+}
+
+interface Style {
+  fill: string;
+  fillRule: string;
+  fillOpacity: string;
+  stroke: string;
+  strokeWidth: string;
+  strokeOpacity: string;
+  strokeLinecap: string;
+  strokeLinejoin: string;
+  strokeMiterlimit: string;
+  opacity: string;
+  display: string;
+}
+
+const IDENTITY: Matrix = [1, 0, 0, 1, 0, 0];
+const CLIPPER_SCALE = 1000;
+const MAX_FLATTEN_DEPTH = 12;
+
+// Elements whose content is never drawn directly
+const NON_RENDERED = new Set([
+  'defs', 'clipPath', 'mask', 'symbol', 'pattern', 'marker', 'linearGradient', 'radialGradient',
+  'filter', 'title', 'desc', 'metadata', 'style', 'script',
+]);
+// Drawn content this reader can't turn into an outline
+const UNSUPPORTED = new Set(['text', 'image', 'use', 'foreignObject', 'switch']);
+const SHAPES = new Set(['path', 'rect', 'circle', 'ellipse', 'polygon', 'polyline', 'line']);
+
+// Stroke ends and corners as Clipper offsets them; Clipper has no bevel join, and its square
+// join (cut off half a stroke width out from the corner) covers the bevel
+const STROKE_CAPS: Record<SvgShape['lineCap'], ClipperLib.EndType> = {
+  butt: ClipperLib.EndType.etOpenButt,
+  round: ClipperLib.EndType.etOpenRound,
+  square: ClipperLib.EndType.etOpenSquare,
+};
+const STROKE_JOINS: Record<SvgShape['lineJoin'], ClipperLib.JoinType> = {
+  miter: ClipperLib.JoinType.jtMiter,
+  round: ClipperLib.JoinType.jtRound,
+  bevel: ClipperLib.JoinType.jtSquare,
+};
+
+const INHERITED: Style = {
+  fill: 'black',
+  fillRule: 'nonzero',
+  fillOpacity: '1',
+  stroke: 'none',
+  strokeWidth: '1',
+  strokeOpacity: '1',
+  strokeLinecap: 'butt',
+  strokeLinejoin: 'miter',
+  strokeMiterlimit: '4',
+  opacity: '1',
+  display: 'inline',
+};
+
+const STYLE_PROPERTIES: Record<string, keyof Style> = {
+  'fill': 'fill',
+  'fill-rule': 'fillRule',
+  'fill-opacity': 'fillOpacity',
+  'stroke': 'stroke',
+  'stroke-width': 'strokeWidth',
+  'stroke-opacity': 'strokeOpacity',
+  'stroke-linecap': 'strokeLinecap',
+  'stroke-linejoin': 'strokeLinejoin',
+  'stroke-miterlimit': 'strokeMiterlimit',
+  'opacity': 'opacity',
+  'display': 'display',
+};
+
+export class SvgService {
+  /**
+   * Sniff an upload for SVG markup (browsers don't always send image/svg+xml)
+   */
+  isSvg(buffer: Buffer): boolean {
+    const head = buffer.subarray(0, 1024).toString('utf8').replace(/^\uFEFF/, '').trimStart();
+    return head.startsWith('<') && /<svg[\s>]/.test(head);
+  }
+
+  /**
+   * Parse SVG markup into drawable shapes and the outline's bounds
+   * Returns null when the artwork needs the raster fallback (see file header)
+   */
+  parse(buffer: Buffer): SvgArtwork | null {
+    const markup = buffer.toString('utf8')
+      .replace(/<!--[\s\S]*?-->/g, '')
+      .replace(/<!\[CDATA\[([\s\S]*?)\]\]>/g, '$1');
+    const classRules = this.parseClassRules(markup);
+
+    const shapes: SvgShape[] = [];
+    const stack: Array<{ name: string; matrix: Matrix; style: Style; hidden: boolean }> = [
+      { name: '', matrix: IDENTITY, style: INHERITED, hidden: false },
+    ];
+
+    const tagPattern = /<(\/?)([A-Za-z][\w:.-]*)((?:[^>"']|"[^"]*"|'[^']*')*?)(\/?)>/g;
+    let match: RegExpExecArray | null;
+    while ((match = tagPattern.exec(markup))) {
+      const [, closing, name, attributeText, selfClosing] = match;
+      if (closing) {
+        if (stack.length > 1 && stack[stack.length - 1].name === name) stack.pop();
+        continue;
+      }
+
+      const parent = stack[stack.length - 1];
+      const attributes = this.parseAttributes(attributeText);
+      const style = this.resolveStyle(parent.style, attributes, classRules);
+      const matrix = multiply(parent.matrix, parseTransform(attributes['transform'] || ''));
+      const hidden = parent.hidden || NON_RENDERED.has(name) || style.display === 'none';
+
+      if (!hidden) {
+        if (UNSUPPORTED.has(name) || attributes['clip-path'] || attributes['mask'] || attributes['filter']) {
+          return null;
+        }
+        if (SHAPES.has(name)) {
+          const shape = this.toShape(name, attributes, style, matrix);
+          if (shape === undefined) return null;
+          if (shape) shapes.push(shape);
+        }
+      }
+
+      if (!selfClosing) {
+        stack.push({ name, matrix, style, hidden });
+      }
+    }
+
+    if (shapes.length === 0) return null;
+
+    // Bounds from a fine flattening, so every caller maps user units to mm identically
+    const controlBox = boundsOf(shapes.flatMap(shape => this.toSubpaths(shape).flatMap(controlPoints)));
+    const outline = this.largestOutline(shapes, Math.max(controlBox.width, controlBox.height) / 2000);
+    if (!outline || outline.path.length < 3) return null;
+
+    return { shapes, bounds: boundsOf(outline.path) };
+  }
+
+  /**
+   * The sticker outline (largest filled region) and its empty holes, in user units
+   * Curves are flattened so the polyline stays within `tolerance` of the true edge
+   */
+  traceOutline(artwork: SvgArtwork, tolerance: number): { path: Point[]; holes: Point[][] } {
+    return this.largestOutline(artwork.shapes, tolerance) ?? { path: [], holes: [] };
+  }
+
+  /**
+   * Union every shape's painted region; keep the biggest piece and the holes that are
+   * really empty (holes containing artwork islands are dropped)
+   */
+  private largestOutline(shapes: SvgShape[], tolerance: number): { path: Point[]; holes: Point[][] } | null {
+    const painted: ClipperLib.Paths = [];
+    for (const shape of shapes) {
+      painted.push(...this.paintedRegion(shape, tolerance));
+    }
+
+    const clipper = new ClipperLib.Clipper();
+    clipper.AddPaths(painted, ClipperLib.PolyType.ptSubject, true);
+    const tree = new ClipperLib.PolyTree();
+    clipper.Execute(ClipperLib.ClipType.ctUnion, tree, ClipperLib.PolyFillType.pftNonZero, ClipperLib.PolyFillType.pftNonZero);
+
+    let largest: ClipperLib.PolyNode | null = null;
+    let largestArea = 0;
+    for (const node of tree.Childs()) {
+      const area = Math.abs(ClipperLib.Clipper.Area(node.Contour()));
+      if (area > largestArea) {
+        largestArea = area;
+        largest = node;
+      }
+    }
+    if (!largest) return null;
+
+    const fromClipper = (path: ClipperLib.Path): Point[] => path.map(p => ({ x: p.X / CLIPPER_SCALE, y: p.Y / CLIPPER_SCALE }));
+    return {
+      path: fromClipper(largest.Contour()),
+      holes: largest.Childs().filter(hole => hole.ChildCount() === 0).map(hole => fromClipper(hole.Contour())),
+    };
+  }
+
+  /**
+   * Fill area plus stroke band of one shape, in scaled document coordinates
+   */
+  private paintedRegion(shape: SvgShape, tolerance: number): ClipperLib.Paths {
+    const toClipper = (points: Point[]): ClipperLib.Path =>
+      points.map(p => ({ X: Math.round(p.x * CLIPPER_SCALE), Y: Math.round(p.y * CLIPPER_SCALE) }));
+    const subpaths = this.toSubpaths(shape);
+    const flattened = subpaths.map(subpath => toClipper(flatten(subpath, tolerance)));
+    const region: ClipperLib.Paths = [];
+
+    if (shape.fill !== null) {
+      const fillType = shape.fillRule === 'evenodd' ? ClipperLib.PolyFillType.pftEvenOdd : ClipperLib.PolyFillType.pftNonZero;
+      const clipper = new ClipperLib.Clipper();
+      clipper.AddPaths(flattened.filter(path => path.length >= 3), ClipperLib.PolyType.ptSubject, true);
+      const filled: ClipperLib.Paths = [];
+      clipper.Execute(ClipperLib.ClipType.ctUnion, filled, fillType, fillType);
+      region.push(...filled);
+    }
+
+    if (shape.stroke !== null && shape.strokeWidth > 0) {
+      // Strokes are centred on the path; the transform scales their width too
+      const halfWidth = (shape.strokeWidth * Math.sqrt(Math.abs(shape.matrix[0] * shape.matrix[3] - shape.matrix[1] * shape.matrix[2]))) / 2;
+      // Clipper squares off a miter past its limit where SVG bevels: slightly larger, never smaller
+      const offset = new ClipperLib.ClipperOffset(shape.miterLimit);
+      const joinType = STROKE_JOINS[shape.lineJoin];
+      const endType = STROKE_CAPS[shape.lineCap];
+      subpaths.forEach((subpath, i) => {
+        offset.AddPath(flattened[i], joinType, subpath.closed ? ClipperLib.EndType.etClosedLine : endType);
+      });
+      const band: ClipperLib.Paths = [];
+      offset.Execute(band, halfWidth * CLIPPER_SCALE);
+      region.push(...band);
+    }
+
+    return region;
+  }
+
+  /**
+   * Parse a shape's path data into transformed subpaths of lines and cubics
+   */
+  private toSubpaths(shape: SvgShape): Subpath[] {
+    return parsePathData(shape.d).map(subpath => ({
+      start: apply(shape.matrix, subpath.start),
+      closed: subpath.closed,
+      segments: subpath.segments.map(segment => segment.type === 'L'
+        ? { type: 'L' as const, to: apply(shape.matrix, segment.to) }
+        : { type: 'C' as const, c1: apply(shape.matrix, segment.c1), c2: apply(shape.matrix, segment.c2), to: apply(shape.matrix, segment.to) }),
+    }));
+  }
+
+  /**
+   * Build a shape from a basic element; null = nothing painted, undefined = unsupported paint
+   */
+  private toShape(name: string, attributes: Record<string, string>, style: Style, matrix: Matrix): SvgShape | null | undefined {
+    const num = (key: string, fallback = 0) => {
+      const value = parseFloat(attributes[key]);
+      return Number.isFinite(value) ? value : fallback;
+    };
+
+    let d: string;
+    switch (name) {
+      case 'path':
+        d = attributes['d'] || '';
+        break;
+      case 'rect': {
+        const x = num('x'), y = num('y'), w = num('width'), h = num('height');
+        if (w <= 0 || h <= 0) return null;
+        let rx = attributes['rx'] !== undefined ? num('rx') : num('ry');
+        let ry = attributes['ry'] !== undefined ? num('ry') : rx;
+        rx = Math.min(Math.max(rx, 0), w / 2);
+        ry = Math.min(Math.max(ry, 0), h / 2);
+        d = rx > 0 && ry > 0
+          ? `M${x + rx},${y}H${x + w - rx}A${rx},${ry} 0 0 1 ${x + w},${y + ry}V${y + h - ry}` +
+            `A${rx},${ry} 0 0 1 ${x + w - rx},${y + h}H${x + rx}A${rx},${ry} 0 0 1 ${x},${y + h - ry}` +
+            `V${y + ry}A${rx},${ry} 0 0 1 ${x + rx},${y}Z`
+          : `M${x},${y}H${x + w}V${y + h}H${x}Z`;
+        break;
+      }
+      case 'circle':
+      case 'ellipse': {
+        const cx = num('cx'), cy = num('cy');
+        const rx = name === 'circle' ? num('r') : num('rx');
+        const ry = name === 'circle' ? num('r') : num('ry');
+        if (rx <= 0 || ry <= 0) return null;
+        d = `M${cx - rx},${cy}A${rx},${ry} 0 1 0 ${cx + rx},${cy}A${rx},${ry} 0 1 0 ${cx - rx},${cy}Z`;
+        break;
+      }
+      case 'polygon':
+      case 'polyline': {
+        const values = (attributes['points'] || '').match(NUMBER_PATTERN)?.map(Number) ?? [];
+        if (values.length < 4) return null;
+        const pairs: string[] = [];
+        for (let i = 0; i + 1 < values.length; i += 2) pairs.push(`${values[i]},${values[i + 1]}`);
+        d = `M${pairs.join('L')}${name === 'polygon' ? 'Z' : ''}`;
+        break;
+      }
+      case 'line':
+        d = `M${num('x1')},${num('y1')}L${num('x2')},${num('y2')}`;
+        break;
+      default:
+        return null;
+    }
+    if (!d.trim()) return null;
+
+    const opacity = clamp01(parseFloat(style.opacity));
+    const fill = name === 'line' ? null : parsePaint(style.fill);
+    const stroke = parsePaint(style.stroke);
+    if (fill === undefined || stroke === undefined) return undefined;
+
+    const fillOpacity = clamp01(parseFloat(style.fillOpacity)) * opacity;
+    const strokeOpacity = clamp01(parseFloat(style.strokeOpacity)) * opacity;
+    const strokeWidth = parseFloat(style.strokeWidth);
+    const shape: SvgShape = {
+      d,
+      matrix,
+      fill: fillOpacity > 0 ? fill : null,
+      fillRule: style.fillRule === 'evenodd' ? 'evenodd' : 'nonzero',
+      fillOpacity,
+      stroke: strokeOpacity > 0 && strokeWidth > 0 ? stroke : null,
+      strokeWidth: Number.isFinite(strokeWidth) ? strokeWidth : 1,
+      strokeOpacity,
+      lineCap: style.strokeLinecap === 'round' || style.strokeLinecap === 'square' ? style.strokeLinecap : 'butt',
+      lineJoin: style.strokeLinejoin === 'round' || style.strokeLinejoin === 'bevel' ? style.strokeLinejoin : 'miter',
+      miterLimit: Math.max(1, parseFloat(style.strokeMiterlimit) || 4),
+    };
+    return shape.fill === null && shape.stroke === null ? null : shape;
+  }
+
+  /**
+   * Presentation attributes < class rules < style="" (SVG cascade, minus selectors we skip)
+   */
+  private resolveStyle(parent: Style, attributes: Record<string, string>, classRules: Map<string, Record<string, string>>): Style {
+    // display and opacity don't inherit; group opacity is approximated by multiplying it in
+    const style: Style = { ...parent, display: 'inline', opacity: '1' };
+    const assign = (declarations: Record<string, string>) => {
+      for (const [property, value] of Object.entries(declarations)) {
+        const key = STYLE_PROPERTIES[property];
+        if (key && value !== 'inherit') style[key] = value;
+      }
+    };
+
+    assign(attributes);
+    for (const className of (attributes['class'] || '').split(/\s+/)) {
+      const rule = classRules.get(className);
+      if (rule) assign(rule);
+    }
+    if (attributes['style']) assign(parseDeclarations(attributes['style']));
+    style.opacity = String(clamp01(parseFloat(style.opacity)) * clamp01(parseFloat(parent.opacity)));
+    return style;
+  }
+
+  /**
+   * Class selectors from <style> blocks (.a, .b { fill: #fff }); other selectors are ignored
+   */
+  private parseClassRules(markup: string): Map<string, Record<string, string>> {
+    const rules = new Map<string, Record<string, string>>();
+    const stylePattern = /<style[^>]*>([\s\S]*?)<\/style>/g;
+    let block: RegExpExecArray | null;
+    while ((block = stylePattern.exec(markup))) {
+      const rulePattern = /([^{}]+)\{([^}]*)\}/g;
+      let rule: RegExpExecArray | null;
+      while ((rule = rulePattern.exec(block[1]))) {
+        const declarations = parseDeclarations(rule[2]);
+        for (const selector of rule[1].split(',').map(s => s.trim())) {
+          if (!/^\.[\w-]+$/.test(selector)) continue;
+          const name = selector.slice(1);
+          rules.set(name, { ...rules.get(name), ...declarations });
+        }
+      }
+    }
+    return rules;
+  }
+
+  private parseAttributes(text: string): Record<string, string> {
+    const attributes: Record<string, string> = {};
+    const attributePattern = /([\w:.-]+)\s*=\s*(?:"([^"]*)"|'([^']*)')/g;
+    let attribute: RegExpExecArray | null;
+    while ((attribute = attributePattern.exec(text))) {
+      attributes[attribute[1]] = (attribute[2] ?? attribute[3]).trim();
+    }
+    return attributes;
+  }
+}
+
+const NUMBER_PATTERN = /[+-]?(?:\d+\.?\d*|\.\d+)(?:[eE][+-]?\d+)?/g;
+
+function parseDeclarations(text: string): Record<string, string> {
+  const declarations: Record<string, string> = {};
+  for (const declaration of text.split(';')) {
+    const colon = declaration.indexOf(':');
+    if (colon < 0) continue;
+    declarations[declaration.slice(0, colon).trim()] = declaration.slice(colon + 1).replace(/!important/, '').trim();
+  }
+  return declarations;
+}
+
+function clamp01(value: number): number {
+  return Number.isFinite(value) ? Math.min(1, Math.max(0, value)) : 1;
+}
+
+/**
+ * Paint value → PDFKit color; null = none, undefined = paint server or unknown syntax
+ */
+function parsePaint(value: string): SvgColor | null | undefined {
+  const paint = value.trim();
+  if (paint === 'none' || paint === 'transparent') return null;
+  if (paint === 'currentColor') return 'black';
+  if (/^#[0-9a-fA-F]{3}$|^#[0-9a-fA-F]{6}$/.test(paint)) return paint;
+  if (/^[a-zA-Z]+$/.test(paint)) return paint.toLowerCase();
+  const rgb = paint.match(/^rgba?\(([^)]*)\)$/);
+  if (rgb) {
+    const channels = rgb[1].split(/[\s,/]+/).filter(Boolean).slice(0, 3)
+      .map(channel => channel.endsWith('%') ? parseFloat(channel) * 2.55 : parseFloat(channel));
+    if (channels.length === 3 && channels.every(Number.isFinite)) {
+      return channels.map(channel => Math.round(Math.min(255, Math.max(0, channel)))) as [number, number, number];
+    }
+  }
+  return undefined;
+}
+
+/**
+ * Compose transforms: the result applies `inner` first, then `outer`
+ */
+function multiply(outer: Matrix, inner: Matrix): Matrix {
+  const [a1, b1, c1, d1, e1, f1] = outer;
+  const [a2, b2, c2, d2, e2, f2] = inner;
+  return [
+    a1 * a2 + c1 * b2,
+    b1 * a2 + d1 * b2,
+    a1 * c2 + c1 * d2,
+    b1 * c2 + d1 * d2,
+    a1 * e2 + c1 * f2 + e1,
+    b1 * e2 + d1 * f2 + f1,
+  ];
+}
+
+function apply(m: Matrix, p: Point): Point {
+  return { x: m[0] * p.x + m[2] * p.y + m[4], y: m[1] * p.x + m[3] * p.y + m[5] };
+}
+
+export function parseTransform(text: string): Matrix {
+  let matrix: Matrix = IDENTITY;
+  const functionPattern = /(matrix|translate|scale|rotate|skewX|skewY)\s*\(([^)]*)\)/g;
+  let fn: RegExpExecArray | null;
+  while ((fn = functionPattern.exec(text))) {
+    const args = (fn[2].match(NUMBER_PATTERN) || []).map(Number);
+    let next: Matrix = IDENTITY;
+    switch (fn[1]) {
+      case 'matrix':
+        if (args.length === 6) next = args as Matrix;
+        break;
+      case 'translate':
+        next = [1, 0, 0, 1, args[0] || 0, args[1] || 0];
+        break;
+      case 'scale':
+        next = [args[0] ?? 1, 0, 0, args[1] ?? args[0] ?? 1, 0, 0];
+        break;
+      case 'rotate': {
+        const rad = ((args[0] || 0) * Math.PI) / 180;
+        const cos = Math.cos(rad), sin = Math.sin(rad);
+        const [cx, cy] = [args[1] || 0, args[2] || 0];
+        next = [cos, sin, -sin, cos, cx - cos * cx + sin * cy, cy - sin * cx - cos * cy];
+        break;
+      }
+      case 'skewX':
+        next = [1, 0, Math.tan(((args[0] || 0) * Math.PI) / 180), 1, 0, 0];
+        break;
+      case 'skewY':
+        next = [1, Math.tan(((args[0] || 0) * Math.PI) / 180), 0, 1, 0, 0];
+        break;
+    }
+    matrix = multiply(matrix, next);
+  }
+  return matrix;
+}
+
+/**
+ * Parse SVG path data into absolute subpaths of lines and cubic Béziers
+ * Quadratics are raised to cubics and arcs are split into cubics of at most 90°
+ */
+export function parsePathData(d: string): Subpath[] {
+  const tokens = d.match(/[MmLlHhVvCcSsQqTtAaZz]|[+-]?(?:\d+\.?\d*|\.\d+)(?:[eE][+-]?\d+)?/g) || [];
+  const subpaths: Subpath[] = [];
+  let current: Subpath | null = null;
+  let point: Point = { x: 0, y: 0 };
+  let lastControl: Point | null = null; // Reflected by S/T
+  let lastCommand = '';
+  let i = 0;
+
+  const isCommand = (token: string | undefined) => token !== undefined && /^[A-Za-z]$/.test(token);
+  const next = () => parseFloat(tokens[i++]);
+  // Arc flags may be packed without separators ("a1 1 0 00 1 1")
+  const nextFlag = () => {
+    const token = tokens[i];
+    if (token.length > 1 && (token[0] === '0' || token[0] === '1')) {
+      tokens[i] = token.slice(1);
+      return token[0] === '1';
+    }
+    i++;
+    return token === '1';
+  };
+  const ensureSubpath = () => {
+    if (!current) {
+      current = { start: point, segments: [], closed: false };
+      subpaths.push(current);
+    }
+    return current;
+  };
+  const lineTo = (to: Point) => {
+    ensureSubpath().segments.push({ type: 'L', to });
+    point = to;
+  };
+  const cubicTo = (c1: Point, c2: Point, to: Point) => {
+    ensureSubpath().segments.push({ type: 'C', c1, c2, to });
+    lastControl = c2;
+    point = to;
+  };
+
+  let command = '';
+  while (i < tokens.length) {
+    if (isCommand(tokens[i])) {
+      command = tokens[i++];
+    } else if (!command) {
+      i++; // Stray number before any command
+      continue;
+    }
+    const relative = command === command.toLowerCase();
+    const base = relative ? point : { x: 0, y: 0 };
+    const upper = command.toUpperCase();
+    const needed = { M: 2, L: 2, H: 1, V: 1, C: 6, S: 4, Q: 4, T: 2, A: 7, Z: 0 }[upper] ?? 0;
+    // Packed arc flags can make an arc as short as 5 tokens
+    if (tokens.length - i < (upper === 'A' ? 5 : needed)) break;
+    if (needed > 0 && isCommand(tokens[i])) continue;
+
+    const previousCommand = lastCommand;
+    lastCommand = upper;
+    if (upper !== 'C' && upper !== 'S' && upper !== 'Q' && upper !== 'T') lastControl = null;
+
+    switch (upper) {
+      case 'M': {
+        point = { x: base.x + next(), y: base.y + next() };
+        current = { start: point, segments: [], closed: false };
+        subpaths.push(current);
+        command = relative ? 'l' : 'L'; // Extra pairs are implicit line-tos
+        break;
+      }
+      case 'L':
+        lineTo({ x: base.x + next(), y: base.y + next() });
+        break;
+      case 'H':
+        lineTo({ x: base.x + next(), y: point.y });
+        break;
+      case 'V':
+        lineTo({ x: point.x, y: base.y + next() });
+        break;
+      case 'C': {
+        const c1 = { x: base.x + next(), y: base.y + next() };
+        const c2 = { x: base.x + next(), y: base.y + next() };
+        cubicTo(c1, c2, { x: base.x + next(), y: base.y + next() });
+        break;
+      }
+      case 'S': {
+        const c1: Point = lastControl && (previousCommand === 'C' || previousCommand === 'S')
+          ? { x: 2 * point.x - lastControl.x, y: 2 * point.y - lastControl.y }
+          : point;
+        const c2 = { x: base.x + next(), y: base.y + next() };
+        cubicTo(c1, c2, { x: base.x + next(), y: base.y + next() });
+        break;
+      }
+      case 'Q':
+      case 'T': {
+        const q: Point = upper === 'Q'
+          ? { x: base.x + next(), y: base.y + next() }
+          : lastControl && (previousCommand === 'Q' || previousCommand === 'T')
+            ? { x: 2 * point.x - lastControl.x, y: 2 * point.y - lastControl.y }
+            : point;
+        const to = { x: base.x + next(), y: base.y + next() };
+        const from = point;
+        cubicTo(
+          { x: from.x + (2 / 3) * (q.x - from.x), y: from.y + (2 / 3) * (q.y - from.y) },
+          { x: to.x + (2 / 3) * (q.x - to.x), y: to.y + (2 / 3) * (q.y - to.y) },
+          to
+        );
+        lastControl = q; // T reflects the quadratic control point
+        break;
+      }
+      case 'A': {
+        const rx = Math.abs(next()), ry = Math.abs(next()), angle = next();
+        const largeArc = nextFlag(), sweep = nextFlag();
+        const to = { x: base.x + next(), y: base.y + next() };
+        if (rx === 0 || ry === 0) {
+          lineTo(to);
+        } else {
+          for (const [c1, c2, end] of arcToCubics(point, to, rx, ry, angle, largeArc, sweep)) {
+            cubicTo(c1, c2, end);
+          }
+          lastControl = null;
+        }
+        break;
+      }
+      case 'Z':
+        if (current) {
+          current.closed = true;
+          point = current.start;
+          current = null;
+        }
+        command = ''; // Numbers after Z are stray
+        break;
+    }
+  }
+
+  return subpaths;
+}
+
+/**
+ * Endpoint-parameterized elliptical arc → cubic Béziers (SVG spec F.6)
+ */
+function arcToCubics(
+  from: Point, to: Point, rx: number, ry: number, angle: number, largeArc: boolean, sweep: boolean
+): Array<[Point, Point, Point]> {
+  if (from.x === to.x && from.y === to.y) return [];
+  const phi = (angle * Math.PI) / 180;
+  const cos = Math.cos(phi), sin = Math.sin(phi);
+
+  const dx = (from.x - to.x) / 2, dy = (from.y - to.y) / 2;
+  const x1 = cos * dx + sin * dy;
+  const y1 = -sin * dx + cos * dy;
+
+  // Scale up radii too small to reach the endpoint
+  const lambda = (x1 * x1) / (rx * rx) + (y1 * y1) / (ry * ry);
+  if (lambda > 1) {
+    rx *= Math.sqrt(lambda);
+    ry *= Math.sqrt(lambda);
+  }
+
+  const numerator = rx * rx * ry * ry - rx * rx * y1 * y1 - ry * ry * x1 * x1;
+  const denominator = rx * rx * y1 * y1 + ry * ry * x1 * x1;
+  const factor = (largeArc === sweep ? -1 : 1) * Math.sqrt(Math.max(0, numerator / denominator));
+  const cx1 = (factor * rx * y1) / ry;
+  const cy1 = (-factor * ry * x1) / rx;
+  const cx = cos * cx1 - sin * cy1 + (from.x + to.x) / 2;
+  const cy = sin * cx1 + cos * cy1 + (from.y + to.y) / 2;
+
+  const vectorAngle = (ux: number, uy: number, vx: number, vy: number) => {
+    const sign = ux * vy - uy * vx < 0 ? -1 : 1;
+    const dot = (ux * vx + uy * vy) / (Math.hypot(ux, uy) * Math.hypot(vx, vy));
+    return sign * Math.acos(Math.min(1, Math.max(-1, dot)));
+  };
+  const theta1 = vectorAngle(1, 0, (x1 - cx1) / rx, (y1 - cy1) / ry);
+  let delta = vectorAngle((x1 - cx1) / rx, (y1 - cy1) / ry, (-x1 - cx1) / rx, (-y1 - cy1) / ry);
+  if (!sweep && delta > 0) delta -= 2 * Math.PI;
+  if (sweep && delta < 0) delta += 2 * Math.PI;
+
+  const pieces = Math.max(1, Math.ceil(Math.abs(delta) / (Math.PI / 2)));
+  const step = delta / pieces;
+  const k = (4 / 3) * Math.tan(step / 4);
+  const onEllipse = (t: number, dr: number): Point => {
+    // dr = 0: point at t; dr = 1: derivative at t
+    const ex = dr ? -rx * Math.sin(t) : rx * Math.cos(t);
+    const ey = dr ? ry * Math.cos(t) : ry * Math.sin(t);
+    return dr
+      ? { x: cos * ex - sin * ey, y: sin * ex + cos * ey }
+      : { x: cx + cos * ex - sin * ey, y: cy + sin * ex + cos * ey };
+  };
+
+  const cubics: Array<[Point, Point, Point]> = [];
+  for (let p = 0; p < pieces; p++) {
+    const t1 = theta1 + p * step, t2 = t1 + step;
+    const start = onEllipse(t1, 0), end = p === pieces - 1 ? to : onEllipse(t2, 0);
+    const d1 = onEllipse(t1, 1), d2 = onEllipse(t2, 1);
+    cubics.push([
+      { x: start.x + k * d1.x, y: start.y + k * d1.y },
+      { x: end.x - k * d2.x, y: end.y - k * d2.y },
+      end,
+    ]);
+  }
+  return cubics;
+}
+
+function controlPoints(subpath: Subpath): Point[] {
+  return [subpath.start, ...subpath.segments.flatMap(s => (s.type === 'L' ? [s.to] : [s.c1, s.c2, s.to]))];
+}
+
+/**
+ * Subpath → polyline; each cubic is split until its control points lie within
+ * `tolerance` of the chord (a bound on the curve's distance from it)
+ */
+export function flatten(subpath: Subpath, tolerance: number): Point[] {
+  const points: Point[] = [subpath.start];
+  let from = subpath.start;
+  for (const segment of subpath.segments) {
+    if (segment.type === 'L') {
+      points.push(segment.to);
+    } else {
+      flattenCubic(from, segment.c1, segment.c2, segment.to, tolerance, 0, points);
+    }
+    from = segment.to;
+  }
+  return points;
+}
+
+function flattenCubic(p0: Point, p1: Point, p2: Point, p3: Point, tolerance: number, depth: number, out: Point[]): void {
+  const chordX = p3.x - p0.x, chordY = p3.y - p0.y;
+  const length = Math.hypot(chordX, chordY);
+  const distance = (p: Point) => length > 0
+    ? Math.abs((p.x - p0.x) * chordY - (p.y - p0.y) * chordX) / length
+    : Math.hypot(p.x - p0.x, p.y - p0.y);
+
+  if (depth >= MAX_FLATTEN_DEPTH || Math.max(distance(p1), distance(p2)) <= tolerance) {
+    out.push(p3);
+    return;
+  }
+
+  // de Casteljau split at t = 0.5
+  const mid = (a: Point, b: Point) => ({ x: (a.x + b.x) / 2, y: (a.y + b.y) / 2 });
+  const p01 = mid(p0, p1), p12 = mid(p1, p2), p23 = mid(p2, p3);
+  const p012 = mid(p01, p12), p123 = mid(p12, p23);
+  const split = mid(p012, p123);
+  flattenCubic(p0, p01, p012, split, tolerance, depth + 1, out);
+  flattenCubic(split, p123, p23, p3, tolerance, depth + 1, out);
+}
+
+function boundsOf(points: Point[]): SvgArtwork['bounds'] {
+  let minX = Infinity, minY = Infinity, maxX = -Infinity, maxY = -Infinity;
+  for (const p of points) {
+    minX = Math.min(minX, p.x);
+    minY = Math.min(minY, p.y);
+    maxX = Math.max(maxX, p.x);
+    maxY = Math.max(maxY, p.y);
+  }
+  if (points.length === 0) return { minX: 0, minY: 0, maxX: 0, maxY: 0, width: 0, height: 0 };
+  return { minX, minY, maxX, maxY, width: maxX - minX, height: maxY - minY };
+}
@@ -9,13 +9,19 @@ import {
   PackingWorkerMessage,
   PackingWorkerProgress,
   PackingWorkerResult,
-  PackingWorkerError
+  PackingWorkerError,
+  PackingCheckpoint
 } from '../workers/packing.worker';
+import { PackingSample } from './page-count-predictor.service';
+import { SheetPlacement } from './nesting.service';
 
 export interface WorkerJobOptions {
   onProgress?: (progress: PackingWorkerProgress) => void;
   onComplete?: (result: any) => void;
   onError?: (error: string) => void;
+  onCalibration?: (sample: PackingSample) => void;
+  onCheckpoint?: (checkpoint: PackingCheckpoint) => void;
+  onSheet?: (sheet: SheetPlacement) => void;
 }
 
 export class WorkerManagerService {
@@ -60,6 +66,12 @@ export class WorkerManagerService {
         if (message.type === 'progress') {
           console.log(`[WorkerManager] Progress (${jobId}): ${message.message}`);
           options.onProgress?.(message);
+        } else if (message.type === 'calibration') {
+          options.onCalibration?.(message.sample);
+        } else if (message.type === 'sheet') {
+          options.onSheet?.(message.sheet);
+        } else if (message.type === 'checkpoint') {
+          options.onCheckpoint?.(message.checkpoint);
         } else if (message.type === 'result') {
           console.log(`[WorkerManager] Job ${jobId} completed successfully`);
           settled = true;
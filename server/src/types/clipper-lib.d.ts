@@ -28,4 +28,42 @@ declare module 'clipper-lib' {
     Execute(solution: Paths, delta: number): void;
     Clear(): void;
   }
+
+  export enum ClipType {
+    ctIntersection = 0,
+    ctUnion = 1,
+    ctDifference = 2,
+    ctXor = 3
+  }
+
+  export enum PolyType {
+    ptSubject = 0,
+    ptClip = 1
+  }
+
+  export enum PolyFillType {
+    pftEvenOdd = 0,
+    pftNonZero = 1,
+    pftPositive = 2,
+    pftNegative = 3
+  }
+
+  export class PolyNode {
+    Contour(): Path;
+    Childs(): PolyNode[];
+    ChildCount(): number;
+    IsHole(): boolean;
+  }
+
+  export class PolyTree extends PolyNode {
+    constructor();
+  }
+
+  export class Clipper {
+    constructor(initOptions?: number);
+    AddPath(path: Path, polyType: PolyType, closed: boolean): boolean;
+    AddPaths(paths: Paths, polyType: PolyType, closed: boolean): boolean;
+    Execute(clipType: ClipType, solution: Paths | PolyTree, subjFillType?: PolyFillType, clipFillType?: PolyFillType): boolean;
+    static Area(path: Path): number;
+  }
 }
@@ -2,22 +2,49 @@
  * Worker thread for CPU-intensive polygon packing operations
  * This prevents blocking the main Node.js event loop during long-running packing
  */
-import { parentPort, workerData } from 'worker_threads';
-import { Point } from '../services/image.service';
+import { parentPort, workerData, Worker } from 'worker_threads';
+import path from 'path';
 import {
   PolygonPacker,
   PackablePolygon,
-  estimateSpaceRequirements
+  PackableSticker,
+  PlacementScoringWeights,
+  PolygonPackingResult,
+  PolygonPlacement,
+  ProgressCallback,
+  RasterGrid,
+  SheetObstacles,
+  SheetStock,
+  ShapeCache,
+  claimFrom,
+  createWeightedScorer,
+  estimateSpaceRequirements,
+  packNextStockSheet,
+  toPackablePolygon,
+  toObstaclesInches
 } from '../services/polygon-packing.service';
+import {
+  PageCountPredictor,
+  PageCountModel,
+  PackingSample,
+  extractPackingFeatures,
+  efficiencyFromSheets
+} from '../services/page-count-predictor.service';
+import {
+  SheetPlacement,
+  SheetTemplate,
+  describeSheetCopies,
+  designKeysOf,
+  groupSheetCopies,
+  repeatPackedSheet,
+  sheetTemplatesOf,
+  summarizeStockSheets
+} from '../services/nesting.service';
+import type { PlacementWorkerData, PlacementWorkerMessage } from './placement.worker';
 
 export interface PackingWorkerData {
   type: 'single-sheet' | 'multi-sheet';
-  stickers: Array<{
-    id: string;
-    points: Point[];
-    width: number;
-    height: number;
-  }>;
+  stickers: PackableSticker[];
   sheetWidth: number;
   sheetHeight: number;
   spacing: number;
@@ -26,6 +53,22 @@ export interface PackingWorkerData {
   rotations: number[];
   pageCount?: number; // For multi-sheet
   packAllItems?: boolean; // For multi-sheet
+  predictorModel?: PageCountModel; // Page-count predictor state from the main thread
+  resumeFrom?: PackingCheckpoint; // For multi-sheet: continue a job interrupted by a restart
+  hybrid?: boolean; // Near-rectangular designs via MaxRects, irregular ones via raster search
+  beamWidth?: number; // > 1: beam-search lookahead keeping this many partial layouts (takes precedence over hybrid)
+  placementScoring?: Partial<PlacementScoringWeights>; // Rank feasible positions (contact, hull growth, slivers) instead of first-fit
+  placementWorkers?: number; // For single-sheet: threads placing items concurrently on a shared grid (granted by the scheduler)
+  stocks?: SheetStock[]; // For multi-sheet: mix of stock sizes (mm) to choose from per sheet
+  remnants?: Array<SheetObstacles | null>; // Used regions of partially cut sheets by sheet index (mm); null = fresh stock
+}
+
+export interface PackingCheckpoint {
+  sheets: SheetPlacement[]; // Sheets completed so far (mm)
+  remainingIds: string[];   // Items not yet placed
+  pageCount: number;        // Page budget at the time of the checkpoint
+  attempts: number;
+  savedAt: number;
 }
 
 export interface PackingWorkerProgress {
@@ -56,7 +99,28 @@ export interface PackingWorkerError {
   error: string;
 }
 
-export type PackingWorkerMessage = PackingWorkerProgress | PackingWorkerResult | PackingWorkerError;
+export interface PackingWorkerCalibration {
+  type: 'calibration';
+  sample: PackingSample; // Observed efficiency for online predictor training
+}
+
+export interface PackingWorkerSheet {
+  type: 'sheet';
+  sheet: SheetPlacement; // Finalized sheet (mm) - never changes after this message
+}
+
+export interface PackingWorkerCheckpoint {
+  type: 'checkpoint';
+  checkpoint: PackingCheckpoint; // Sent after each completed sheet
+}
+
+export type PackingWorkerMessage =
+  | PackingWorkerProgress
+  | PackingWorkerResult
+  | PackingWorkerError
+  | PackingWorkerCalibration
+  | PackingWorkerCheckpoint
+  | PackingWorkerSheet;
 
 // Main worker execution
 if (parentPort) {
@@ -66,6 +130,8 @@ if (parentPort) {
     try {
       if (data.type === 'single-sheet') {
         await performSingleSheetPacking(data);
+      } else if (data.stocks && data.stocks.length > 0) {
+        await performMultiStockPacking(data);
       } else {
         await performMultiSheetPacking(data);
       }
@@ -87,6 +153,19 @@ function sendMessage(message: PackingWorkerMessage) {
   }
 }
 
+/**
+ * Run the packing strategy the job asked for on one sheet
+ */
+function runPacker(packer: PolygonPacker, polygons: PackablePolygon[], data: PackingWorkerData): Promise<PolygonPackingResult> {
+  if (data.placementScoring) {
+    packer.setPlacementScorer(createWeightedScorer(data.placementScoring));
+  }
+  if (data.beamWidth && data.beamWidth > 1) {
+    return packer.packBeam(polygons, data.beamWidth);
+  }
+  return data.hybrid ? packer.packHybrid(polygons) : packer.pack(polygons);
+}
+
 async function performSingleSheetPacking(data: PackingWorkerData) {
   const { stickers, sheetWidth, sheetHeight, spacing, cellsPerInch, stepSize, rotations } = data;
 
@@ -102,25 +181,8 @@ async function performSingleSheetPacking(data: PackingWorkerData) {
   const sheetHeightInches = sheetHeight / MM_PER_INCH;
   const spacingInches = spacing / MM_PER_INCH;
 
-  // Convert stickers to packable polygons
-  const polygons: PackablePolygon[] = stickers.map(sticker => {
-    const widthInches = sticker.width / MM_PER_INCH;
-    const heightInches = sticker.height / MM_PER_INCH;
-    const area = widthInches * heightInches;
-
-    const pointsInches = sticker.points.map(p => ({
-      x: p.x / MM_PER_INCH,
-      y: p.y / MM_PER_INCH,
-    }));
-
-    return {
-      id: sticker.id,
-      points: pointsInches,
-      width: widthInches,
-      height: heightInches,
-      area,
-    };
-  });
+  // Convert stickers to packable polygons (exact areas, descriptors reused from trace time)
+  const polygons: PackablePolygon[] = stickers.map(sticker => toPackablePolygon(sticker, MM_PER_INCH));
 
   sendMessage({
     type: 'progress',
@@ -128,7 +190,39 @@ async function performSingleSheetPacking(data: PackingWorkerData) {
     percentComplete: 25
   });
 
-  // Create packer with real-time progress callback
+  // Beam search branches on private grid copies, so it can't share the sheet with other threads
+  const concurrent = (data.placementWorkers ?? 1) > 1 && !(data.beamWidth && data.beamWidth > 1);
+  const grid = concurrent ? RasterGrid.createShared(sheetWidthInches, sheetHeightInches, cellsPerInch) : undefined;
+
+  // Real-time progress callback
+  const onProgress: ProgressCallback = (progress) => {
+    // Send real-time placement updates
+    if (progress.status === 'trying') {
+      sendMessage({
+        type: 'progress',
+        message: `Trying to place ${progress.itemId}...`,
+        itemsPlaced: progress.current,
+        totalItems: progress.total,
+        percentComplete: 25 + Math.floor((progress.current / progress.total) * 50)
+      });
+    } else if (progress.status === 'placed' && progress.placement) {
+      sendMessage({
+        type: 'progress',
+        message: `Placed ${progress.itemId}`,
+        itemsPlaced: progress.current,
+        totalItems: progress.total,
+        percentComplete: 25 + Math.floor((progress.current / progress.total) * 50),
+        placement: {
+          sheetIndex: 0,
+          id: progress.placement.id,
+          x: progress.placement.x * MM_PER_INCH,
+          y: progress.placement.y * MM_PER_INCH,
+          rotation: progress.placement.rotation
+        }
+      });
+    }
+  };
+
   const packer = new PolygonPacker(
     sheetWidthInches,
     sheetHeightInches,
@@ -136,35 +230,17 @@ async function performSingleSheetPacking(data: PackingWorkerData) {
     cellsPerInch,
     stepSize,
     rotations,
-    (progress) => {
-      // Send real-time placement updates
-      if (progress.status === 'trying') {
-        sendMessage({
-          type: 'progress',
-          message: `Trying to place ${progress.itemId}...`,
-          itemsPlaced: progress.current,
-          totalItems: progress.total,
-          percentComplete: 25 + Math.floor((progress.current / progress.total) * 50)
-        });
-      } else if (progress.status === 'placed' && progress.placement) {
-        sendMessage({
-          type: 'progress',
-          message: `Placed ${progress.itemId}`,
-          itemsPlaced: progress.current,
-          totalItems: progress.total,
-          percentComplete: 25 + Math.floor((progress.current / progress.total) * 50),
-          placement: {
-            sheetIndex: 0,
-            id: progress.placement.id,
-            x: progress.placement.x * MM_PER_INCH,
-            y: progress.placement.y * MM_PER_INCH,
-            rotation: progress.placement.rotation
-          }
-        });
-      }
-    }
+    onProgress,
+    undefined,
+    grid
   );
-  const result = await packer.pack(polygons);
+  const remnant = data.remnants?.[0];
+  if (remnant) {
+    packer.addObstacles(toObstaclesInches(remnant, MM_PER_INCH));
+  }
+  const result = grid
+    ? await packConcurrently(packer, grid, polygons, data, spacingInches, onProgress)
+    : await runPacker(packer, polygons, data);
 
   sendMessage({
     type: 'progress',
@@ -202,6 +278,98 @@ async function performSingleSheetPacking(data: PackingWorkerData) {
   });
 }
 
+/**
+ * Optimistic concurrent placement for big single sheets: this thread and placementWorkers - 1
+ * helper threads claim items (largest first) from a shared counter and commit onto one
+ * shared grid, retrying on conflict (see PolygonPacker.packShared)
+ */
+async function packConcurrently(
+  packer: PolygonPacker,
+  grid: RasterGrid,
+  polygons: PackablePolygon[],
+  data: PackingWorkerData,
+  spacingInches: number,
+  onProgress: ProgressCallback
+): Promise<PolygonPackingResult> {
+  const sorted = [...polygons].sort((a, b) => b.area - a.area);
+  const counter = new SharedArrayBuffer(Int32Array.BYTES_PER_ELEMENT);
+  const { width, height, cellsPerInch } = grid.getDimensions();
+  if (data.placementScoring) {
+    packer.setPlacementScorer(createWeightedScorer(data.placementScoring));
+  }
+
+  // Same script resolution as WorkerManagerService: .ts under ts-node in development
+  const isCompiled = __filename.endsWith('.js');
+  const helperPath = path.join(__dirname, isCompiled ? 'placement.worker.js' : 'placement.worker.ts');
+  const helperData: PlacementWorkerData = {
+    polygons: sorted,
+    sheetWidth: width,
+    sheetHeight: height,
+    spacing: spacingInches,
+    cellsPerInch,
+    stepSize: data.stepSize,
+    rotations: data.rotations,
+    grid: grid.getSharedState()!,
+    counter,
+    placementScoring: data.placementScoring,
+  };
+
+  const helperPlacements: PolygonPlacement[] = [];
+  const workers: Worker[] = [];
+  const helpers = Array.from({ length: data.placementWorkers! - 1 }, () =>
+    new Promise<{ unplacedIds: string[]; conflicts: number }>((resolve, reject) => {
+      const helper = new Worker(helperPath, {
+        workerData: helperData,
+        execArgv: isCompiled ? [] : ['-r', 'ts-node/register']
+      });
+      workers.push(helper);
+      helper.on('message', (message: PlacementWorkerMessage) => {
+        if (message.type === 'placed') {
+          const placement = { ...message.placement, cells: [] };
+          helperPlacements.push(placement);
+          onProgress({
+            current: Math.min(sorted.length, Atomics.load(new Int32Array(counter), 0)),
+            total: sorted.length,
+            itemId: placement.id,
+            status: 'placed',
+            message: `Placed ${placement.id}`,
+            placement,
+          });
+        } else if (message.type === 'done') {
+          resolve(message);
+        } else {
+          reject(new Error(message.error));
+        }
+      });
+      helper.on('error', reject);
+    })
+  );
+
+  // Observe helper failures right away; they surface once this thread's share is done
+  const helpersDone = Promise.all(helpers);
+  helpersDone.catch(() => undefined);
+
+  try {
+    const own = await packer.packShared(sorted, claimFrom(counter));
+    const results = await helpersDone;
+
+    const unplacedIds = new Set([...own.unplacedPolygons.map(p => p.id), ...results.flatMap(r => r.unplacedIds)]);
+    const conflicts = own.conflicts + results.reduce((sum, r) => sum + r.conflicts, 0);
+    console.log(
+      `[Concurrent] ${data.placementWorkers} threads placed ${own.placements.length + helperPlacements.length}/${sorted.length} ` +
+      `with ${conflicts} commit conflicts`
+    );
+
+    return {
+      placements: [...own.placements, ...helperPlacements],
+      utilization: grid.getUtilization(),
+      unplacedPolygons: sorted.filter(p => unplacedIds.has(p.id)),
+    };
+  } finally {
+    workers.forEach(worker => worker.terminate());
+  }
+}
+
 async function performMultiSheetPacking(data: PackingWorkerData) {
   const {
     stickers,
@@ -230,25 +398,8 @@ async function performMultiSheetPacking(data: PackingWorkerData) {
   const sheetHeightInches = sheetHeight / MM_PER_INCH;
   const spacingInches = spacing / MM_PER_INCH;
 
-  // Convert stickers to packable polygons
-  const polygons: PackablePolygon[] = stickers.map(sticker => {
-    const widthInches = sticker.width / MM_PER_INCH;
-    const heightInches = sticker.height / MM_PER_INCH;
-    const areaInches = widthInches * heightInches;
-
-    const pointsInches = sticker.points.map(p => ({
-      x: p.x / MM_PER_INCH,
-      y: p.y / MM_PER_INCH,
-    }));
-
-    return {
-      id: sticker.id,
-      points: pointsInches,
-      width: widthInches,
-      height: heightInches,
-      area: areaInches,
-    };
-  });
+  // Convert stickers to packable polygons (exact areas, descriptors reused from trace time)
+  const polygons: PackablePolygon[] = stickers.map(sticker => toPackablePolygon(sticker, MM_PER_INCH));
 
   // Estimate space requirements
   const estimate = estimateSpaceRequirements(
@@ -259,9 +410,14 @@ async function performMultiSheetPacking(data: PackingWorkerData) {
     spacingInches
   );
 
+  // Predict page-count distribution from shape/sheet/preset features
+  const predictor = new PageCountPredictor(data.predictorModel);
+  const features = extractPackingFeatures(polygons, sheetWidthInches, sheetHeightInches, rotations.length);
+  const prediction = predictor.predict(features);
+
   sendMessage({
     type: 'progress',
-    message: `Estimated ${estimate.minimumPagesNeeded} pages needed`,
+    message: `Predicted ${prediction.median} pages (range ${prediction.lowerBound}-${prediction.upperBound})`,
     percentComplete: 5
   });
 
@@ -274,9 +430,10 @@ async function performMultiSheetPacking(data: PackingWorkerData) {
   }
 
   // Determine starting page count
+  // Start at the 90th percentile: unused sheets are never opened, so over-predicting is cheap
   let currentPageCount = pageCount;
-  if (packAllItems && estimate.minimumPagesNeeded > pageCount) {
-    currentPageCount = estimate.minimumPagesNeeded;
+  if (packAllItems && prediction.upperBound > pageCount) {
+    currentPageCount = prediction.upperBound;
     sendMessage({
       type: 'progress',
       message: `Auto-expanding from ${pageCount} to ${currentPageCount} pages`,
@@ -288,7 +445,40 @@ async function performMultiSheetPacking(data: PackingWorkerData) {
   let allItemsPlaced = false;
   let finalSheets: any[] = [];
   let finalQuantities: { [stickerId: string]: number } = {};
-  let attempts = 0;
+  const resume = data.resumeFrom;
+  let attempts = resume?.attempts ?? 0;
+
+  // Sheets persist across attempts. Each sheet is packed deterministically from the
+  // items left over by earlier sheets, independent of the page budget, so "fits in N
+  // pages" is monotone in N and expanding the budget resumes after the last packed
+  // sheet instead of repacking identical sheets. The minimal page count therefore
+  // falls out of a single pass rather than O(n) (or O(log n)) full attempts.
+  const sheets: SheetPlacement[] = resume ? [...resume.sheets] : [];
+  let remainingPolygons = [...polygons];
+  let stalled = false; // A fresh sheet placed nothing - remaining items can never fit
+  const shapeCache = new ShapeCache(); // Outlines are shared by every sheet's packer
+  const designKeys = designKeysOf(stickers);
+  let templates: SheetTemplate[] = []; // Fresh-stock sheets that later sheets may repeat
+
+  // Resume after the last checkpointed sheet (same deterministic order as a fresh run)
+  if (resume) {
+    const remainingIds = new Set(resume.remainingIds);
+    remainingPolygons = polygons.filter(p => remainingIds.has(p.id));
+    templates = sheetTemplatesOf(sheets, resume.remainingIds, designKeys, index => !data.remnants?.[index]);
+    currentPageCount = Math.max(currentPageCount, resume.pageCount);
+    sendMessage({
+      type: 'progress',
+      message: `Resuming from checkpoint: ${sheets.length} sheets packed, ${remainingPolygons.length} items remaining`,
+      currentSheet: sheets.length,
+      totalSheets: currentPageCount,
+      itemsPlaced: polygons.length - remainingPolygons.length,
+      totalItems: polygons.length,
+      percentComplete: 15
+    });
+
+    // Re-announce finished sheets so clients following the resumed job get them
+    sheets.forEach(sheet => sendMessage({ type: 'sheet', sheet }));
+  }
 
   // Packing loop
   while (!allItemsPlaced && currentPageCount <= MAX_PAGES) {
@@ -300,11 +490,8 @@ async function performMultiSheetPacking(data: PackingWorkerData) {
       percentComplete: 10 + (attempts * 5)
     });
 
-    const sheets: any[] = [];
-    let remainingPolygons = [...polygons];
-
-    // Pack each sheet
-    for (let sheetIndex = 0; sheetIndex < currentPageCount && remainingPolygons.length > 0; sheetIndex++) {
+    // Pack each sheet (resuming after sheets packed by earlier attempts)
+    for (let sheetIndex = sheets.length; sheetIndex < currentPageCount && remainingPolygons.length > 0; sheetIndex++) {
       const sheetProgress = Math.floor(((sheetIndex + 1) / currentPageCount) * 70) + 15;
 
       sendMessage({
@@ -317,78 +504,117 @@ async function performMultiSheetPacking(data: PackingWorkerData) {
         percentComplete: sheetProgress
       });
 
-      // Set up real-time progress callback
-      const packer = new PolygonPacker(
-        sheetWidthInches,
-        sheetHeightInches,
-        spacingInches,
-        cellsPerInch,
-        stepSize,
-        rotations,
-        (progress) => {
-          // Send both "trying" and "placed" events for real-time updates
-          if (progress.status === 'trying') {
-            sendMessage({
-              type: 'progress',
-              message: `Trying to place ${progress.itemId.split('_')[0]} on sheet ${sheetIndex + 1}...`,
-              currentSheet: sheetIndex + 1,
-              totalSheets: currentPageCount,
-              itemsPlaced: polygons.length - remainingPolygons.length + progress.current,
-              totalItems: polygons.length,
-              percentComplete: sheetProgress
-            });
-          } else if (progress.status === 'placed' && progress.placement) {
-            sendMessage({
-              type: 'progress',
-              message: `Placed ${progress.itemId.split('_')[0]} on sheet ${sheetIndex + 1}`,
-              currentSheet: sheetIndex + 1,
-              totalSheets: currentPageCount,
-              itemsPlaced: polygons.length - remainingPolygons.length + progress.current,
-              totalItems: polygons.length,
-              percentComplete: sheetProgress,
-              placement: {
-                sheetIndex,
-                id: progress.placement.id,
-                x: progress.placement.x * MM_PER_INCH,
-                y: progress.placement.y * MM_PER_INCH,
-                rotation: progress.placement.rotation
-              }
-            });
-          }
+      // Remaining items that still hold an earlier sheet's design mix repeat its layout
+      // without packing (the PDF renders the layout once and lists the copies)
+      const remnant = data.remnants?.[sheetIndex];
+      const repeat = remnant ? null : repeatPackedSheet(templates, remainingPolygons.map(p => p.id), designKeys);
+      let sheet: SheetPlacement;
+      if (repeat) {
+        sheet = {
+          sheetIndex,
+          placements: repeat.placements,
+          utilization: repeat.template.utilization,
+          copyOf: repeat.template.sheetIndex,
+        };
+      } else {
+        // Set up real-time progress callback
+        const packer = new PolygonPacker(
+          sheetWidthInches,
+          sheetHeightInches,
+          spacingInches,
+          cellsPerInch,
+          stepSize,
+          rotations,
+          (progress) => {
+            // Send both "trying" and "placed" events for real-time updates
+            if (progress.status === 'trying') {
+              sendMessage({
+                type: 'progress',
+                message: `Trying to place ${progress.itemId.split('_')[0]} on sheet ${sheetIndex + 1}...`,
+                currentSheet: sheetIndex + 1,
+                totalSheets: currentPageCount,
+                itemsPlaced: polygons.length - remainingPolygons.length + progress.current,
+                totalItems: polygons.length,
+                percentComplete: sheetProgress
+              });
+            } else if (progress.status === 'placed' && progress.placement) {
+              sendMessage({
+                type: 'progress',
+                message: `Placed ${progress.itemId.split('_')[0]} on sheet ${sheetIndex + 1}`,
+                currentSheet: sheetIndex + 1,
+                totalSheets: currentPageCount,
+                itemsPlaced: polygons.length - remainingPolygons.length + progress.current,
+                totalItems: polygons.length,
+                percentComplete: sheetProgress,
+                placement: {
+                  sheetIndex,
+                  id: progress.placement.id,
+                  x: progress.placement.x * MM_PER_INCH,
+                  y: progress.placement.y * MM_PER_INCH,
+                  rotation: progress.placement.rotation
+                }
+              });
+            }
+          },
+          shapeCache
+        );
+
+        if (remnant) {
+          packer.addObstacles(toObstaclesInches(remnant, MM_PER_INCH));
         }
-      );
+        const result = await runPacker(packer, remainingPolygons, data);
 
-      const result = await packer.pack(remainingPolygons);
+        // A remnant with too little left keeps its (empty) slot and packing moves on to the next sheet
+        if (result.placements.length === 0 && !remnant) {
+          stalled = true;
+          break;
+        }
 
-      if (result.placements.length === 0) {
-        break;
+        // Convert placements (inches → mm)
+        const placements = result.placements.map(p => ({
+          id: p.id,
+          x: p.x * MM_PER_INCH,
+          y: p.y * MM_PER_INCH,
+          rotation: p.rotation,
+        }));
+
+        // Calculate utilization
+        const usedAreaInches = result.placements.reduce((sum, p) => {
+          const poly = polygons.find(poly => poly.id === p.id);
+          return sum + (poly ? poly.area : 0);
+        }, 0);
+        const sheetAreaInches = sheetWidthInches * sheetHeightInches;
+        const utilization = (usedAreaInches / sheetAreaInches) * 100;
+
+        sheet = {
+          sheetIndex,
+          placements,
+          utilization,
+        };
+        if (!remnant) {
+          templates.push({ sheet, designs: new Set(remainingPolygons.map(p => designKeys.get(p.id)!)) });
+        }
       }
+      sheets.push(sheet);
 
-      // Convert placements (inches → mm)
-      const placements = result.placements.map(p => ({
-        id: p.id,
-        x: p.x * MM_PER_INCH,
-        y: p.y * MM_PER_INCH,
-        rotation: p.rotation,
-      }));
-
-      // Calculate utilization
-      const usedAreaInches = result.placements.reduce((sum, p) => {
-        const poly = polygons.find(poly => poly.id === p.id);
-        return sum + (poly ? poly.area : 0);
-      }, 0);
-      const sheetAreaInches = sheetWidthInches * sheetHeightInches;
-      const utilization = (usedAreaInches / sheetAreaInches) * 100;
-
-      sheets.push({
-        sheetIndex,
-        placements,
-        utilization,
-      });
+      // Sheets are final once packed: stream them out so rendering/printing can start early
+      sendMessage({ type: 'sheet', sheet });
 
       // Remove placed items
-      const placedIds = new Set(result.placements.map(p => p.id));
+      const placedIds = new Set(sheet.placements.map(p => p.id));
       remainingPolygons = remainingPolygons.filter(p => !placedIds.has(p.id));
+
+      // Checkpoint so a restart loses at most the sheet in progress
+      sendMessage({
+        type: 'checkpoint',
+        checkpoint: {
+          sheets,
+          remainingIds: remainingPolygons.map(p => p.id),
+          pageCount: currentPageCount,
+          attempts,
+          savedAt: Date.now()
+        }
+      });
     }
 
     // Calculate quantities
@@ -412,6 +638,9 @@ async function performMultiSheetPacking(data: PackingWorkerData) {
       });
     } else {
       if (packAllItems) {
+        if (stalled) {
+          throw new Error(`Failed to pack all items: ${remainingPolygons.length} items don't fit on an empty sheet`);
+        }
         currentPageCount++;
         if (currentPageCount > MAX_PAGES) {
           throw new Error(`Failed to pack all items even with ${MAX_PAGES} pages`);
@@ -437,12 +666,24 @@ async function performMultiSheetPacking(data: PackingWorkerData) {
   // Generate message
   let message: string | undefined;
   const totalItemsPlaced = Object.values(finalQuantities).reduce((a, b) => a + b, 0);
-  if (packAllItems && currentPageCount > pageCount) {
-    message = `Auto-expanded from ${pageCount} to ${currentPageCount} pages to fit all ${stickers.length} items`;
+  if (packAllItems && finalSheets.length > pageCount) {
+    message = `Auto-expanded from ${pageCount} to ${finalSheets.length} pages to fit all ${stickers.length} items`;
   } else if (!packAllItems && totalItemsPlaced < stickers.length) {
     const unplaced = stickers.length - totalItemsPlaced;
     message = `${totalItemsPlaced}/${stickers.length} items packed. ${unplaced} items did not fit. Increase page count.`;
   }
+  const copies = groupSheetCopies(finalSheets);
+  if (copies) {
+    const summary = `Print run: ${describeSheetCopies(copies)}`;
+    message = message ? `${message}. ${summary}` : summary;
+  }
+
+  // Report achieved efficiency so the main thread can refine the predictor
+  // Remnant jobs don't say how full a fresh sheet gets, so they don't train the predictor
+  const efficiency = efficiencyFromSheets(finalSheets.map(s => s.utilization), allItemsPlaced);
+  if (efficiency !== null && !data.remnants) {
+    sendMessage({ type: 'calibration', sample: { features, efficiency } });
+  }
 
   sendMessage({
     type: 'progress',
@@ -457,6 +698,97 @@ async function performMultiSheetPacking(data: PackingWorkerData) {
       totalUtilization,
       quantities: finalQuantities,
       message,
+      copies,
+    }
+  });
+}
+
+/**
+ * Multi-sheet packing across a mix of stock sizes: every sheet opens the stock that
+ * packs the remaining items with the least waste. Always packs all items
+ */
+async function performMultiStockPacking(data: PackingWorkerData) {
+  const { stickers, spacing, cellsPerInch, stepSize, rotations } = data;
+  const stocks = data.stocks!;
+  const MM_PER_INCH = 25.4;
+  const stocksInches = stocks.map(stock => ({ ...stock, width: stock.width / MM_PER_INCH, height: stock.height / MM_PER_INCH }));
+  const polygons: PackablePolygon[] = stickers.map(sticker => toPackablePolygon(sticker, MM_PER_INCH));
+
+  // Outlines are rotated/offset once and reused by every candidate stock and sheet
+  const shapeCache = new ShapeCache();
+
+  const resume = data.resumeFrom;
+  const sheets: SheetPlacement[] = resume ? [...resume.sheets] : [];
+  let remainingPolygons = polygons;
+  if (resume) {
+    const remainingIds = new Set(resume.remainingIds);
+    remainingPolygons = polygons.filter(p => remainingIds.has(p.id));
+    sheets.forEach(sheet => sendMessage({ type: 'sheet', sheet }));
+  }
+
+  sendMessage({
+    type: 'progress',
+    message: `Starting multi-stock polygon packing (${stocks.map(s => s.id).join(', ')})`,
+    totalItems: polygons.length,
+    itemsPlaced: polygons.length - remainingPolygons.length,
+    percentComplete: 0
+  });
+
+  while (remainingPolygons.length > 0) {
+    sendMessage({
+      type: 'progress',
+      message: `Choosing stock for sheet ${sheets.length + 1} (${stocks.length} candidates)`,
+      currentSheet: sheets.length + 1,
+      itemsPlaced: polygons.length - remainingPolygons.length,
+      totalItems: polygons.length,
+      percentComplete: Math.floor(((polygons.length - remainingPolygons.length) / polygons.length) * 90)
+    });
+
+    const next = await packNextStockSheet(
+      remainingPolygons, stocksInches, spacing / MM_PER_INCH, cellsPerInch, stepSize, rotations, shapeCache,
+      (packer, items) => runPacker(packer, items, data)
+    );
+    if (!next) {
+      throw new Error(`Failed to pack all items: ${remainingPolygons.length} items don't fit on any stock size`);
     }
+
+    const placedIds = new Set(next.result.placements.map(p => p.id));
+    const usedArea = remainingPolygons.filter(p => placedIds.has(p.id)).reduce((sum, p) => sum + p.area, 0);
+    const sheet: SheetPlacement = {
+      sheetIndex: sheets.length,
+      placements: next.result.placements.map(p => ({
+        id: p.id,
+        x: p.x * MM_PER_INCH,
+        y: p.y * MM_PER_INCH,
+        rotation: p.rotation,
+      })),
+      utilization: (usedArea / (next.stock.width * next.stock.height)) * 100,
+      stock: stocks.find(s => s.id === next.stock.id),
+    };
+    sheets.push(sheet);
+    sendMessage({ type: 'sheet', sheet });
+
+    remainingPolygons = next.result.unplacedPolygons;
+    sendMessage({
+      type: 'checkpoint',
+      checkpoint: {
+        sheets,
+        remainingIds: remainingPolygons.map(p => p.id),
+        pageCount: sheets.length,
+        attempts: 1,
+        savedAt: Date.now()
+      }
+    });
+  }
+
+  sendMessage({
+    type: 'progress',
+    message: `Success! All ${stickers.length} items packed on ${sheets.length} sheets`,
+    percentComplete: 100
+  });
+
+  sendMessage({
+    type: 'result',
+    result: summarizeStockSheets(sheets, polygons)
   });
 }
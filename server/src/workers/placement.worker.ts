@@ -0,0 +1,68 @@
+/**
+ * Helper thread for concurrent single-sheet placement
+ * Shares the sheet grid and the item counter with the job's packing worker and its other
+ * helpers; reports each committed placement as it lands
+ */
+import { parentPort, workerData } from 'worker_threads';
+import {
+  PolygonPacker,
+  PackablePolygon,
+  PlacementScoringWeights,
+  RasterGrid,
+  SharedGridState,
+  claimFrom,
+  createWeightedScorer
+} from '../services/polygon-packing.service';
+
+export interface PlacementWorkerData {
+  polygons: PackablePolygon[]; // Sorted largest first, identical in every thread (inches)
+  sheetWidth: number;          // inches
+  sheetHeight: number;         // inches
+  spacing: number;             // inches
+  cellsPerInch: number;
+  stepSize: number;
+  rotations: number[];
+  grid: SharedGridState;
+  counter: SharedArrayBuffer;  // Int32 index of the next unclaimed item
+  placementScoring?: Partial<PlacementScoringWeights>;
+}
+
+export type PlacementWorkerMessage =
+  | { type: 'placed'; placement: { id: string; x: number; y: number; rotation: number } }
+  | { type: 'done'; unplacedIds: string[]; conflicts: number }
+  | { type: 'error'; error: string };
+
+if (parentPort) {
+  const data = workerData as PlacementWorkerData;
+  const post = (message: PlacementWorkerMessage) => parentPort!.postMessage(message);
+
+  (async () => {
+    try {
+      const grid = new RasterGrid(data.sheetWidth, data.sheetHeight, data.cellsPerInch, data.grid);
+      const packer = new PolygonPacker(
+        data.sheetWidth,
+        data.sheetHeight,
+        data.spacing,
+        data.cellsPerInch,
+        data.stepSize,
+        data.rotations,
+        progress => {
+          if (progress.status === 'placed' && progress.placement) {
+            const { id, x, y, rotation } = progress.placement;
+            post({ type: 'placed', placement: { id, x, y, rotation } });
+          }
+        },
+        undefined,
+        grid
+      );
+      if (data.placementScoring) {
+        packer.setPlacementScorer(createWeightedScorer(data.placementScoring));
+      }
+
+      const result = await packer.packShared(data.polygons, claimFrom(data.counter));
+      post({ type: 'done', unplacedIds: result.unplacedPolygons.map(p => p.id), conflicts: result.conflicts });
+    } catch (error: any) {
+      post({ type: 'error', error: error.message || 'Unknown error in placement worker' });
+    }
+  })();
+}
@@ -11,6 +11,8 @@ import { ProgressBarComponent } from './components/progress-bar.component';
 // Services
 import {
   ImageAnalysisService,
+  ImagePreprocessService,
+  SpriteAtlasService,
   ApiService
 } from './services';
 
@@ -21,7 +23,7 @@ import {
   UnitConverter
 } from './models';
 
-import { SheetPlacement } from './services/api.service';
+import { ProcessedImage, SheetPlacement } from './services/api.service';
 
 /**
  * Main application component
@@ -81,14 +83,19 @@ export class App implements OnInit, OnDestroy {
     maxDimensionMM: 76.2,    // 3" in mm - max dimension for ALL stickers
     unit: 'inches' as 'inches' | 'mm',  // User's preferred unit
     usePolygonPacking: false,  // Use polygon-based packing instead of rectangle packing
+    hybridPacking: true,       // Polygon packing: MaxRects for near-rectangular designs
+    beamWidth: 1,              // Polygon packing: partial layouts kept by the lookahead (1 = off)
     cellsPerInch: 100,         // Grid resolution for polygon packing
-    stepSize: 0.05             // Position search step size for polygon packing (inches)
+    stepSize: 0.05,            // Position search step size for polygon packing (inches)
+    preprocessOnClient: false  // Downscale and trace uploads in the browser before sending them
   };
 
   private subscriptions = new Subscription();
 
   constructor(
     private imageAnalysis: ImageAnalysisService,
+    private imagePreprocess: ImagePreprocessService,
+    private spriteAtlas: SpriteAtlasService,
     private apiService: ApiService
   ) {}
 
@@ -105,6 +112,13 @@ export class App implements OnInit, OnDestroy {
       })
     );
 
+    this.subscriptions.add(
+      this.apiService.onNestingSheet().subscribe(({ sheet }: { jobId: string; sheet: SheetPlacement }) => {
+        // Replace the live-built preview with the packer's finalized sheet
+        this.handleSheetFinalized(sheet);
+      })
+    );
+
     this.subscriptions.add(
       this.apiService.onNestingComplete().subscribe(({ jobId, result }: { jobId: string; result: any }) => {
         console.log('Nesting complete:', jobId, result);
@@ -140,44 +154,51 @@ export class App implements OnInit, OnDestroy {
         ? this.config.maxDimensionMM / 25.4
         : this.config.maxDimensionMM;
 
+      // Optionally downscale to print size and trace in the browser, so only what
+      // will print is uploaded and the server skips the trace (null = send the original)
+      const prepared = this.config.preprocessOnClient
+        ? await this.imagePreprocess.prepareAll(files, this.config.maxDimensionMM)
+        : files.map(() => null);
+
       // Process all files via backend API with progress tracking
-      const processedImages = await this.apiService.processImages(
-        files,
+      // Each sticker is added as soon as the server has traced it (previews decode in arrival order);
+      // a preview that fails to decode skips that file only
+      let added = Promise.resolve();
+      const addedIds: string[] = [];
+      await this.apiService.processImages(
+        files.map((file, index) => prepared[index]?.file ?? file),
         maxDimension,
         this.config.unit,
         (progress) => {
           this.uploadProgress = progress;
-        }
+        },
+        (processed, index) => {
+          added = added.then(async () => {
+            try {
+              this.stickers.push(await this.createSticker(processed, files[index], prepared[index]?.file));
+              addedIds.push(processed.id);
+            } catch (error) {
+              console.error(`Error loading preview for ${files[index].name}:`, error);
+            }
+          });
+        },
+        prepared.map(upload => upload?.outline ?? null)
       );
+      await added;
 
-      // Create sticker objects with processed data
-      for (let i = 0; i < processedImages.length; i++) {
-        const processed = processedImages[i];
-        const file = files[i];
-
-        const sticker: StickerSource = {
-          id: processed.id,
-          file,
-          bitmap: await this.imageAnalysis.loadImageBitmap(file),
-          inputDimensions: {
-            width: processed.width,
-            height: processed.height,
-            unit: 'mm'
-          },
-          originalPath: processed.path,
-          simplifiedPath: processed.path,
-          offsetPath: processed.path,
-          margin: this.config.marginMM,
-          isProcessed: true
-        };
-
-        this.stickers.push(sticker);
+      const skipped = files.filter(file => !addedIds.includes(file.name));
+      if (skipped.length > 0) {
+        alert(`Could not process: ${skipped.map(file => file.name).join(', ')}`);
       }
 
-      // Automatically run nesting after upload
+      // Automatically run nesting after upload - only the new stickers if a layout exists
       this.showUploadProgress = false;
       this.isProcessing = false;
-      await this.onStartNesting();
+      if (this.canRenestIncrementally) {
+        await this.renestIncrementally({ added: addedIds });
+      } else {
+        await this.onStartNesting();
+      }
     } catch (error) {
       console.error('Error processing files:', error);
       alert('Error processing files. Please try again.');
@@ -186,6 +207,30 @@ export class App implements OnInit, OnDestroy {
     }
   }
 
+  /**
+   * Build a sticker from a traced upload
+   */
+  private async createSticker(processed: ProcessedImage, file: File, printFile?: File): Promise<StickerSource> {
+    return {
+      id: processed.id,
+      file,
+      printFile,
+      sprite: this.spriteAtlas.add(await this.imageAnalysis.loadImageBitmap(printFile ?? file)),
+      inputDimensions: {
+        width: processed.width,
+        height: processed.height,
+        unit: 'mm'
+      },
+      originalPath: processed.path,
+      simplifiedPath: processed.path,
+      offsetPath: processed.path,
+      holes: processed.holes,
+      descriptors: processed.descriptors,
+      margin: this.config.marginMM,
+      isProcessed: true
+    };
+  }
+
   /**
    * Handle file input change event
    */
@@ -216,8 +261,10 @@ export class App implements OnInit, OnDestroy {
         stickers: this.stickers.map(s => ({
           id: s.id,
           points: s.simplifiedPath,
+          holes: s.holes,
           width: s.inputDimensions.width,
-          height: s.inputDimensions.height
+          height: s.inputDimensions.height,
+          descriptors: s.descriptors
         })),
         sheetWidth: this.config.sheetWidthMM,
         sheetHeight: this.config.sheetHeightMM,
@@ -225,6 +272,8 @@ export class App implements OnInit, OnDestroy {
         productionMode: this.config.productionMode,
         sheetCount: this.config.sheetCount,
         usePolygonPacking: this.config.usePolygonPacking,
+        hybrid: this.config.hybridPacking,
+        beamWidth: this.config.beamWidth,
         cellsPerInch: this.config.cellsPerInch,
         stepSize: this.config.stepSize,
         // For polygon packing: packAllItems=true means fill ALL stickers, auto-expand pages
@@ -314,6 +363,22 @@ export class App implements OnInit, OnDestroy {
     }
   }
 
+  /**
+   * Handle a sheet finalized before the whole job completes
+   */
+  private handleSheetFinalized(sheet: SheetPlacement): void {
+    while (this.sheets.length <= sheet.sheetIndex) {
+      this.sheets.push({
+        sheetIndex: this.sheets.length,
+        placements: [],
+        utilization: 0
+      });
+    }
+    this.sheets[sheet.sheetIndex] = sheet;
+    this.placements = this.sheets[0].placements;
+    console.log(`Sheet ${sheet.sheetIndex + 1} finalized: ${sheet.placements.length} placements, ${sheet.utilization.toFixed(1)}% utilization`);
+  }
+
   /**
    * Handle nesting completion (from both sync and async paths)
    */
@@ -360,7 +425,7 @@ export class App implements OnInit, OnDestroy {
       // Create map of files for backend
       const fileMap = new Map<string, File>();
       this.stickers.forEach(sticker => {
-        fileMap.set(sticker.id, sticker.file);
+        fileMap.set(sticker.id, sticker.printFile ?? sticker.file);
       });
 
       // Prepare sticker data for PDF generation (all dimensions in mm)
@@ -412,6 +477,7 @@ export class App implements OnInit, OnDestroy {
   onReset(): void {
     if (confirm('Are you sure you want to reset? All progress will be lost.')) {
       this.stickers = [];
+      this.spriteAtlas.clear();
       this.placements = [];
       this.sheets = [];
       this.quantities = {};
@@ -460,6 +526,25 @@ export class App implements OnInit, OnDestroy {
         x: p.x * scaleFactor,
         y: p.y * scaleFactor
       }));
+      sticker.holes = sticker.holes?.map(hole => hole.map(p => ({
+        x: p.x * scaleFactor,
+        y: p.y * scaleFactor
+      })));
+
+      // Scale descriptors (areas quadratically, perimeter linearly)
+      if (sticker.descriptors) {
+        sticker.descriptors = {
+          area: sticker.descriptors.area * scaleFactor * scaleFactor,
+          hullArea: sticker.descriptors.hullArea * scaleFactor * scaleFactor,
+          perimeter: sticker.descriptors.perimeter * scaleFactor,
+          solidity: sticker.descriptors.solidity
+        };
+      }
+
+      // A print-size copy is too small once the sticker grows: print the original again
+      if (scaleFactor > 1) {
+        sticker.printFile = undefined;
+      }
     });
 
     // Clear existing placements so user needs to re-nest
@@ -479,10 +564,27 @@ export class App implements OnInit, OnDestroy {
     const value = parseFloat(input.value);
 
     if (value > 0 && !isNaN(value)) {
-      this.stickers[index].inputDimensions[dimension] = value;
-
-      // Clear placements when dimensions change so user needs to re-nest
-      if (this.placements.length > 0 || this.sheets.length > 0) {
+      const sticker = this.stickers[index];
+      const scale = value / sticker.inputDimensions[dimension];
+      sticker.inputDimensions[dimension] = value;
+
+      // Stretch the outline along the edited axis so polygon packing sees the new size
+      const stretch = (p: { x: number; y: number }) => dimension === 'width'
+        ? { x: p.x * scale, y: p.y }
+        : { x: p.x, y: p.y * scale };
+      sticker.originalPath = sticker.originalPath.map(stretch);
+      sticker.simplifiedPath = sticker.simplifiedPath.map(stretch);
+      sticker.offsetPath = sticker.offsetPath.map(stretch);
+      sticker.holes = sticker.holes?.map(hole => hole.map(stretch));
+
+      // Non-uniform resize invalidates trace-time descriptors; backend recomputes from the outline
+      sticker.descriptors = undefined;
+
+      if (this.canRenestIncrementally) {
+        // Keep the rest of the layout; only this sticker and its neighbours move
+        this.renestIncrementally({ resized: [sticker.id] });
+      } else if (this.placements.length > 0 || this.sheets.length > 0) {
+        // Clear placements when dimensions change so user needs to re-nest
         this.placements = [];
         this.sheets = [];
         this.utilization = 0;
@@ -490,6 +592,65 @@ export class App implements OnInit, OnDestroy {
     }
   }
 
+  /**
+   * Re-nest the current single-sheet polygon layout after an edit
+   * The server keeps unaffected placements, or falls back to a full packing job
+   * (reported over Socket.IO like onStartNesting) when the layout would get worse
+   */
+  private async renestIncrementally(changes: { added?: string[]; removed?: string[]; resized?: string[] }): Promise<void> {
+    this.isNesting = true;
+    const previous = this.placements;
+
+    try {
+      const response = await this.apiService.renestStickers({
+        stickers: this.stickers.map(s => ({
+          id: s.id,
+          points: s.simplifiedPath,
+          holes: s.holes,
+          width: s.inputDimensions.width,
+          height: s.inputDimensions.height,
+          descriptors: s.descriptors
+        })),
+        previous,
+        changes,
+        sheetWidth: this.config.sheetWidthMM,
+        sheetHeight: this.config.sheetHeightMM,
+        spacing: this.config.spacingMM,
+        cellsPerInch: this.config.cellsPerInch,
+        stepSize: this.config.stepSize
+      });
+
+      if (response.jobId) {
+        console.log(`Incremental re-nest fell back to full packing job: ${response.jobId}`);
+        this.placements = [];
+        this.sheets = [];
+        this.showNestingProgress = true;
+        this.nestingProgress = 0;
+        this.nestingMessage = 'Re-packing sheet...';
+        return;
+      }
+
+      console.log(`Incremental re-nest: kept ${response.kept?.length ?? 0}, moved ${response.repacked?.length ?? 0}`);
+      this.handleNestingComplete(response);
+    } catch (error) {
+      console.error('Incremental re-nest error:', error);
+      this.placements = [];
+      this.sheets = [];
+      this.utilization = 0;
+      this.isNesting = false;
+    }
+  }
+
+  /**
+   * Incremental re-nesting applies to an existing single-sheet polygon layout
+   */
+  private get canRenestIncrementally(): boolean {
+    return this.config.usePolygonPacking &&
+      !this.config.productionMode &&
+      this.placements.length > 0 &&
+      !this.isNesting;
+  }
+
   /**
    * Computed properties for UI state
    */
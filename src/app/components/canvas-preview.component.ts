@@ -257,13 +257,15 @@ export class CanvasPreviewComponent implements AfterViewInit, OnChanges {
       const ctx = htmlCanvas.getContext('2d');
       if (!ctx) return;
 
-      // Setup canvas size
+      // Setup canvas size (multi-stock sheets carry their own size)
       const maxWidth = 300;
-      const aspectRatio = this.sheetWidth / this.sheetHeight;
+      const sheetWidth = sheet.stock?.width ?? this.sheetWidth;
+      const sheetHeight = sheet.stock?.height ?? this.sheetHeight;
+      const aspectRatio = sheetWidth / sheetHeight;
       htmlCanvas.width = maxWidth;
       htmlCanvas.height = maxWidth / aspectRatio;
 
-      const scale = htmlCanvas.width / this.sheetWidth;
+      const scale = htmlCanvas.width / sheetWidth;
 
       // Clear canvas
       ctx.clearRect(0, 0, htmlCanvas.width, htmlCanvas.height);
@@ -349,11 +351,7 @@ export class CanvasPreviewComponent implements AfterViewInit, OnChanges {
         ctx.rotate(angleRad);
 
         // Draw image centered using ORIGINAL dimensions
-        if (sticker.bitmap) {
-          ctx.globalAlpha = 0.8;
-          ctx.drawImage(sticker.bitmap, -width / 2, -height / 2, width, height);
-          ctx.globalAlpha = 1.0;
-        }
+        this.drawSpriteOnContext(ctx, sticker, -width / 2, -height / 2, width, height);
 
         // Draw outline
         if (sticker.simplifiedPath.length > 0) {
@@ -379,11 +377,7 @@ export class CanvasPreviewComponent implements AfterViewInit, OnChanges {
         ctx.rotate(angleRad);
 
         // Draw image offset by negative half dimensions (no swap for non-90° rotations)
-        if (sticker.bitmap) {
-          ctx.globalAlpha = 0.8;
-          ctx.drawImage(sticker.bitmap, -width / 2, -height / 2, width, height);
-          ctx.globalAlpha = 1.0;
-        }
+        this.drawSpriteOnContext(ctx, sticker, -width / 2, -height / 2, width, height);
 
         // Draw outline
         if (sticker.simplifiedPath.length > 0) {
@@ -406,11 +400,7 @@ export class CanvasPreviewComponent implements AfterViewInit, OnChanges {
       }
     } else {
       // No rotation: Draw at origin (0, 0)
-      if (sticker.bitmap) {
-        ctx.globalAlpha = 0.8;
-        ctx.drawImage(sticker.bitmap, 0, 0, width, height);
-        ctx.globalAlpha = 1.0;
-      }
+      this.drawSpriteOnContext(ctx, sticker, 0, 0, width, height);
 
       // Draw outline (subtle)
       if (sticker.simplifiedPath.length > 0) {
@@ -422,6 +412,25 @@ export class CanvasPreviewComponent implements AfterViewInit, OnChanges {
     ctx.restore();
   }
 
+  /**
+   * Draw a sticker's preview image from its region of the sprite atlas
+   */
+  private drawSpriteOnContext(
+    ctx: CanvasRenderingContext2D,
+    sticker: StickerSource,
+    x: number,
+    y: number,
+    width: number,
+    height: number
+  ): void {
+    const sprite = sticker.sprite;
+    if (!sprite) return;
+
+    ctx.globalAlpha = 0.8;
+    ctx.drawImage(sprite.image, sprite.x, sprite.y, sprite.width, sprite.height, x, y, width, height);
+    ctx.globalAlpha = 1.0;
+  }
+
   private drawPathOnContext(
     ctx: CanvasRenderingContext2D,
     points: { x: number; y: number }[],
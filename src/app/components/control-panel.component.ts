@@ -67,6 +67,22 @@ import {
           </label>
         </div>
 
+        <!-- Client-side Preprocessing -->
+        <div class="form-group">
+          <label>
+            <input
+              type="checkbox"
+              [(ngModel)]="config.preprocessOnClient"
+              (change)="onConfigChange()"
+              class="checkbox-input"
+            />
+            Prepare Images in Browser
+          </label>
+          <small class="help-text">
+            Downscales images to print size and traces outlines before upload (faster uploads for large photos)
+          </small>
+        </div>
+
         <!-- Polygon Packing Mode -->
         <div class="form-group">
           <label>
@@ -83,6 +99,38 @@ import {
           </small>
         </div>
 
+        <!-- Hybrid Packing (only shown when polygon packing is enabled) -->
+        <div class="form-group" *ngIf="config.usePolygonPacking">
+          <label>
+            <input
+              type="checkbox"
+              [(ngModel)]="config.hybridPacking"
+              (change)="onConfigChange()"
+              class="checkbox-input"
+            />
+            Fast Path for Rectangular Designs
+          </label>
+          <small class="help-text">
+            Packs near-rectangular stickers as rectangles and uses shape search only for irregular ones
+          </small>
+        </div>
+
+        <!-- Lookahead (only shown when polygon packing is enabled) -->
+        <div class="form-group" *ngIf="config.usePolygonPacking">
+          <label>Lookahead:</label>
+          <select
+            [(ngModel)]="config.beamWidth"
+            (change)="onConfigChange()"
+          >
+            <option [ngValue]="1">Off (Fast)</option>
+            <option [ngValue]="3">3 Layouts (Balanced)</option>
+            <option [ngValue]="8">8 Layouts (Tightest)</option>
+          </select>
+          <small class="help-text">
+            Keeps several partial layouts per item instead of the first fit; replaces the rectangular fast path
+          </small>
+        </div>
+
         <!-- Rotation Granularity (only shown when polygon packing is enabled) -->
         <div class="form-group" *ngIf="config.usePolygonPacking">
           <label>Rotation Granularity:</label>
@@ -526,9 +574,12 @@ export class ControlPanelComponent implements OnInit {
     maxDimensionMM: 76.2,    // 3" in mm - max dimension for ALL stickers
     unit: 'inches' as 'inches' | 'mm',  // User's preferred unit
     usePolygonPacking: false,  // Use polygon-based packing instead of rectangle packing
+    hybridPacking: true,       // Polygon packing: MaxRects for near-rectangular designs
+    beamWidth: 1,              // Polygon packing: partial layouts kept by the lookahead (1 = off)
     rotationPreset: '15',      // Rotation granularity: '90', '45', '15', '10', '5'
     cellsPerInch: 50,          // Grid resolution for polygon packing (default from 15° preset)
-    stepSize: 0.1              // Position search step size for polygon packing in inches (default from 15° preset)
+    stepSize: 0.1,             // Position search step size for polygon packing in inches (default from 15° preset)
+    preprocessOnClient: false  // Downscale and trace uploads in the browser before sending them
   };
 
   // Sheet size state
@@ -783,9 +834,12 @@ export class ControlPanelComponent implements OnInit {
       maxDimensionMM: this.config.maxDimensionMM,
       unit: this.config.unit,
       usePolygonPacking: this.config.usePolygonPacking,
+      hybridPacking: this.config.hybridPacking,
+      beamWidth: this.config.beamWidth,
       rotationPreset: this.config.rotationPreset,
       cellsPerInch: this.config.cellsPerInch,
-      stepSize: this.config.stepSize
+      stepSize: this.config.stepSize,
+      preprocessOnClient: this.config.preprocessOnClient
     });
   }
 }
@@ -32,7 +32,7 @@ import { CommonModule } from '@angular/common';
           </svg>
           <h3>Upload Sticker Images</h3>
           <p>Drag and drop images here or click to browse</p>
-          <p class="hint">Supports PNG, JPG, and GIF with transparent backgrounds</p>
+          <p class="hint">Supports PNG, JPG, and GIF with transparent backgrounds, and SVG vector art</p>
         </div>
       </div>
       <input
@@ -21,3 +21,13 @@ export interface BoundingBox {
   width: number;
   height: number;
 }
+
+/**
+ * Exact shape descriptors computed by the backend at trace time (mm units)
+ */
+export interface ShapeDescriptors {
+  area: number;
+  hullArea: number;
+  perimeter: number;
+  solidity: number;
+}
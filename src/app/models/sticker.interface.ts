@@ -1,4 +1,15 @@
-import { Point, Dimensions } from './geometry.types';
+import { Point, Dimensions, ShapeDescriptors } from './geometry.types';
+
+/**
+ * A sticker's preview image: a region of a shared sprite atlas page (see SpriteAtlasService)
+ */
+export interface Sprite {
+  image: CanvasImageSource; // Atlas page
+  x: number;
+  y: number;
+  width: number;
+  height: number;
+}
 
 /**
  * StickerSource represents a single sticker image with all its geometric data
@@ -7,7 +18,8 @@ import { Point, Dimensions } from './geometry.types';
 export interface StickerSource {
   id: string; // UUID
   file: File; // Original user file
-  bitmap: ImageBitmap | null; // GPU-ready bitmap for Canvas Preview
+  printFile?: File; // Print-size copy prepared in the browser (uploaded and printed instead of file)
+  sprite: Sprite | null; // Preview-resolution image for Canvas Preview (full resolution stays in file)
 
   // Dimensionality
   inputDimensions: Dimensions;
@@ -16,6 +28,8 @@ export interface StickerSource {
   originalPath: Point[]; // High-res path from ImageTracer
   simplifiedPath: Point[]; // Low-res path for Nesting
   offsetPath: Point[]; // The margin/bleed path
+  holes?: Point[][]; // Interior holes of simplifiedPath (other stickers may nest in them)
+  descriptors?: ShapeDescriptors; // Exact area/hull/perimeter/solidity from backend trace
 
   // Configuration
   margin: number; // In inches
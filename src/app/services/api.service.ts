@@ -1,23 +1,33 @@
 import { Injectable, inject } from '@angular/core';
 import { HttpClient, HttpEventType } from '@angular/common/http';
 import { firstValueFrom, Observable, Subject } from 'rxjs';
-import { Point } from '../models/geometry.types';
+import { Point, ShapeDescriptors } from '../models/geometry.types';
 import { Placement } from '../models/nesting.interface';
 import { io, Socket } from 'socket.io-client';
 
 export interface ProcessedImage {
   id: string;
   path: Point[];
+  holes?: Point[][]; // Interior holes of the outline (mm)
   width: number;
   height: number;
+  descriptors?: ShapeDescriptors;
 }
 
+// Lines of the /process NDJSON stream
+type ProcessStreamEvent =
+  | { type: 'image'; index: number; image: ProcessedImage }
+  | { type: 'error'; index: number; id: string; error: string }
+  | { type: 'complete'; summary: { processed: number; failed: number } };
+
 export interface NestingApiRequest {
   stickers: Array<{
     id: string;
     points: Point[];
+    holes?: Point[][];
     width: number;
     height: number;
+    descriptors?: ShapeDescriptors;
   }>;
   sheetWidth: number;
   sheetHeight: number;
@@ -25,15 +35,32 @@ export interface NestingApiRequest {
   productionMode?: boolean;
   sheetCount?: number;
   usePolygonPacking?: boolean;
+  hybrid?: boolean;        // Polygon packing: MaxRects for near-rectangular designs, raster search for the rest
+  beamWidth?: number;     // Polygon packing: > 1 keeps this many partial layouts (slower, tighter sheets)
+  placementScoring?: boolean | { contact?: number; hullGrowth?: number; fragmentation?: number };  // Rank positions instead of first-fit
+  placementWorkers?: number;  // Single-sheet polygon packing: threads placing items concurrently
   cellsPerInch?: number;
   stepSize?: number;
   packAllItems?: boolean;  // For polygon packing: true = pack all items (auto-expand pages)
+  stocks?: Array<{ id: string; width: number; height: number }>;  // Mix of stock sizes (mm) to choose from per sheet
+}
+
+export interface IncrementalNestingApiRequest extends NestingApiRequest {
+  previous: Placement[];  // Last single-sheet layout (mm)
+  changes: {
+    added?: string[];
+    removed?: string[];
+    resized?: string[];
+  };
+  qualityThreshold?: number;
 }
 
 export interface SheetPlacement {
   sheetIndex: number;
   placements: Placement[];
   utilization: number;
+  stock?: { id: string; width: number; height: number }; // Sheet size (mm) in multi-stock jobs
+  copyOf?: number; // Repeats the layout of this earlier sheet
 }
 
 export interface NestingApiResponse {
@@ -43,6 +70,11 @@ export interface NestingApiResponse {
   sheets?: SheetPlacement[];
   totalUtilization?: number;
   quantities?: { [stickerId: string]: number };
+  copies?: Array<{ sheetIndex: number; copies: number }>; // Distinct layouts and how many sheets print each
+  // For incremental re-nesting (absent when it fell back to a full packing job)
+  incremental?: boolean;
+  kept?: string[];
+  repacked?: string[];
   // For async polygon packing
   jobId?: string;
   message?: string;
@@ -89,6 +121,11 @@ export class ApiService {
   private nestingProgress$ = new Subject<NestingProgress>();
   private nestingComplete$ = new Subject<{ jobId: string; result: any }>();
   private nestingError$ = new Subject<{ jobId: string; error: string }>();
+  private nestingSheet$ = new Subject<{ jobId: string; sheet: SheetPlacement }>();
+
+  // Polygon packing job to (re)attach to after a reconnect or server restart
+  private activeJobId: string | null = null;
+  private finishedJobIds = new Set<string>();
 
   /**
    * Connect to Socket.IO server
@@ -110,11 +147,16 @@ export class ApiService {
       transports: ['websocket', 'polling'],
       reconnection: true,
       reconnectionDelay: 1000,
-      reconnectionAttempts: 5
+      reconnectionDelayMax: 5000,
+      reconnectionAttempts: 30 // Long enough to ride out a server restart
     });
 
     this.socket.on('connect', () => {
       console.log(`[API] Socket connected: ${this.socket?.id}`);
+      // Socket IDs change on reconnect; rejoin the running job by ID
+      if (this.activeJobId) {
+        this.attachToJob(this.activeJobId);
+      }
     });
 
     this.socket.on('disconnect', (reason: string) => {
@@ -126,14 +168,23 @@ export class ApiService {
       this.nestingProgress$.next(data);
     });
 
+    this.socket.on('nesting:sheet', (data: { jobId: string; sheet: SheetPlacement }) => {
+      console.log(`[API] Sheet ${data.sheet.sheetIndex + 1} finalized:`, data);
+      this.nestingSheet$.next(data);
+    });
+
     this.socket.on('nesting:complete', (data: { jobId: string; result: any }) => {
       console.log(`[API] Nesting complete:`, data);
-      this.nestingComplete$.next(data);
+      if (this.markJobFinished(data.jobId)) {
+        this.nestingComplete$.next(data);
+      }
     });
 
     this.socket.on('nesting:error', (data: { jobId: string; error: string }) => {
       console.error(`[API] Nesting error:`, data);
-      this.nestingError$.next(data);
+      if (this.markJobFinished(data.jobId)) {
+        this.nestingError$.next(data);
+      }
     });
 
     this.socket.on('connect_error', (error: Error) => {
@@ -152,6 +203,29 @@ export class ApiService {
     }
   }
 
+  /**
+   * Subscribe to a polygon packing job's events by job ID
+   */
+  attachToJob(jobId: string): void {
+    this.activeJobId = jobId;
+    this.socket?.emit('nesting:attach', { jobId });
+  }
+
+  /**
+   * Record a job as finished; returns false if it was already reported
+   * (the server replays the outcome to clients that reattach)
+   */
+  private markJobFinished(jobId: string): boolean {
+    if (this.finishedJobIds.has(jobId)) {
+      return false;
+    }
+    this.finishedJobIds.add(jobId);
+    if (this.activeJobId === jobId) {
+      this.activeJobId = null;
+    }
+    return true;
+  }
+
   /**
    * Get Socket ID (null if not connected)
    */
@@ -174,14 +248,29 @@ export class ApiService {
     return this.nestingError$.asObservable();
   }
 
+  /**
+   * Finalized sheets of a multi-sheet job, emitted as each one closes
+   */
+  onNestingSheet(): Observable<{ jobId: string; sheet: SheetPlacement }> {
+    return this.nestingSheet$.asObservable();
+  }
+
   /**
    * Process uploaded images and extract vector paths
+   * The server streams one NDJSON line per file as soon as it is traced, so onImage fires
+   * for each image in completion order (index = position in `files`). Resolves with the
+   * traced images in upload order; files the server couldn't trace are left out, and the
+   * call only fails if none could be traced
+   * `outlines` (aligned with `files`) carries outlines traced in the browser, in pixels of
+   * the uploaded file; the server uses them instead of tracing those files itself
    */
   async processImages(
     files: File[],
     maxDimension: number,
     unit: 'inches' | 'mm',
-    onProgress?: (progress: number) => void
+    onProgress?: (progress: number) => void,
+    onImage?: (image: ProcessedImage, index: number) => void,
+    outlines?: Array<{ path: Point[]; holes: Point[][] } | null>
   ): Promise<ProcessedImage[]> {
     const formData = new FormData();
 
@@ -192,24 +281,70 @@ export class ApiService {
     // Add max dimension and unit parameters
     formData.append('maxDimension', maxDimension.toString());
     formData.append('unit', unit);
+    if (outlines?.some(outline => outline !== null)) {
+      formData.append('outlines', JSON.stringify(outlines));
+    }
+
+    const images: Array<ProcessedImage | undefined> = new Array(files.length);
+    const failures: string[] = [];
+    let consumed = 0; // Characters of the response text already parsed
+
+    const handleLine = (line: string) => {
+      if (!line.trim()) return;
+      const event = JSON.parse(line) as ProcessStreamEvent;
+      if (event.type === 'image') {
+        images[event.index] = event.image;
+        onImage?.(event.image, event.index);
+      } else if (event.type === 'error') {
+        console.warn(`[API] Could not process ${event.id}: ${event.error}`);
+        failures.push(`${event.id}: ${event.error}`);
+      }
+    };
+    // Parse every complete line received so far (and the unterminated tail at the end)
+    const consume = (text: string, final: boolean) => {
+      let newline = text.indexOf('\n', consumed);
+      while (newline !== -1) {
+        handleLine(text.slice(consumed, newline));
+        consumed = newline + 1;
+        newline = text.indexOf('\n', consumed);
+      }
+      if (final) {
+        handleLine(text.slice(consumed));
+        consumed = text.length;
+      }
+    };
 
     return new Promise((resolve, reject) => {
-      this.http.post<{ images: ProcessedImage[] }>(
+      this.http.post(
         `${this.baseUrl}/nesting/process`,
         formData,
         {
+          headers: { Accept: 'application/x-ndjson' },
+          responseType: 'text',
           reportProgress: true,
           observe: 'events'
         }
       ).subscribe({
         next: (event) => {
-          if (event.type === HttpEventType.UploadProgress) {
-            if (event.total) {
-              const progress = Math.round((event.loaded / event.total) * 100);
-              onProgress?.(progress);
+          try {
+            if (event.type === HttpEventType.UploadProgress) {
+              if (event.total) {
+                const progress = Math.round((event.loaded / event.total) * 100);
+                onProgress?.(progress);
+              }
+            } else if (event.type === HttpEventType.DownloadProgress) {
+              if (event.partialText) consume(event.partialText, false);
+            } else if (event.type === HttpEventType.Response) {
+              consume(event.body || '', true);
+              const traced = images.filter((image): image is ProcessedImage => image !== undefined);
+              if (traced.length === 0 && failures.length > 0) {
+                reject(new Error(failures.join('; ')));
+              } else {
+                resolve(traced);
+              }
             }
-          } else if (event.type === HttpEventType.Response) {
-            resolve(event.body!.images);
+          } catch (error) {
+            reject(error);
           }
         },
         error: (error) => reject(error)
@@ -241,12 +376,40 @@ export class ApiService {
       socketId: request.usePolygonPacking ? socketId : null
     };
 
-    return await firstValueFrom(
+    const response = await firstValueFrom(
       this.http.post<NestingApiResponse>(
         `${this.baseUrl}/nesting/nest`,
         requestWithSocket
       )
     );
+
+    if (response.jobId) {
+      this.attachToJob(response.jobId);
+    }
+
+    return response;
+  }
+
+  /**
+   * Re-nest a single sheet after a small edit, keeping the previous layout where possible
+   * Returns the layout directly, or a job ID (like nestStickers) when the server falls back
+   * to a full polygon pack
+   */
+  async renestStickers(request: IncrementalNestingApiRequest): Promise<NestingApiResponse> {
+    const socketId = this.socket?.connected ? this.socket.id : null;
+
+    const response = await firstValueFrom(
+      this.http.post<NestingApiResponse>(
+        `${this.baseUrl}/nesting/nest/incremental`,
+        { ...request, socketId }
+      )
+    );
+
+    if (response.jobId) {
+      this.attachToJob(response.jobId);
+    }
+
+    return response;
   }
 
   /**
@@ -35,6 +35,20 @@ describe('ImageAnalysisService', () => {
       expect(bitmap.height).toBe(1);
     });
 
+    it('should decode large images at preview resolution', async () => {
+      const canvas = document.createElement('canvas');
+      canvas.width = 1200;
+      canvas.height = 600;
+      canvas.getContext('2d')!.fillRect(0, 0, 1200, 600);
+      const blob = await new Promise<Blob>(resolve => canvas.toBlob(b => resolve(b!), 'image/png'));
+      const file = new File([blob], 'large.png', { type: 'image/png' });
+
+      const bitmap = await service.loadImageBitmap(file, 300);
+
+      expect(bitmap.width).toBe(300);
+      expect(bitmap.height).toBe(150);
+    });
+
     it('should reject for invalid file data', async () => {
       const invalidData = new Blob(['not an image'], { type: 'image/png' });
       const file = new File([invalidData], 'invalid.png', { type: 'image/png' });
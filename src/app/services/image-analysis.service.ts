@@ -1,10 +1,15 @@
 import { Injectable } from '@angular/core';
 
+// Longest side, in pixels, of preview bitmaps: a 3" sticker on the largest preview canvas
+// is drawn at ~250px, so anything bigger is memory the preview never shows
+export const PREVIEW_MAX_SIZE = 256;
+
 /**
  * ImageAnalysisService handles image loading for preview
  *
  * Image processing is now handled by the backend API.
- * This service only loads images for display purposes.
+ * This service only loads images for display purposes, at preview resolution:
+ * full-resolution pixels only ever exist in the original File.
  */
 @Injectable({
   providedIn: 'root'
@@ -13,26 +18,64 @@ export class ImageAnalysisService {
   constructor() {}
 
   /**
-   * Load an image file and create an ImageBitmap for efficient canvas rendering
+   * Decode an image file into an ImageBitmap no larger than maxSize on its longest side
+   * (smaller images keep their size). The size is read from the file header first, so the
+   * pixels are decoded once, straight at preview size
    */
-  async loadImageBitmap(file: File): Promise<ImageBitmap> {
-    return new Promise((resolve, reject) => {
-      const reader = new FileReader();
-
-      reader.onload = async (e) => {
-        try {
-          const blob = new Blob([e.target!.result as ArrayBuffer], {
-            type: file.type
-          });
-          const bitmap = await createImageBitmap(blob);
-          resolve(bitmap);
-        } catch (error) {
-          reject(error);
-        }
-      };
-
-      reader.onerror = () => reject(reader.error);
-      reader.readAsArrayBuffer(file);
+  async loadImageBitmap(file: File, maxSize: number = PREVIEW_MAX_SIZE): Promise<ImageBitmap> {
+    if (file.type === 'image/svg+xml' || file.name.toLowerCase().endsWith('.svg')) {
+      return this.loadSvgBitmap(file, maxSize);
+    }
+
+    // A File is already a Blob: decode it directly rather than copying it through a FileReader
+    const natural = await readNaturalSize(file);
+    const scale = maxSize / Math.max(natural.width, natural.height);
+    if (scale >= 1) {
+      return createImageBitmap(file);
+    }
+
+    return createImageBitmap(file, {
+      resizeWidth: Math.max(1, Math.round(natural.width * scale)),
+      resizeHeight: Math.max(1, Math.round(natural.height * scale)),
+      resizeQuality: 'high'
     });
   }
+
+  /**
+   * createImageBitmap can't decode SVG blobs; decode through an <img> and rasterize that
+   * (the backend keeps the artwork as vectors for nesting and the PDF)
+   */
+  private async loadSvgBitmap(file: File, maxSize: number): Promise<ImageBitmap> {
+    const url = URL.createObjectURL(file);
+    try {
+      const image = new Image();
+      image.src = url;
+      await image.decode();
+
+      // SVGs without width/height report no natural size; render those square
+      const width = image.naturalWidth || maxSize;
+      const height = image.naturalHeight || maxSize;
+      const scale = maxSize / Math.max(width, height);
+      return await createImageBitmap(image, {
+        resizeWidth: Math.max(1, Math.round(width * scale)),
+        resizeHeight: Math.max(1, Math.round(height * scale))
+      });
+    } finally {
+      URL.revokeObjectURL(url);
+    }
+  }
+}
+
+/**
+ * Image size from the file header: an <img> that is loaded but never drawn or decode()d
+ * doesn't decode its pixels
+ */
+export function readNaturalSize(file: File): Promise<{ width: number; height: number }> {
+  const url = URL.createObjectURL(file);
+  const image = new Image();
+  return new Promise<{ width: number; height: number }>((resolve, reject) => {
+    image.onload = () => resolve({ width: image.naturalWidth, height: image.naturalHeight });
+    image.onerror = () => reject(new Error(`Could not read ${file.name}`));
+    image.src = url;
+  }).finally(() => URL.revokeObjectURL(url));
 }
@@ -0,0 +1,151 @@
+import { Injectable, OnDestroy } from '@angular/core';
+import { Point } from '../models/geometry.types';
+import { readNaturalSize } from './image-analysis.service';
+
+// Print resolution the server assumes for raster uploads (pixels per inch)
+const PRINT_DPI = 300;
+
+// Longest side, in pixels, of the first decode used to find the opaque area
+const PROBE_SIZE = 512;
+
+// Files prepared at once (each holds a print-size decode while it is traced)
+const PREPARE_CONCURRENCY = 2;
+
+/**
+ * An upload prepared in the browser: a print-resolution copy of the image and its
+ * alpha outline (pixels of that copy), so the server can skip its own trace
+ */
+export interface PreparedUpload {
+  file: File;
+  outline: { path: Point[]; holes: Point[][] };
+}
+
+/**
+ * ImagePreprocessService downscales and pre-traces images before upload
+ *
+ * The server sizes a sticker by its opaque outline, so the print size is only known after
+ * tracing: each image is first decoded small to find its opaque area, then decoded once
+ * more, straight at the size that puts that area at maxDimension × 300 DPI (never above
+ * the original), traced again in a Web Worker and re-encoded as PNG. No full-resolution
+ * decode is made, and only a couple of files are in flight at a time
+ */
+@Injectable({
+  providedIn: 'root'
+})
+export class ImagePreprocessService implements OnDestroy {
+  private worker: Worker | null = null;
+  private nextId = 0;
+  private pending = new Map<number, { resolve: (outline: PreparedUpload['outline']) => void; reject: (error: unknown) => void }>();
+
+  /**
+   * Whether this browser can prepare uploads (workers, OffscreenCanvas, resize on decode)
+   */
+  get supported(): boolean {
+    return typeof Worker !== 'undefined' && typeof OffscreenCanvas !== 'undefined' && typeof createImageBitmap !== 'undefined';
+  }
+
+  /**
+   * Prepare a batch of files, a few at a time; results are aligned with `files`
+   */
+  async prepareAll(files: File[], maxDimensionMM: number): Promise<Array<PreparedUpload | null>> {
+    const results: Array<PreparedUpload | null> = new Array(files.length).fill(null);
+    let next = 0;
+    const run = async () => {
+      while (next < files.length) {
+        const index = next++;
+        results[index] = await this.prepare(files[index], maxDimensionMM);
+      }
+    };
+    await Promise.all(Array.from({ length: Math.min(PREPARE_CONCURRENCY, files.length) }, run));
+    return results;
+  }
+
+  /**
+   * Prepare one file; null = upload the original (SVG, unsupported browser, decode failure)
+   */
+  async prepare(file: File, maxDimensionMM: number): Promise<PreparedUpload | null> {
+    if (!this.supported || file.type === 'image/svg+xml' || file.name.toLowerCase().endsWith('.svg')) {
+      return null;
+    }
+
+    try {
+      const natural = await readNaturalSize(file);
+      const longest = Math.max(natural.width, natural.height);
+
+      // Probe: find the opaque area (in original pixels) from a small decode
+      const probeScale = Math.min(1, PROBE_SIZE / longest);
+      const probe = await this.decodeAndTrace(file, natural, probeScale);
+      if (probe.outline.path.length < 3) return null;
+      const opaqueLongest = longestSide(probe.outline.path) / probeScale;
+
+      // Final decode: the opaque area at print resolution
+      const maxPixels = Math.ceil((maxDimensionMM / 25.4) * PRINT_DPI);
+      const scale = Math.min(1, maxPixels / opaqueLongest);
+      const final = scale === probeScale ? probe : await this.decodeAndTrace(file, natural, scale);
+      if (final.outline.path.length < 3) return null;
+
+      // Keep the original name: the server and PDF export key stickers by file name
+      const blob = await final.canvas.convertToBlob({ type: 'image/png' });
+      return { file: new File([blob], file.name, { type: 'image/png' }), outline: final.outline };
+    } catch (error) {
+      console.warn(`[Preprocess] Falling back to server processing for ${file.name}:`, error);
+      return null;
+    }
+  }
+
+  ngOnDestroy(): void {
+    this.worker?.terminate();
+    this.worker = null;
+  }
+
+  /**
+   * Decode straight at `scale` of the natural size and trace the result
+   */
+  private async decodeAndTrace(
+    file: File,
+    natural: { width: number; height: number },
+    scale: number
+  ): Promise<{ canvas: OffscreenCanvas; outline: PreparedUpload['outline'] }> {
+    const bitmap = await createImageBitmap(file, {
+      resizeWidth: Math.max(1, Math.round(natural.width * scale)),
+      resizeHeight: Math.max(1, Math.round(natural.height * scale)),
+      resizeQuality: 'high'
+    });
+    try {
+      const canvas = new OffscreenCanvas(bitmap.width, bitmap.height);
+      const context = canvas.getContext('2d')!;
+      context.drawImage(bitmap, 0, 0);
+      const outline = await this.trace(context.getImageData(0, 0, bitmap.width, bitmap.height));
+      return { canvas, outline };
+    } finally {
+      bitmap.close();
+    }
+  }
+
+  private trace(pixels: ImageData): Promise<PreparedUpload['outline']> {
+    if (!this.worker) {
+      this.worker = new Worker(new URL('../workers/outline.worker', import.meta.url), { type: 'module' });
+      this.worker.onmessage = ({ data }: MessageEvent<{ id: number; path: Point[]; holes: Point[][] }>) => {
+        this.pending.get(data.id)?.resolve({ path: data.path, holes: data.holes });
+        this.pending.delete(data.id);
+      };
+      this.worker.onerror = (event) => {
+        this.pending.forEach(({ reject }) => reject(event));
+        this.pending.clear();
+      };
+    }
+
+    const id = this.nextId++;
+    return new Promise((resolve, reject) => {
+      this.pending.set(id, { resolve, reject });
+      const buffer = pixels.data.buffer;
+      this.worker!.postMessage({ id, width: pixels.width, height: pixels.height, pixels: buffer }, [buffer]);
+    });
+  }
+}
+
+function longestSide(points: Point[]): number {
+  const xs = points.map(p => p.x);
+  const ys = points.map(p => p.y);
+  return Math.max(Math.max(...xs) - Math.min(...xs), Math.max(...ys) - Math.min(...ys));
+}
@@ -4,4 +4,6 @@
 
 export * from './unit-conversion.service';
 export * from './image-analysis.service';
+export * from './image-preprocess.service';
+export * from './sprite-atlas.service';
 export * from './api.service';
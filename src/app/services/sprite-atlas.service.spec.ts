@@ -0,0 +1,52 @@
+import { TestBed } from '@angular/core/testing';
+import { SpriteAtlasService } from './sprite-atlas.service';
+
+describe('SpriteAtlasService', () => {
+  let service: SpriteAtlasService;
+
+  const bitmap = (width: number, height: number) => createImageBitmap(new ImageData(width, height));
+
+  beforeEach(() => {
+    TestBed.configureTestingModule({});
+    service = TestBed.inject(SpriteAtlasService);
+  });
+
+  afterEach(() => service.clear());
+
+  it('should be created', () => {
+    expect(service).toBeTruthy();
+  });
+
+  it('should place sprites side by side on one page', async () => {
+    const first = service.add(await bitmap(100, 50));
+    const second = service.add(await bitmap(80, 80));
+
+    expect(second.image).toBe(first.image);
+    expect(second.x).toBeGreaterThanOrEqual(first.x + first.width);
+    expect(first.width).toBe(100);
+    expect(first.height).toBe(50);
+    expect(service.pageCount).toBe(1);
+  });
+
+  it('should close the source bitmap', async () => {
+    const source = await bitmap(10, 10);
+    service.add(source);
+
+    expect(source.width).toBe(0);
+  });
+
+  it('should open a new page when the current one is full', async () => {
+    for (let i = 0; i < 65; i++) {
+      service.add(await bitmap(256, 256));
+    }
+
+    expect(service.pageCount).toBe(2);
+  });
+
+  it('should free its pages on clear', async () => {
+    service.add(await bitmap(10, 10));
+    service.clear();
+
+    expect(service.pageCount).toBe(0);
+  });
+});
@@ -0,0 +1,92 @@
+import { Injectable } from '@angular/core';
+import { Sprite } from '../models/sticker.interface';
+
+// Atlas page size in pixels (16 MB of RGBA per page, 49 full-size preview sprites)
+const PAGE_SIZE = 2048;
+
+// Empty border around each sprite so bilinear filtering doesn't bleed in neighbours
+const PADDING = 2;
+
+interface AtlasPage {
+  canvas: HTMLCanvasElement;
+  context: CanvasRenderingContext2D;
+  shelfX: number;      // Next free x on the current shelf
+  shelfY: number;      // Top of the current shelf
+  shelfHeight: number; // Tallest sprite on the current shelf
+}
+
+/**
+ * SpriteAtlasService packs preview bitmaps into shared canvas pages
+ *
+ * Sticker previews are copied into a few large pages (shelf packing: left to right,
+ * a new row when one is full, a new page when that is full) and the bitmaps are
+ * released, so the preview holds one small region per design instead of a decoded
+ * image each, and every drawImage reads from the same few sources
+ */
+@Injectable({
+  providedIn: 'root'
+})
+export class SpriteAtlasService {
+  private pages: AtlasPage[] = [];
+
+  /**
+   * Copy a bitmap into the atlas and close it
+   */
+  add(bitmap: ImageBitmap): Sprite {
+    const width = Math.min(bitmap.width, PAGE_SIZE - 2 * PADDING);
+    const height = Math.min(bitmap.height, PAGE_SIZE - 2 * PADDING);
+
+    try {
+      const page = this.pageWithRoomFor(width, height);
+      const x = page.shelfX + PADDING;
+      const y = page.shelfY + PADDING;
+      page.context.drawImage(bitmap, x, y, width, height);
+
+      page.shelfX += width + 2 * PADDING;
+      page.shelfHeight = Math.max(page.shelfHeight, height + 2 * PADDING);
+      return { image: page.canvas, x, y, width, height };
+    } finally {
+      bitmap.close();
+    }
+  }
+
+  /**
+   * Free every page; only call once no sticker references its sprite any more
+   */
+  clear(): void {
+    this.pages.forEach(page => {
+      page.canvas.width = 0;
+      page.canvas.height = 0;
+    });
+    this.pages = [];
+  }
+
+  get pageCount(): number {
+    return this.pages.length;
+  }
+
+  private pageWithRoomFor(width: number, height: number): AtlasPage {
+    const outerWidth = width + 2 * PADDING;
+    const outerHeight = height + 2 * PADDING;
+    const current = this.pages[this.pages.length - 1];
+
+    if (current) {
+      // Start a new shelf when the sprite doesn't fit on the current one
+      if (current.shelfX + outerWidth > PAGE_SIZE) {
+        current.shelfY += current.shelfHeight;
+        current.shelfX = 0;
+        current.shelfHeight = 0;
+      }
+      if (current.shelfY + outerHeight <= PAGE_SIZE) {
+        return current;
+      }
+    }
+
+    const canvas = document.createElement('canvas');
+    canvas.width = PAGE_SIZE;
+    canvas.height = PAGE_SIZE;
+    const page = { canvas, context: canvas.getContext('2d')!, shelfX: 0, shelfY: 0, shelfHeight: 0 };
+    this.pages.push(page);
+    return page;
+  }
+}
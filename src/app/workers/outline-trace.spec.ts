@@ -0,0 +1,54 @@
+import { traceAlphaOutline } from './outline-trace';
+
+/**
+ * RGBA image whose alpha is 255 where `opaque(x, y)` holds and 0 elsewhere
+ */
+function image(width: number, height: number, opaque: (x: number, y: number) => boolean): Uint8ClampedArray {
+  const rgba = new Uint8ClampedArray(width * height * 4);
+  for (let y = 0; y < height; y++) {
+    for (let x = 0; x < width; x++) {
+      rgba[(y * width + x) * 4 + 3] = opaque(x, y) ? 255 : 0;
+    }
+  }
+  return rgba;
+}
+
+describe('traceAlphaOutline', () => {
+  it('should trace a fully opaque image as its four corners', () => {
+    const { path, holes } = traceAlphaOutline(10, 10, image(10, 10, () => true));
+
+    expect(path.length).toBe(4);
+    expect(holes.length).toBe(0);
+    expect(Math.max(...path.map(p => p.x))).toBe(10);
+    expect(Math.max(...path.map(p => p.y))).toBe(10);
+  });
+
+  it('should ignore transparent padding', () => {
+    const { path } = traceAlphaOutline(20, 20, image(20, 20, (x, y) => x >= 5 && x < 15 && y >= 5 && y < 15));
+
+    expect(Math.min(...path.map(p => p.x))).toBe(5);
+    expect(Math.max(...path.map(p => p.x))).toBe(15);
+  });
+
+  it('should keep the hole of a ring', () => {
+    const ring = image(80, 80, (x, y) => {
+      const d = Math.hypot(x + 0.5 - 40, y + 0.5 - 40);
+      return d <= 30 && d >= 15;
+    });
+    const { path, holes } = traceAlphaOutline(80, 80, ring);
+
+    expect(path.length).toBeGreaterThanOrEqual(8);
+    expect(holes.length).toBe(1);
+    expect(Math.max(...holes[0].map(p => p.x))).toBeLessThan(Math.max(...path.map(p => p.x)));
+  });
+
+  it('should keep only the largest of several islands', () => {
+    const { path } = traceAlphaOutline(30, 10, image(30, 10, (x) => x < 4 || x >= 10));
+
+    expect(Math.min(...path.map(p => p.x))).toBe(10);
+  });
+
+  it('should return an empty path for a fully transparent image', () => {
+    expect(traceAlphaOutline(5, 5, image(5, 5, () => false)).path.length).toBe(0);
+  });
+});
@@ -0,0 +1,165 @@
+import { Point } from '../models/geometry.types';
+
+/**
+ * Alpha-outline tracing for client-side pre-tracing (runs inside outline.worker.ts)
+ * Mirrors the server's raster path: threshold alpha at 128, keep the largest outer
+ * contour with its holes, simplify with a 2px tolerance. Coordinates are in pixels
+ */
+
+export interface TracedOutline {
+  path: Point[];
+  holes: Point[][];
+}
+
+const ALPHA_THRESHOLD = 128;
+const SIMPLIFY_TOLERANCE = 2.0; // Same as the server's simplifyPath(path, 2.0)
+const PATH_OMIT = 8;            // Same as ImageTracer's pathomit on the server: loops with fewer boundary points are noise
+
+/**
+ * Trace the largest opaque region of an RGBA image
+ */
+export function traceAlphaOutline(width: number, height: number, rgba: Uint8ClampedArray): TracedOutline {
+  const inside = (x: number, y: number) =>
+    x >= 0 && y >= 0 && x < width && y < height && rgba[(y * width + x) * 4 + 3] >= ALPHA_THRESHOLD;
+
+  // Directed pixel-edge boundary, interior on the right (clockwise on screen for outer
+  // contours, counter-clockwise for holes); vertices are pixel corners
+  const stride = width + 1;
+  const outgoing = new Map<number, number[]>();
+  const addEdge = (x1: number, y1: number, x2: number, y2: number) => {
+    const from = y1 * stride + x1;
+    const list = outgoing.get(from);
+    if (list) list.push(y2 * stride + x2);
+    else outgoing.set(from, [y2 * stride + x2]);
+  };
+  for (let y = 0; y < height; y++) {
+    for (let x = 0; x < width; x++) {
+      if (!inside(x, y)) continue;
+      if (!inside(x, y - 1)) addEdge(x, y, x + 1, y);
+      if (!inside(x + 1, y)) addEdge(x + 1, y, x + 1, y + 1);
+      if (!inside(x, y + 1)) addEdge(x + 1, y + 1, x, y + 1);
+      if (!inside(x - 1, y)) addEdge(x, y + 1, x, y);
+    }
+  }
+
+  // Chain edges into closed loops
+  const loops: Point[][] = [];
+  for (const [start, targets] of outgoing) {
+    while (targets.length > 0) {
+      const loop: Point[] = [];
+      let vertex = start;
+      do {
+        loop.push({ x: vertex % stride, y: Math.floor(vertex / stride) });
+        const next = outgoing.get(vertex)!;
+        vertex = next.pop()!;
+      } while (vertex !== start && outgoing.get(vertex)?.length);
+      if (loop.length >= PATH_OMIT) loops.push(removeCollinear(loop));
+    }
+  }
+
+  let outer: Point[] = [];
+  let outerArea = 0;
+  for (const loop of loops) {
+    const area = signedArea(loop);
+    if (area > outerArea) {
+      outerArea = area;
+      outer = loop;
+    }
+  }
+  if (outer.length < 3) return { path: [], holes: [] };
+
+  const holes = loops
+    .filter(loop => signedArea(loop) < 0 && containsPoint(outer, loop[0]))
+    .map(loop => simplify(loop, SIMPLIFY_TOLERANCE))
+    .filter(hole => hole.length >= 3);
+
+  return { path: simplify(outer, SIMPLIFY_TOLERANCE), holes };
+}
+
+/**
+ * Shoelace area; positive for clockwise loops in screen coordinates (y down)
+ */
+function signedArea(points: Point[]): number {
+  let area = 0;
+  for (let i = 0; i < points.length; i++) {
+    const j = (i + 1) % points.length;
+    area += points[i].x * points[j].y - points[j].x * points[i].y;
+  }
+  return area / 2;
+}
+
+function containsPoint(polygon: Point[], point: Point): boolean {
+  // Sample just inside the pixel cell so corners shared with the outline don't count as on-edge
+  const px = point.x + 0.25;
+  const py = point.y + 0.25;
+  let inside = false;
+  for (let i = 0, j = polygon.length - 1; i < polygon.length; j = i++) {
+    const a = polygon[i];
+    const b = polygon[j];
+    if ((a.y > py) !== (b.y > py) && px < ((b.x - a.x) * (py - a.y)) / (b.y - a.y) + a.x) {
+      inside = !inside;
+    }
+  }
+  return inside;
+}
+
+function removeCollinear(loop: Point[]): Point[] {
+  return loop.filter((p, i) => {
+    const prev = loop[(i - 1 + loop.length) % loop.length];
+    const next = loop[(i + 1) % loop.length];
+    return (p.x - prev.x) * (next.y - p.y) !== (p.y - prev.y) * (next.x - p.x);
+  });
+}
+
+/**
+ * Ramer-Douglas-Peucker on a closed ring (split at the vertex farthest from the first)
+ */
+function simplify(ring: Point[], tolerance: number): Point[] {
+  if (ring.length <= 4) return ring;
+
+  let far = 0;
+  let farDistance = -1;
+  for (let i = 1; i < ring.length; i++) {
+    const d = Math.hypot(ring[i].x - ring[0].x, ring[i].y - ring[0].y);
+    if (d > farDistance) {
+      farDistance = d;
+      far = i;
+    }
+  }
+
+  const first = douglasPeucker(ring.slice(0, far + 1), tolerance);
+  const second = douglasPeucker([...ring.slice(far), ring[0]], tolerance);
+  return [...first.slice(0, -1), ...second.slice(0, -1)];
+}
+
+function douglasPeucker(points: Point[], tolerance: number): Point[] {
+  const keep = new Uint8Array(points.length);
+  keep[0] = 1;
+  keep[points.length - 1] = 1;
+  const stack: Array<[number, number]> = [[0, points.length - 1]];
+
+  while (stack.length > 0) {
+    const [start, end] = stack.pop()!;
+    const a = points[start];
+    const b = points[end];
+    const length = Math.hypot(b.x - a.x, b.y - a.y);
+    let index = -1;
+    let maxDistance = tolerance;
+    for (let i = start + 1; i < end; i++) {
+      const p = points[i];
+      const distance = length > 0
+        ? Math.abs((b.x - a.x) * (a.y - p.y) - (a.x - p.x) * (b.y - a.y)) / length
+        : Math.hypot(p.x - a.x, p.y - a.y);
+      if (distance > maxDistance) {
+        maxDistance = distance;
+        index = i;
+      }
+    }
+    if (index !== -1) {
+      keep[index] = 1;
+      stack.push([start, index], [index, end]);
+    }
+  }
+
+  return points.filter((_, i) => keep[i]);
+}
@@ -0,0 +1,12 @@
+/// <reference lib="webworker" />
+
+import { traceAlphaOutline } from './outline-trace';
+
+/**
+ * Traces sticker outlines off the main thread
+ * In: { id, width, height, pixels } (RGBA, transferred). Out: { id, path, holes } in pixels
+ */
+addEventListener('message', ({ data }: MessageEvent<{ id: number; width: number; height: number; pixels: ArrayBuffer }>) => {
+  const { path, holes } = traceAlphaOutline(data.width, data.height, new Uint8ClampedArray(data.pixels));
+  postMessage({ id: data.id, path, holes });
+});